@@ -0,0 +1,202 @@
+//
+//  NWBasicGestureLayer.hpp
+//  NoviceWorks
+//
+//  NWGestureLayer with the gestures chosen at compile time.
+//
+//
+
+#ifndef __NWBasicGestureLayer__
+#define __NWBasicGestureLayer__
+
+#include <vector>
+
+#include "cocos2d.h"
+#include "NWBasicGestureRecognizer.hpp"
+#include "NWLayoutMetrics.hpp"
+
+/**
+ *  @class  NWBasicGestureLayer
+ *  @brief  Layer for detecting the gestures given as the template parameters.
+ *
+ *  Adapter of NWBasicGestureRecognizer for cocos2d-x. the subclass is
+ *  the handler (CRTP): define the callbacks of the gestures as public
+ *  non-virtual funcs of NWGestureHandler, and they are called directly.
+ *  the gestures not listed cost nothing in the touch events.
+ *
+ *      class MenuLayer : public NWBasicGestureLayer<MenuLayer, NWGestureTap, NWGestureScroll> {
+ *      public:
+ *          void onTap( const NWPoint &p, int id ) { ... }
+ *          void onScroll( const NWPoint &p, int id ) { ... }
+ *      };
+ *
+ *  it has no event queue, no threaded mode, no arbiter, no gesture target
+ *  and no touch history. use NWGestureLayer for them.
+ */
+template< class Derived,
+          class G1 = NWGestureNone, class G2 = NWGestureNone, class G3 = NWGestureNone,
+          class G4 = NWGestureNone, class G5 = NWGestureNone, class G6 = NWGestureNone >
+class NWBasicGestureLayer : public cocos2d::CCLayer, public NWGestureHandler
+{
+public:
+    typedef NWBasicGestureRecognizer<Derived, G1, G2, G3, G4, G5, G6> Recognizer;
+
+    NWBasicGestureLayer() :
+      mRecognizer( static_cast<Derived*>( this ) )
+    , mDistanceThresholdForMovedInMM( 0.0f )
+    , mLayout()
+    , mScheduledDeadline( -1 )
+    {
+        this->mTouchSamples.reserve( Recognizer::MAX_TOUCHES );
+
+        // thresholds for this window, same as NWGestureLayer.
+        this->updateLayoutMetrics();
+    }
+
+    virtual bool init() {
+        if( !cocos2d::CCLayer::init() ) return false;
+
+        this->setTouchEnabled( true );
+        this->setTouchMode( cocos2d::kCCTouchesAllAtOnce );
+        return true;
+    }
+
+    // Override touch events.
+    virtual void ccTouchesBegan( cocos2d::CCSet *pTouches, cocos2d::CCEvent *pEvent ) {
+        if( this->mLayout.isChanged() ) this->updateLayoutMetrics();
+        this->feedTouches( NW_TOUCH_BEGAN, pTouches );
+    }
+    virtual void ccTouchesMoved( cocos2d::CCSet *pTouches, cocos2d::CCEvent *pEvent ) {
+        this->feedTouches( NW_TOUCH_MOVED, pTouches );
+    }
+    virtual void ccTouchesEnded( cocos2d::CCSet *pTouches, cocos2d::CCEvent *pEvent ) {
+        this->feedTouches( NW_TOUCH_ENDED, pTouches );
+    }
+    virtual void ccTouchesCancelled( cocos2d::CCSet *pTouches, cocos2d::CCEvent *pEvent ) {
+        this->feedTouches( NW_TOUCH_CANCELLED, pTouches );
+    }
+
+    /**
+     *  Get the recognizer, for the thresholds and the touch infomation.
+     *  e.g. getRecognizer()->setTimeThresholdForHold( 0.5 ).
+     */
+    Recognizer* getRecognizer() {
+        return &this->mRecognizer;
+    }
+
+    /**
+     *  Set the Base distance for determine moved or not.
+     *  default is 1/10 of the window diagonal, updated by updateLayoutMetrics().
+     *  @param  distance    points. fixed until the next call of
+     *                      setDistanceThresholdForMovedInMM().
+     */
+    void setDistanceThresholdForMoved( float distance ) {
+        this->mDistanceThresholdForMovedInMM = -1.0f;
+        this->mRecognizer.setDistanceThresholdForMoved( distance );
+    }
+    float getDistanceThresholdForMoved() {
+        return this->mRecognizer.getDistanceThresholdForMoved();
+    }
+
+    /**
+     *  Set the Base distance for determine moved or not in millimetres
+     *  on the screen. see NWGestureLayer::setDistanceThresholdForMovedInMM().
+     *  @param  mm  0 returns to 1/10 of the window diagonal.
+     */
+    void setDistanceThresholdForMovedInMM( float mm ) {
+        this->mDistanceThresholdForMovedInMM = mm > 0.0f ? mm : 0.0f;
+        this->updateLayoutMetrics();
+    }
+    float getDistanceThresholdForMovedInMM() {
+        return this->mDistanceThresholdForMovedInMM;
+    }
+
+    /**
+     *  Recompute the distance threshold from the window size, the design
+     *  resolution and the DPI. it's also checked at each touch began.
+     */
+    void updateLayoutMetrics() {
+        this->mLayout.update();
+        if( this->mDistanceThresholdForMovedInMM > 0.0f ) {
+            this->mRecognizer.setDistanceThresholdForMoved( this->mDistanceThresholdForMovedInMM * this->mLayout.getPointsPerMM() );
+        } else if( this->mDistanceThresholdForMovedInMM == 0.0f ) {
+            this->mRecognizer.setDistanceThresholdForMoved( this->mLayout.getDiagonal() / 10.0f );
+        }
+    }
+
+    /**
+     *  Get points per millimetre on the screen, as of updateLayoutMetrics().
+     */
+    float getPointsPerMM() {
+        return this->mLayout.getPointsPerMM();
+    }
+
+    /**
+     *  Set the time source of gestures. NULL is the monotonic clock.
+     *  @warning clock isn't retained.
+     */
+    void setClock( NWClock *clock ) {
+        this->mRecognizer.setClock( clock );
+    }
+    NWClock* getClock() {
+        return this->mRecognizer.getClock();
+    }
+
+    /**
+     *  Get the time when the touch happened. see NWGestureLayer::getTouchTime().
+     */
+    virtual NWTime getTouchTime( cocos2d::CCTouch *touch, NWTime now ) {
+        return now;
+    }
+
+
+private:
+    Recognizer  mRecognizer;
+    std::vector<NWTouchSample> mTouchSamples;  // reused buffer.
+    // Moved: 0 is 1/10 of the window diagonal, negative is fixed points.
+    float       mDistanceThresholdForMovedInMM;
+    NWLayoutMetrics mLayout;                    // window of the threshold.
+    NWTime      mScheduledDeadline;             // negative: not scheduled.
+
+    void feedTouches( NWTouchPhase phase, cocos2d::CCSet *pTouches ) {
+        NWTime now = this->mRecognizer.getClock()->now();
+        this->mTouchSamples.clear();
+        for( cocos2d::CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it ) {
+            cocos2d::CCTouch *touch = static_cast<cocos2d::CCTouch*>(*it);
+            cocos2d::CCPoint p = touch->getLocation();
+            NWTouchSample sample = { touch->getID(), p.x, p.y, this->getTouchTime( touch, now ) };
+            this->mTouchSamples.push_back( sample );
+        }
+        if( this->mTouchSamples.empty() ) return;
+        this->mRecognizer.touches( phase, &this->mTouchSamples[0], this->mTouchSamples.size() );
+        this->rescheduleDeadline();
+    }
+
+    // SingleTap & Hold: timer of the recognizer. never armed without them.
+    void scheduleDeadlineHandler() {
+        this->mScheduledDeadline = -1;      // scheduleOnce is done.
+        this->mRecognizer.update();
+        this->rescheduleDeadline();
+    }
+
+    void rescheduleDeadline() {
+        if( !Recognizer::HAS_DOUBLE_TAP && !Recognizer::HAS_HOLD ) return;
+
+        NWTime deadline = this->mRecognizer.getNextDeadline();
+        if( deadline == this->mScheduledDeadline ) return;
+
+        if( this->mScheduledDeadline >= 0 ) {
+            this->unschedule( schedule_selector( NWBasicGestureLayer::scheduleDeadlineHandler ) );
+        }
+        this->mScheduledDeadline = deadline;
+        if( deadline < 0 ) return;
+
+        NWTime delay = deadline - this->mRecognizer.getClock()->now();
+        this->scheduleOnce(
+            schedule_selector( NWBasicGestureLayer::scheduleDeadlineHandler ),
+            delay > 0 ? static_cast<float>( NWTimeToSec( delay ) ) : 0.0f );
+    }
+};
+
+
+#endif /* defined(__NWBasicGestureLayer__) */
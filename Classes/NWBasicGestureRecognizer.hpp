@@ -0,0 +1,879 @@
+//
+//  NWBasicGestureRecognizer.hpp
+//  NoviceWorks
+//
+//  NWGestureRecognizer with the gestures chosen at compile time.
+//
+//
+
+#ifndef __NWBasicGestureRecognizer__
+#define __NWBasicGestureRecognizer__
+
+#include <cmath>
+
+#include "NWGestureRecognizer.hpp"
+
+
+#pragma -mark Gesture Set
+// gestures of NWBasicGestureRecognizer. MASK is the bit of each.
+struct NWGestureNone        { enum { MASK = 0 }; };
+struct NWGestureTap         { enum { MASK = 1 << 0 }; };    // onDown, onTap, onCancelled
+struct NWGestureDoubleTap   { enum { MASK = 1 << 1 }; };    // onSingleTap, onDoubleTap
+struct NWGestureHold        { enum { MASK = 1 << 2 }; };    // onHold, onDrag, onDragEnded
+struct NWGestureScroll      { enum { MASK = 1 << 3 }; };    // onScroll, onFlick, onSwipe
+struct NWGestureMultiTouch  { enum { MASK = 1 << 4 }; };    // fingers of id other than 0
+struct NWGesturePinch       { enum { MASK = ( 1 << 5 ) | NWGestureMultiTouch::MASK }; };   // onPinch*, onTransform*
+struct NWGestureAll         { enum { MASK = ( 1 << 6 ) - 1 }; };
+
+/**
+ *  @struct NWGestureSet
+ *  @brief  Union of the gestures. can be passed where a gesture is.
+ */
+template< class G1 = NWGestureNone, class G2 = NWGestureNone, class G3 = NWGestureNone,
+          class G4 = NWGestureNone, class G5 = NWGestureNone, class G6 = NWGestureNone >
+struct NWGestureSet
+{
+    enum { MASK = G1::MASK | G2::MASK | G3::MASK | G4::MASK | G5::MASK | G6::MASK };
+};
+
+
+/**
+ *  @class  NWGestureHandler
+ *  @brief  Base of the receiver of NWBasicGestureRecognizer.
+ *
+ *  the funcs are not virtual. hide the ones of your gestures in the
+ *  subclass (public); they are called directly and can be inlined.
+ *  the rest stay empty and are never called.
+ */
+class NWGestureHandler
+{
+public:
+    void onSingleTap( const NWPoint &touchPoint ) {}
+    void onDoubleTap( const NWPoint &touchPoint ) {}
+
+    void onDown( const NWPoint &touchPoint, int id ) {}
+    void onHold( const NWPoint &touchPoint, int id ) {}
+    void onTap( const NWPoint &touchPoint, int id ) {}
+    void onCancelled( const NWPoint &touchPoint, int id ) {}
+
+    void onScroll( const NWPoint &touchPoint, int id ) {}
+    void onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy ) {}
+    void onSwipe( const NWPoint &touchPoint, int id, int direction ) {}
+    void onDrag( const NWPoint &touchPoint, int id ) {}
+    void onDragEnded( const NWPoint &touchPoint, int id ) {}
+
+    void onPinchIn( float magnification, int id1, int id2 ) {}
+    void onPinchOut( float magnification, int id1, int id2 ) {}
+    void onPinchAction( float magnification, int id1, int id2 ) {}
+    void onPinchEnded( float magnification, int id1, int id2 ) {}
+
+    void onTransform( const NWTransform &transform ) {}
+    void onTransformEnded( const NWTransform &transform ) {}
+};
+
+
+#pragma -mark Gesture State
+// state of each gesture. the specialization for a disabled gesture is
+// empty and does nothing, so it takes no byte as a base class.
+
+// release velocity of a touch: Flick.
+template< bool IS_ENABLED >
+struct NWBasicVelocityState
+{
+    NWVelocityTracker velocityTracker;
+
+    void clearVelocity()                                { this->velocityTracker.clear(); }
+    void addVelocitySample( float x, float y, NWTime t ) { this->velocityTracker.addSample( x, y, t ); }
+    void getVelocity( float *vx, float *vy ) const      { this->velocityTracker.getVelocity( vx, vy ); }
+};
+
+template<>
+struct NWBasicVelocityState<false>
+{
+    void clearVelocity() {}
+    void addVelocitySample( float x, float y, NWTime t ) {}
+    void getVelocity( float *vx, float *vy ) const      { *vx = 0.0f; *vy = 0.0f; }
+};
+
+// first taps waiting for the second: SingleTap & DoubleTap.
+// same as the tap sequences of NWGestureRecognizer.
+template< bool IS_ENABLED >
+class NWBasicTapState
+{
+public:
+    template< class Handler >
+    void tap( Handler *handler, int id, const NWPoint &tap_point, NWTime time,
+              NWTime interval_threshold, float distance_threshold_sq ) {
+        // Check Double Tap: the nearest first tap within the time and distance.
+        int found = -1;
+        float found_distance = 0.0f;
+        for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+            const TapSequence &seq = this->mTapSequences[i];
+            if( seq.id < 0 || time - seq.time > interval_threshold ) continue;
+
+            float distance = seq.point.getDistanceSq( tap_point );
+            if( distance > distance_threshold_sq ) continue;
+            if( found < 0 || distance < found_distance ) {
+                found = i;
+                found_distance = distance;
+            }
+        }
+        if( found >= 0 ) {
+            this->mTapSequences[ found ] = TapSequence();
+            handler->onDoubleTap( tap_point );
+            return;
+        }
+
+        // new tap. when all are waiting, the oldest gives up waiting.
+        int index = -1;
+        for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+            if( this->mTapSequences[i].id < 0 ) {
+                index = i;
+                break;
+            }
+            if( index < 0 || this->mTapSequences[i].time < this->mTapSequences[ index ].time ) index = i;
+        }
+        if( this->mTapSequences[ index ].id >= 0 ) this->singleTap( handler, index );
+
+        TapSequence &seq = this->mTapSequences[ index ];
+        seq.id = id;
+        seq.time = time;
+        seq.point = tap_point;
+    }
+
+    // SingleTap: the expired ones, older first.
+    template< class Handler >
+    void update( Handler *handler, NWTime now, NWTime interval_threshold ) {
+        for( ;; ) {
+            int oldest = -1;
+            for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+                const TapSequence &seq = this->mTapSequences[i];
+                if( seq.id < 0 || now < seq.time + interval_threshold ) continue;
+                if( oldest < 0 || seq.time < this->mTapSequences[ oldest ].time ) oldest = i;
+            }
+            if( oldest < 0 ) break;
+            this->singleTap( handler, oldest );
+        }
+    }
+
+    NWTime getNextDeadline( NWTime interval_threshold ) const {
+        NWTime deadline = -1;
+        for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+            const TapSequence &seq = this->mTapSequences[i];
+            if( seq.id < 0 ) continue;
+
+            NWTime tap_time = seq.time + interval_threshold;
+            if( deadline < 0 || tap_time < deadline ) deadline = tap_time;
+        }
+        return deadline;
+    }
+
+private:
+    static const int MAX_TAP_SEQUENCES = NW_GESTURE_MAX_TAP_SEQUENCES;
+
+    struct TapSequence {
+        int     id;             // -1: unused.
+        NWTime  time;
+        NWPoint point;
+
+        TapSequence() : id( -1 ), time( 0 ) {}
+    };
+    TapSequence mTapSequences[ MAX_TAP_SEQUENCES ];
+
+    template< class Handler >
+    void singleTap( Handler *handler, int index ) {
+        NWPoint tap_point = this->mTapSequences[ index ].point;
+        this->mTapSequences[ index ] = TapSequence();
+        handler->onSingleTap( tap_point );
+    }
+};
+
+template<>
+class NWBasicTapState<false>
+{
+public:
+    template< class Handler >
+    void tap( Handler *handler, int id, const NWPoint &tap_point, NWTime time,
+              NWTime interval_threshold, float distance_threshold_sq ) {}
+    template< class Handler >
+    void update( Handler *handler, NWTime now, NWTime interval_threshold ) {}
+    NWTime getNextDeadline( NWTime interval_threshold ) const { return -1; }
+};
+
+// PinchAction & Transform. all fingers are one gesture (group 0), like
+// NWGestureRecognizer with DistanceThresholdForGroup 0.
+// Touches is the touch slot array of the recognizer, which has id and lastPoint.
+// the fingers are kept as the slot indices; the callbacks get their ids.
+template< bool IS_ENABLED >
+class NWBasicTransformState
+{
+public:
+    NWBasicTransformState() :
+      mCount( 0 )
+    , mHasMoved( false )
+    , mBaseSpread( 0.0f )
+    , mPreviousSpread( 0.0f )
+    {
+        for( int i = 0; i < MAX_TOUCHES; ++i ) {
+            this->mIsMember[i] = false;
+            this->mIsTransformed[i] = false;
+        }
+    }
+
+    // was a part of the multi-touch gesture.
+    bool isTransformed( int slot ) const    { return this->mIsTransformed[ slot ]; }
+    bool isMember( int slot ) const         { return this->mIsMember[ slot ]; }
+    bool isActive() const                   { return this->mCount >= 2; }
+
+    void resetTouch( int slot ) {
+        this->mIsTransformed[ slot ] = false;
+    }
+
+    // transform of the move. callback once per event by endMove().
+    bool move( int slot ) {
+        if( !this->mIsMember[ slot ] || this->mCount < 2 ) return false;
+        this->mHasMoved = true;
+        return true;
+    }
+
+    template< class Handler, class Touches >
+    void endMove( Handler *handler, const Touches *touches ) {
+        if( !this->mHasMoved ) return;
+        this->mHasMoved = false;
+        this->transformHandler( handler, touches );
+    }
+
+    template< class Handler, class Touches >
+    void addTouch( Handler *handler, const Touches *touches, int slot ) {
+        if( this->mIsMember[ slot ] ) return;
+
+        // keep the gesture so far, and restart from the new finger set.
+        if( this->mCount >= 2 ) {
+            this->mAccumulated = this->getCurrentTransform( touches, NULL );
+        } else {
+            this->mAccumulated = NWTransform();
+        }
+        this->mSlots[ this->mCount++ ] = slot;
+        this->mIsMember[ slot ] = true;
+        this->rebase( touches );
+
+        // start of gesture.
+        if( this->mCount == 2 ) {
+            for( int i = 0; i < this->mCount; ++i ) this->mIsTransformed[ this->mSlots[i] ] = true;
+            this->transformHandler( handler, touches );
+        } else if( this->mCount > 2 ) {
+            this->mIsTransformed[ slot ] = true;
+        }
+    }
+
+    template< class Handler, class Touches >
+    void removeTouch( Handler *handler, const Touches *touches, int slot ) {
+        if( !this->mIsMember[ slot ] ) return;
+        NWTransform current = this->getCurrentTransform( touches, NULL );
+        bool was_active = this->mCount >= 2;
+        int id1 = touches[ this->mSlots[0] ].id;
+        int id2 = this->mCount >= 2 ? touches[ this->mSlots[1] ].id : -1;
+
+        // keep the order. first two are the fingers of PinchAction.
+        int n = 0;
+        for( int i = 0; i < this->mCount; ++i ) {
+            if( this->mSlots[i] != slot ) this->mSlots[ n++ ] = this->mSlots[i];
+        }
+        this->mCount = n;
+        this->mIsMember[ slot ] = false;
+
+        if( !was_active ) return;
+        if( this->mCount >= 2 ) {
+            this->mAccumulated = current;
+            this->rebase( touches );
+            return;
+        }
+
+        // end of gesture.
+        this->mAccumulated = NWTransform();
+        this->rebase( touches );        // the rest finger.
+        handler->onTransformEnded( current );
+        handler->onPinchEnded( current.scale, id1, id2 );
+    }
+
+private:
+    static const int MAX_TOUCHES = NW_GESTURE_MAX_TOUCHES;
+
+    int     mSlots[ MAX_TOUCHES ];      // fingers of the gesture.
+    int     mCount;
+    bool    mHasMoved;                  // in this touch event.
+    bool    mIsMember[ MAX_TOUCHES ];   // index is touch slot.
+    bool    mIsTransformed[ MAX_TOUCHES ];
+    NWPoint mBases[ MAX_TOUCHES ];      // vector from the base centroid.
+    NWPoint mBaseCentroid;
+    float   mBaseSpread;
+    float   mPreviousSpread;
+    NWTransform mAccumulated;           // until the last rebase.
+
+    template< class Touches >
+    NWPoint getCentroid( const Touches *touches ) const {
+        NWPoint centroid;
+        for( int i = 0; i < this->mCount; ++i ) {
+            const NWPoint &p = touches[ this->mSlots[i] ].lastPoint;
+            centroid.x += p.x;
+            centroid.y += p.y;
+        }
+        centroid.x /= this->mCount;
+        centroid.y /= this->mCount;
+        return centroid;
+    }
+
+    // take the current finger positions as the base.
+    template< class Touches >
+    void rebase( const Touches *touches ) {
+        int n = this->mCount;
+        if( n == 0 ) return;
+
+        NWPoint centroid = this->getCentroid( touches );
+        float spread = 0.0f;
+        for( int i = 0; i < n; ++i ) {
+            int slot = this->mSlots[i];
+            const NWPoint &p = touches[ slot ].lastPoint;
+            this->mBases[ slot ] = NWPoint( p.x - centroid.x, p.y - centroid.y );
+            spread += sqrtf( this->mBases[ slot ].x * this->mBases[ slot ].x +
+                             this->mBases[ slot ].y * this->mBases[ slot ].y );
+        }
+        this->mBaseCentroid = centroid;
+        this->mBaseSpread = spread / n;
+        this->mPreviousSpread = this->mBaseSpread;
+    }
+
+    template< class Touches >
+    NWTransform getCurrentTransform( const Touches *touches, float *spread_out ) const {
+        NWTransform transform = this->mAccumulated;
+        int n = this->mCount;
+        transform.touchCount = n;
+        transform.group = 0;
+        if( n == 0 ) return transform;
+        transform.firstId = touches[ this->mSlots[0] ].id;
+
+        NWPoint centroid = this->getCentroid( touches );
+        float spread = 0.0f, cross = 0.0f, dot = 0.0f;
+        for( int i = 0; i < n; ++i ) {
+            int slot = this->mSlots[i];
+            const NWPoint &base = this->mBases[ slot ];
+            float cx = touches[ slot ].lastPoint.x - centroid.x;
+            float cy = touches[ slot ].lastPoint.y - centroid.y;
+            spread += sqrtf( cx * cx + cy * cy );
+            cross += base.x * cy - base.y * cx;
+            dot   += base.x * cx + base.y * cy;
+        }
+        spread /= n;
+        if( spread_out ) *spread_out = spread;
+
+        if( this->mBaseSpread > 0.0f ) transform.scale *= spread / this->mBaseSpread;
+        if( cross != 0.0f || dot != 0.0f ) transform.rotation += atan2f( cross, dot );
+        transform.translation.x += centroid.x - this->mBaseCentroid.x;
+        transform.translation.y += centroid.y - this->mBaseCentroid.y;
+        transform.centroid = centroid;
+        return transform;
+    }
+
+    template< class Handler, class Touches >
+    void transformHandler( Handler *handler, const Touches *touches ) {
+        float spread = 0.0f;
+        NWTransform transform = this->getCurrentTransform( touches, &spread );
+        int id1 = touches[ this->mSlots[0] ].id;
+        int id2 = touches[ this->mSlots[1] ].id;
+
+        handler->onTransform( transform );
+        handler->onPinchAction( transform.scale, id1, id2 );
+        if( spread < this->mPreviousSpread ) handler->onPinchIn( transform.scale, id1, id2 );
+        else                                 handler->onPinchOut( transform.scale, id1, id2 );
+        this->mPreviousSpread = spread;
+    }
+};
+
+template<>
+class NWBasicTransformState<false>
+{
+public:
+    bool isTransformed( int slot ) const    { return false; }
+    bool isMember( int slot ) const         { return false; }
+    bool isActive() const                   { return false; }
+    void resetTouch( int slot ) {}
+    bool move( int slot )                   { return false; }
+
+    template< class Handler, class Touches >
+    void endMove( Handler *handler, const Touches *touches ) {}
+    template< class Handler, class Touches >
+    void addTouch( Handler *handler, const Touches *touches, int slot ) {}
+    template< class Handler, class Touches >
+    void removeTouch( Handler *handler, const Touches *touches, int slot ) {}
+};
+
+
+#pragma -mark NWBasicGestureRecognizer
+/**
+ *  @class  NWBasicGestureRecognizer
+ *  @brief  Gesture detection of the gestures chosen at compile time.
+ *
+ *  same gestures as NWGestureRecognizer for the enabled ones, called on
+ *  Handler (subclass of NWGestureHandler) without virtual call.
+ *  a disabled gesture has no code in the touch path and no state;
+ *  e.g. without Scroll there is no velocity tracker per touch,
+ *  without DoubleTap no SingleTap timer. no touch history, no filter,
+ *  no recorder, and all fingers are one PinchAction.
+ *  use NWGestureRecognizer when they are decided at runtime.
+ *
+ *      class MyHandler : public NWGestureHandler {
+ *      public:
+ *          void onTap( const NWPoint &p, int id ) { ... }
+ *          void onScroll( const NWPoint &p, int id ) { ... }
+ *      };
+ *      NWBasicGestureRecognizer<MyHandler, NWGestureTap, NWGestureScroll> recognizer( &handler );
+ *
+ *  like NWGestureRecognizer, call update() at getNextDeadline().
+ *  @warning handler isn't retained.
+ */
+template< class Handler,
+          class G1 = NWGestureNone, class G2 = NWGestureNone, class G3 = NWGestureNone,
+          class G4 = NWGestureNone, class G5 = NWGestureNone, class G6 = NWGestureNone >
+class NWBasicGestureRecognizer :
+    private NWBasicTapState< ( NWGestureSet<G1, G2, G3, G4, G5, G6>::MASK & NWGestureDoubleTap::MASK ) != 0 >,
+    private NWBasicTransformState< ( NWGestureSet<G1, G2, G3, G4, G5, G6>::MASK & NWGesturePinch::MASK ) == NWGesturePinch::MASK >
+{
+public:
+    enum {
+        MASK            = NWGestureSet<G1, G2, G3, G4, G5, G6>::MASK,
+        HAS_TAP         = ( MASK & NWGestureTap::MASK ) != 0,
+        HAS_DOUBLE_TAP  = ( MASK & NWGestureDoubleTap::MASK ) != 0,
+        HAS_HOLD        = ( MASK & NWGestureHold::MASK ) != 0,
+        HAS_SCROLL      = ( MASK & NWGestureScroll::MASK ) != 0,
+        HAS_MULTI_TOUCH = ( MASK & NWGestureMultiTouch::MASK ) != 0,
+        HAS_PINCH       = ( MASK & NWGesturePinch::MASK ) == NWGesturePinch::MASK,
+    };
+
+    /**
+     *  Number of touch slots. 1 (only id 0) without MultiTouch.
+     *  with it, any id takes a free slot, up to MAX_TOUCHES down at once.
+     */
+    static const int MAX_TOUCHES = HAS_MULTI_TOUCH ? NW_GESTURE_MAX_TOUCHES : 1;
+
+    explicit NWBasicGestureRecognizer( Handler *handler ) :
+    // Config: Common
+      mDistanceThresholdForMoved( 0.0f )
+    , mDistanceThresholdForMovedSq( 0.0f )
+
+    // Config: SingleTap & DoubleTap
+    , mTimeThresholdForDoubleTap( NWTimeFromSec( 0.25 ) )
+
+    // Config: Hold & Drag
+    , mTimeThresholdForHold( NWTimeFromSec( 1.0 ) )
+
+    // Config: Flick
+    , mTimeThresholdForFlick( NWTimeFromSec( 0.25 ) )
+    , mVelocityThresholdForFlick( 0.0f )
+
+    // Private Attribute
+    , mHandler( handler )
+    , mClock( NWMonotonicClock::sharedClock() )
+    {
+    }
+
+    /**
+     *  Take the thresholds of the recognizer.
+     */
+    void copyConfig( const NWGestureRecognizer &recognizer ) {
+        this->setDistanceThresholdForMoved( recognizer.getDistanceThresholdForMoved() );
+        this->setTimeThresholdForDoubleTap( recognizer.getTimeThresholdForDoubleTap() );
+        this->setTimeThresholdForHold( recognizer.getTimeThresholdForHold() );
+        this->setTimeThresholdForFlick( recognizer.getTimeThresholdForFlick() );
+        this->mVelocityThresholdForFlick = recognizer.getVelocityThresholdForFlick();
+    }
+
+    // Touch events.
+    void touchesBegan( const NWTouchSample *samples, int count );
+    void touchesMoved( const NWTouchSample *samples, int count );
+    void touchesEnded( const NWTouchSample *samples, int count );
+    void touchesCancelled( const NWTouchSample *samples, int count );
+    void touches( NWTouchPhase phase, const NWTouchSample *samples, int count ) {
+        switch( phase ) {
+            case NW_TOUCH_BEGAN:     this->touchesBegan( samples, count );      break;
+            case NW_TOUCH_MOVED:     this->touchesMoved( samples, count );      break;
+            case NW_TOUCH_ENDED:     this->touchesEnded( samples, count );      break;
+            case NW_TOUCH_CANCELLED: this->touchesCancelled( samples, count );  break;
+        }
+    }
+
+    /**
+     *  Set the time source. NULL is the platform monotonic clock.
+     *  @warning clock isn't retained.
+     */
+    void setClock( NWClock *clock ) {
+        this->mClock = clock ? clock : NWMonotonicClock::sharedClock();
+    }
+    NWClock* getClock() const {
+        return this->mClock;
+    }
+
+    /**
+     *  Fire the timed gestures (SingleTap, Hold) whose time has come.
+     */
+    void update( NWTime now ) {
+        TapState::update( this->mHandler, now, this->mTimeThresholdForDoubleTap );
+        if( HAS_HOLD ) this->holdHandler( now );
+    }
+    void update() {
+        this->update( this->mClock->now() );
+    }
+
+    /**
+     *  Get the time that update() should be called next.
+     *  @return nanosec, or negative value if there is nothing to wait.
+     */
+    NWTime getNextDeadline() const;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Accessor
+    //////////////////////////////////////////////////////////////////////
+    void setDistanceThresholdForMoved( float distance ) {
+        this->mDistanceThresholdForMoved = distance;
+        this->mDistanceThresholdForMovedSq = distance * distance;
+    }
+    float getDistanceThresholdForMoved() const {
+        return this->mDistanceThresholdForMoved;
+    }
+
+    void setTimeThresholdForDoubleTap( double time ) {
+        this->mTimeThresholdForDoubleTap = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForDoubleTap() const {
+        return NWTimeToSec( this->mTimeThresholdForDoubleTap );
+    }
+
+    void setTimeThresholdForHold( double time ) {
+        this->mTimeThresholdForHold = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForHold() const {
+        return NWTimeToSec( this->mTimeThresholdForHold );
+    }
+
+    void setTimeThresholdForFlick( double time ) {
+        this->mTimeThresholdForFlick = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForFlick() const {
+        return NWTimeToSec( this->mTimeThresholdForFlick );
+    }
+
+    /**
+     *  @param  velocity    px/sec. 0 means
+     *                      DistanceThresholdForMoved / TimeThresholdForFlick.
+     */
+    void setVelocityThresholdForFlick( float velocity ) {
+        this->mVelocityThresholdForFlick = velocity;
+    }
+    float getVelocityThresholdForFlick() const {
+        if( this->mVelocityThresholdForFlick > 0.0f ) return this->mVelocityThresholdForFlick;
+        if( this->mTimeThresholdForFlick <= 0 ) return 0.0f;
+        return this->mDistanceThresholdForMoved /
+               static_cast<float>( NWTimeToSec( this->mTimeThresholdForFlick ) );
+    }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Get touch infomation.
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Get direction of move from start ponit to end point. O(1).
+     */
+    int getDirection( int id ) const {
+        const TouchInfo *info = this->findTouchInfo( id );
+        return info ? info->getDirection( this->mDistanceThresholdForMoved ) : 0;
+    }
+
+    /**
+     *  Get the vector from start point to the latest point. O(1).
+     */
+    NWPoint getNetDisplacement( int id ) const {
+        const TouchInfo *info = this->findTouchInfo( id );
+        return info ? info->getNetDisplacement() : NWPoint();
+    }
+
+    /**
+     *  Get the velocity of the touch at its latest sample. (0, 0) without Scroll.
+     *  @return px/sec.
+     */
+    NWPoint getVelocity( int id ) const {
+        NWPoint velocity;
+        const TouchInfo *info = this->findTouchInfo( id );
+        if( info ) info->getVelocity( &velocity.x, &velocity.y );
+        return velocity;
+    }
+
+
+private:
+    typedef NWBasicTapState< HAS_DOUBLE_TAP > TapState;
+    typedef NWBasicTransformState< HAS_PINCH > TransformState;
+
+    // slot per touch. velocity only with Scroll.
+    struct TouchInfo : public NWBasicVelocityState< HAS_SCROLL > {
+        int     id;             // -1: unused.
+        NWTime  startTime;
+        bool    hasMoved;
+        bool    hasHold;
+        bool    hasEnded;
+        NWPoint startPoint;
+        NWPoint lastPoint;
+
+        TouchInfo() : id( -1 ), startTime( 0 ), hasMoved( false ), hasHold( false ), hasEnded( false ) {}
+
+        void reset( const NWTouchSample &sample ) {
+            this->id = sample.id;
+            this->startTime = sample.time;
+            this->hasMoved = false;
+            this->hasHold  = false;
+            this->hasEnded = false;
+            this->startPoint = NWPoint( sample.x, sample.y );
+            this->clearVelocity();
+            this->insertHistory( sample );
+        }
+        void insertHistory( const NWTouchSample &sample ) {
+            this->lastPoint = NWPoint( sample.x, sample.y );
+            this->addVelocitySample( sample.x, sample.y, sample.time );
+        }
+        NWPoint getNetDisplacement() const {
+            return NWPoint( this->lastPoint.x - this->startPoint.x, this->lastPoint.y - this->startPoint.y );
+        }
+        int getDirection( float correction_val ) const;
+    };
+
+    // Config Parameter
+    float   mDistanceThresholdForMoved;
+    float   mDistanceThresholdForMovedSq;
+    NWTime  mTimeThresholdForDoubleTap;
+    NWTime  mTimeThresholdForHold;
+    NWTime  mTimeThresholdForFlick;
+    float   mVelocityThresholdForFlick;
+
+    // Private Attribute
+    Handler *mHandler;
+    NWClock *mClock;
+    // a small id takes its own slot if it's free. see NWGestureRecognizer.
+    TouchInfo mTouchInfos[ MAX_TOUCHES ];
+
+    // O(1) for a small id in its own slot, O(MAX_TOUCHES) otherwise.
+    TouchInfo* findTouchInfo( int id ) {
+        if( id < 0 ) return NULL;
+        if( id < MAX_TOUCHES && this->mTouchInfos[ id ].id == id ) return &this->mTouchInfos[ id ];
+        for( int i = 0; i < MAX_TOUCHES; ++i ) {
+            if( this->mTouchInfos[i].id == id ) return &this->mTouchInfos[i];
+        }
+        return NULL;
+    }
+    const TouchInfo* findTouchInfo( int id ) const {
+        return const_cast<NWBasicGestureRecognizer*>( this )->findTouchInfo( id );
+    }
+    TouchInfo* allocateTouchInfo( int id );
+    int getSlot( const TouchInfo *info ) const {
+        return static_cast<int>( info - this->mTouchInfos );
+    }
+
+    // Hold & Drag
+    bool isHoldCandidate( const TouchInfo &ti ) const {
+        return HAS_HOLD && ti.id != -1 && !ti.hasMoved && !ti.hasEnded && !ti.hasHold &&
+               !TransformState::isTransformed( this->getSlot( &ti ) );
+    }
+    void holdHandler( NWTime now );
+
+    // noncopyable
+    NWBasicGestureRecognizer( const NWBasicGestureRecognizer& );
+    NWBasicGestureRecognizer& operator=( const NWBasicGestureRecognizer& );
+};
+
+
+#pragma -mark Touch Slot
+// the slot of the id, its own slot, a free one, then an ended one.
+// NULL while all are down, or for an id but 0 without MultiTouch.
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+typename NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::TouchInfo*
+NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::allocateTouchInfo( int id )
+{
+    if( id < 0 || ( !HAS_MULTI_TOUCH && id != 0 ) ) return NULL;
+    TouchInfo *info = this->findTouchInfo( id );
+    if( info ) return info;
+    if( id < MAX_TOUCHES ) {
+        info = &this->mTouchInfos[ id ];
+        if( info->id == -1 || info->hasEnded ) return info;
+    }
+
+    TouchInfo *ended = NULL;
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[i];
+        if( ti.id == -1 ) return &ti;
+        if( !ended && ti.hasEnded ) ended = &ti;
+    }
+    return ended;
+}
+
+
+#pragma -mark Touch Event
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+void NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::touchesBegan( const NWTouchSample *samples, int count )
+{
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        TouchInfo *info = this->allocateTouchInfo( sample.id );
+        if( !info ) continue;
+
+        int slot = this->getSlot( info );
+        // the end of the last touch of the id was lost.
+        if( info->id == sample.id && !info->hasEnded ) {
+            info->hasEnded = true;
+            if( HAS_TAP ) this->mHandler->onCancelled( info->lastPoint, info->id );
+            TransformState::removeTouch( this->mHandler, this->mTouchInfos, slot );
+        }
+        info->reset( sample );
+        TransformState::resetTouch( slot );
+
+        if( HAS_TAP ) this->mHandler->onDown( info->lastPoint, info->id );
+        TransformState::addTouch( this->mHandler, this->mTouchInfos, slot );
+    }
+}
+
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+void NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::touchesMoved( const NWTouchSample *samples, int count )
+{
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        NWPoint touch_point( sample.x, sample.y );
+
+        // check move
+        if( !info->hasMoved &&
+            info->startPoint.getDistanceSq( touch_point ) > this->mDistanceThresholdForMovedSq ) {
+            info->hasMoved = true;
+        }
+        info->insertHistory( sample );
+
+        // transform. callback once per event after all touches are updated.
+        if( TransformState::move( this->getSlot( info ) ) ) continue;
+
+        if( info->hasMoved ) {
+            if( info->hasHold ) {
+                if( HAS_HOLD ) this->mHandler->onDrag( touch_point, sample.id );
+            } else {
+                if( HAS_SCROLL ) this->mHandler->onScroll( touch_point, sample.id );
+            }
+        }
+    }
+    TransformState::endMove( this->mHandler, this->mTouchInfos );
+}
+
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+void NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::touchesEnded( const NWTouchSample *samples, int count )
+{
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        int slot = this->getSlot( info );
+        info->insertHistory( sample );
+        info->hasEnded = true;
+        TransformState::removeTouch( this->mHandler, this->mTouchInfos, slot );
+
+        NWPoint touch_point( sample.x, sample.y );
+        // end of drag.
+        if( info->hasHold ) {
+            if( HAS_HOLD ) this->mHandler->onDragEnded( touch_point, sample.id );
+
+        // Pinch Action. it was reported by transform.
+        } else if( TransformState::isTransformed( slot ) ) {
+            // pass.
+
+        // end of scroll: Flick or Swipe by the release velocity.
+        } else if( info->hasMoved ) {
+            if( HAS_SCROLL ) {
+                float vx, vy;
+                info->getVelocity( &vx, &vy );
+                float threshold = this->getVelocityThresholdForFlick();
+                int dir_flags = info->getDirection( this->mDistanceThresholdForMoved );
+                if( vx * vx + vy * vy > threshold * threshold ) {
+                    this->mHandler->onFlick( touch_point, sample.id, dir_flags, vx, vy );
+                } else {
+                    this->mHandler->onSwipe( touch_point, sample.id, dir_flags );
+                }
+            }
+
+        // end of Tap.
+        } else {
+            if( HAS_TAP ) this->mHandler->onTap( touch_point, sample.id );
+            TapState::tap( this->mHandler, sample.id, touch_point, sample.time,
+                           this->mTimeThresholdForDoubleTap, this->mDistanceThresholdForMovedSq );
+        }
+    }
+}
+
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+void NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::touchesCancelled( const NWTouchSample *samples, int count )
+{
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        info->insertHistory( sample );
+        info->hasEnded = true;
+
+        if( HAS_TAP ) this->mHandler->onCancelled( NWPoint( sample.x, sample.y ), sample.id );
+        TransformState::removeTouch( this->mHandler, this->mTouchInfos, this->getSlot( info ) );
+    }
+}
+
+
+#pragma -mark Timer
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+NWTime NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::getNextDeadline() const
+{
+    NWTime deadline = TapState::getNextDeadline( this->mTimeThresholdForDoubleTap );
+    if( !HAS_HOLD ) return deadline;
+
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        const TouchInfo &ti = this->mTouchInfos[i];
+        if( !this->isHoldCandidate( ti ) ) continue;
+
+        NWTime hold_time = ti.startTime + this->mTimeThresholdForHold;
+        if( deadline < 0 || hold_time < deadline ) deadline = hold_time;
+    }
+    return deadline;
+}
+
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+void NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::holdHandler( NWTime now )
+{
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[i];
+        if( !this->isHoldCandidate( ti ) ) continue;
+
+        if( now - ti.startTime >= this->mTimeThresholdForHold ) {
+            ti.hasHold = true;
+            this->mHandler->onHold( ti.lastPoint, ti.id );
+        }
+    }
+}
+
+template< class H, class G1, class G2, class G3, class G4, class G5, class G6 >
+int NWBasicGestureRecognizer<H, G1, G2, G3, G4, G5, G6>::TouchInfo::getDirection( float correction_val ) const
+{
+    NWPoint displacement = this->getNetDisplacement();
+    float dx = displacement.x;
+    float dy = displacement.y;
+
+    // Error correction
+    if( dx > 0.0f ) dx = dx < correction_val ? 0.0f : dx;
+    else if( dx < 0.0f ) dx = dx > -correction_val ? 0.0f : dx;
+
+    int dist = 0;
+    if( dx != 0.0f ) dist |= dx < 0.0f ? NWGestureRecognizer::LEFT : NWGestureRecognizer::RIGHT;
+    if( dy != 0.0f ) dist |= dy < 0.0f ? NWGestureRecognizer::DOWN : NWGestureRecognizer::UP;
+    return dist;
+}
+
+
+#endif /* defined(__NWBasicGestureRecognizer__) */
@@ -0,0 +1,326 @@
+//
+//  NWGeometry.cpp
+//  NoviceWorks
+//
+//  Kernels over whole touch paths in structure-of-arrays layout
+//  (x array and y array). vectorized by SSE2 or NEON if available.
+//
+//
+
+// std & platform
+#include <cmath>
+
+// myclass
+#include "NWGeometry.hpp"
+
+#if NW_GESTURE_SIMD == NW_GESTURE_SIMD_SSE2
+#include <emmintrin.h>
+#elif NW_GESTURE_SIMD == NW_GESTURE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+#pragma -mark Lane Helpers
+#if NW_GESTURE_SIMD == NW_GESTURE_SIMD_SSE2
+typedef __m128 Lanes;
+inline Lanes load( const float *p )             { return _mm_loadu_ps( p ); }
+inline Lanes splat( float v )                   { return _mm_set1_ps( v ); }
+inline Lanes add( Lanes a, Lanes b )            { return _mm_add_ps( a, b ); }
+inline Lanes sub( Lanes a, Lanes b )            { return _mm_sub_ps( a, b ); }
+inline Lanes mul( Lanes a, Lanes b )            { return _mm_mul_ps( a, b ); }
+inline Lanes lanesMin( Lanes a, Lanes b )       { return _mm_min_ps( a, b ); }
+inline Lanes lanesMax( Lanes a, Lanes b )       { return _mm_max_ps( a, b ); }
+inline Lanes lanesSqrt( Lanes a )               { return _mm_sqrt_ps( a ); }
+inline void store( float *p, Lanes a )          { _mm_storeu_ps( p, a ); }
+#elif NW_GESTURE_SIMD == NW_GESTURE_SIMD_NEON
+typedef float32x4_t Lanes;
+inline Lanes load( const float *p )             { return vld1q_f32( p ); }
+inline Lanes splat( float v )                   { return vdupq_n_f32( v ); }
+inline Lanes add( Lanes a, Lanes b )            { return vaddq_f32( a, b ); }
+inline Lanes sub( Lanes a, Lanes b )            { return vsubq_f32( a, b ); }
+inline Lanes mul( Lanes a, Lanes b )            { return vmulq_f32( a, b ); }
+inline Lanes lanesMin( Lanes a, Lanes b )       { return vminq_f32( a, b ); }
+inline Lanes lanesMax( Lanes a, Lanes b )       { return vmaxq_f32( a, b ); }
+inline Lanes lanesSqrt( Lanes a )               { return vsqrtq_f32( a ); }
+inline void store( float *p, Lanes a )          { vst1q_f32( p, a ); }
+#endif
+
+#if NW_GESTURE_SIMD != NW_GESTURE_SIMD_NONE
+inline float sum( Lanes a )
+{
+    float v[4];
+    store( v, a );
+    return ( v[0] + v[1] ) + ( v[2] + v[3] );
+}
+inline float minOf( Lanes a )
+{
+    float v[4];
+    store( v, a );
+    float m = v[0] < v[1] ? v[0] : v[1];
+    float n = v[2] < v[3] ? v[2] : v[3];
+    return m < n ? m : n;
+}
+inline float maxOf( Lanes a )
+{
+    float v[4];
+    store( v, a );
+    float m = v[0] > v[1] ? v[0] : v[1];
+    float n = v[2] > v[3] ? v[2] : v[3];
+    return m > n ? m : n;
+}
+#endif
+
+
+#pragma -mark Resample
+// lengths of count (<= 4) segments from the point 0.
+void segmentLengthsScalar( const float *xs, const float *ys, int count, float *lengths )
+{
+    for( int i = 0; i < count; ++i ) {
+        float dx = xs[i + 1] - xs[i];
+        float dy = ys[i + 1] - ys[i];
+        lengths[i] = sqrtf( dx * dx + dy * dy );
+    }
+}
+
+#if NW_GESTURE_SIMD != NW_GESTURE_SIMD_NONE
+void segmentLengthsSimd( const float *xs, const float *ys, int count, float *lengths )
+{
+    if( count < 4 ) {
+        segmentLengthsScalar( xs, ys, count, lengths );
+        return;
+    }
+    Lanes dx = sub( load( xs + 1 ), load( xs ) );
+    Lanes dy = sub( load( ys + 1 ), load( ys ) );
+    store( lengths, lanesSqrt( add( mul( dx, dx ), mul( dy, dy ) ) ) );
+}
+#endif
+
+// walk the path 4 segments at a time. the lengths come from the kernel.
+bool resampleWalk( const float *xs, const float *ys, int count,
+                   float *out_xs, float *out_ys, int out_count, float length,
+                   void (*segment_lengths)( const float*, const float*, int, float* ) )
+{
+    if( count < 2 || out_count < 2 || !( length > 0.0f ) ) return false;
+
+    float interval = length / ( out_count - 1 );
+    float d = 0.0f;
+    float px = xs[0], py = ys[0];
+    out_xs[0] = px;
+    out_ys[0] = py;
+    int m = 1;
+    float lengths[4];
+    for( int i = 0; i < count - 1 && m < out_count; i += 4 ) {
+        int n = count - 1 - i < 4 ? count - 1 - i : 4;
+        segment_lengths( xs + i, ys + i, n, lengths );
+        for( int j = 0; j < n; ++j ) {
+            float segment = lengths[j];
+            float cx = xs[i + j + 1], cy = ys[i + j + 1];
+            while( segment > 0.0f && d + segment >= interval && m < out_count ) {
+                float step = interval - d;
+                float t = step / segment;
+                px += t * ( cx - px );
+                py += t * ( cy - py );
+                out_xs[m] = px;
+                out_ys[m] = py;
+                ++m;
+                segment -= step;
+                d = 0.0f;
+            }
+            if( segment > 0.0f ) d += segment;
+            px = cx;
+            py = cy;
+        }
+    }
+
+    // rounding error at the end.
+    for( ; m < out_count; ++m ) {
+        out_xs[m] = xs[count - 1];
+        out_ys[m] = ys[count - 1];
+    }
+    out_xs[out_count - 1] = xs[count - 1];
+    out_ys[out_count - 1] = ys[count - 1];
+    return true;
+}
+
+} // unnamed namespace
+
+
+#pragma -mark Scalar
+float NWPathLengthScalar( const float *xs, const float *ys, int count )
+{
+    float length = 0.0f;
+    for( int i = 0; i + 1 < count; ++i ) {
+        float dx = xs[i + 1] - xs[i];
+        float dy = ys[i + 1] - ys[i];
+        length += sqrtf( dx * dx + dy * dy );
+    }
+    return length;
+}
+
+NWRect NWBoundingBoxScalar( const float *xs, const float *ys, int count )
+{
+    if( count <= 0 ) return NWRect();
+    float min_x = xs[0], max_x = xs[0];
+    float min_y = ys[0], max_y = ys[0];
+    for( int i = 1; i < count; ++i ) {
+        if( xs[i] < min_x ) min_x = xs[i];
+        if( xs[i] > max_x ) max_x = xs[i];
+        if( ys[i] < min_y ) min_y = ys[i];
+        if( ys[i] > max_y ) max_y = ys[i];
+    }
+    return NWRect( min_x, min_y, max_x - min_x, max_y - min_y );
+}
+
+NWPoint NWCentroidScalar( const float *xs, const float *ys, int count )
+{
+    if( count <= 0 ) return NWPoint();
+    float sx = 0.0f, sy = 0.0f;
+    for( int i = 0; i < count; ++i ) {
+        sx += xs[i];
+        sy += ys[i];
+    }
+    return NWPoint( sx / count, sy / count );
+}
+
+bool NWResampleScalar( const float *xs, const float *ys, int count,
+                       float *out_xs, float *out_ys, int out_count )
+{
+    return resampleWalk( xs, ys, count, out_xs, out_ys, out_count,
+                         NWPathLengthScalar( xs, ys, count ), segmentLengthsScalar );
+}
+
+void NWDotCrossScalar( const float *ax, const float *ay, const float *bx, const float *by,
+                       int count, float *dot, float *cross )
+{
+    float d = 0.0f, c = 0.0f;
+    for( int i = 0; i < count; ++i ) {
+        d += ax[i] * bx[i] + ay[i] * by[i];
+        c += ax[i] * by[i] - ay[i] * bx[i];
+    }
+    *dot = d;
+    *cross = c;
+}
+
+
+#pragma -mark Dispatch
+#if NW_GESTURE_SIMD == NW_GESTURE_SIMD_NONE
+
+const char* NWGeometryBackend() { return "scalar"; }
+
+float NWPathLength( const float *xs, const float *ys, int count )
+{
+    return NWPathLengthScalar( xs, ys, count );
+}
+
+NWRect NWBoundingBox( const float *xs, const float *ys, int count )
+{
+    return NWBoundingBoxScalar( xs, ys, count );
+}
+
+NWPoint NWCentroid( const float *xs, const float *ys, int count )
+{
+    return NWCentroidScalar( xs, ys, count );
+}
+
+bool NWResample( const float *xs, const float *ys, int count,
+                 float *out_xs, float *out_ys, int out_count )
+{
+    return NWResampleScalar( xs, ys, count, out_xs, out_ys, out_count );
+}
+
+void NWDotCross( const float *ax, const float *ay, const float *bx, const float *by,
+                 int count, float *dot, float *cross )
+{
+    NWDotCrossScalar( ax, ay, bx, by, count, dot, cross );
+}
+
+#else
+
+const char* NWGeometryBackend()
+{
+    return NW_GESTURE_SIMD == NW_GESTURE_SIMD_SSE2 ? "sse2" : "neon";
+}
+
+float NWPathLength( const float *xs, const float *ys, int count )
+{
+    Lanes acc = splat( 0.0f );
+    int i = 0;
+    for( ; i + 4 < count; i += 4 ) {
+        Lanes dx = sub( load( xs + i + 1 ), load( xs + i ) );
+        Lanes dy = sub( load( ys + i + 1 ), load( ys + i ) );
+        acc = add( acc, lanesSqrt( add( mul( dx, dx ), mul( dy, dy ) ) ) );
+    }
+    return sum( acc ) + NWPathLengthScalar( xs + i, ys + i, count - i );
+}
+
+NWRect NWBoundingBox( const float *xs, const float *ys, int count )
+{
+    if( count < 4 ) return NWBoundingBoxScalar( xs, ys, count );
+
+    Lanes min_x = load( xs ), max_x = min_x;
+    Lanes min_y = load( ys ), max_y = min_y;
+    int i = 4;
+    for( ; i + 4 <= count; i += 4 ) {
+        Lanes x = load( xs + i );
+        Lanes y = load( ys + i );
+        min_x = lanesMin( min_x, x );
+        max_x = lanesMax( max_x, x );
+        min_y = lanesMin( min_y, y );
+        max_y = lanesMax( max_y, y );
+    }
+    float x0 = minOf( min_x ), x1 = maxOf( max_x );
+    float y0 = minOf( min_y ), y1 = maxOf( max_y );
+    for( ; i < count; ++i ) {
+        if( xs[i] < x0 ) x0 = xs[i];
+        if( xs[i] > x1 ) x1 = xs[i];
+        if( ys[i] < y0 ) y0 = ys[i];
+        if( ys[i] > y1 ) y1 = ys[i];
+    }
+    return NWRect( x0, y0, x1 - x0, y1 - y0 );
+}
+
+NWPoint NWCentroid( const float *xs, const float *ys, int count )
+{
+    if( count <= 0 ) return NWPoint();
+
+    Lanes sx = splat( 0.0f ), sy = splat( 0.0f );
+    int i = 0;
+    for( ; i + 4 <= count; i += 4 ) {
+        sx = add( sx, load( xs + i ) );
+        sy = add( sy, load( ys + i ) );
+    }
+    float x = sum( sx ), y = sum( sy );
+    for( ; i < count; ++i ) {
+        x += xs[i];
+        y += ys[i];
+    }
+    return NWPoint( x / count, y / count );
+}
+
+bool NWResample( const float *xs, const float *ys, int count,
+                 float *out_xs, float *out_ys, int out_count )
+{
+    return resampleWalk( xs, ys, count, out_xs, out_ys, out_count,
+                         NWPathLength( xs, ys, count ), segmentLengthsSimd );
+}
+
+void NWDotCross( const float *ax, const float *ay, const float *bx, const float *by,
+                 int count, float *dot, float *cross )
+{
+    Lanes d = splat( 0.0f ), c = splat( 0.0f );
+    int i = 0;
+    for( ; i + 4 <= count; i += 4 ) {
+        Lanes x0 = load( ax + i ), y0 = load( ay + i );
+        Lanes x1 = load( bx + i ), y1 = load( by + i );
+        d = add( d, add( mul( x0, x1 ), mul( y0, y1 ) ) );
+        c = add( c, sub( mul( x0, y1 ), mul( y0, x1 ) ) );
+    }
+    float tail_dot, tail_cross;
+    NWDotCrossScalar( ax + i, ay + i, bx + i, by + i, count - i, &tail_dot, &tail_cross );
+    *dot = sum( d ) + tail_dot;
+    *cross = sum( c ) + tail_cross;
+}
+
+#endif
@@ -0,0 +1,78 @@
+//
+//  NWGeometry.hpp
+//  NoviceWorks
+//
+//  Kernels over whole touch paths in structure-of-arrays layout
+//  (x array and y array). vectorized by SSE2 or NEON if available.
+//
+//
+
+#ifndef __NWGeometry__
+#define __NWGeometry__
+
+#include "NWGestureRecognizer.hpp"
+
+#define NW_GESTURE_SIMD_NONE    0
+#define NW_GESTURE_SIMD_SSE2    1
+#define NW_GESTURE_SIMD_NEON    2
+
+// Instruction set of the kernels. chosen at build time.
+// -DNW_GESTURE_SIMD=0 forces the scalar code.
+#ifndef NW_GESTURE_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define NW_GESTURE_SIMD NW_GESTURE_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define NW_GESTURE_SIMD NW_GESTURE_SIMD_NEON
+#else
+#define NW_GESTURE_SIMD NW_GESTURE_SIMD_NONE
+#endif
+#endif
+
+/**
+ *  Get the name of the instruction set the kernels use. "sse2", "neon" or "scalar".
+ */
+const char* NWGeometryBackend();
+
+/**
+ *  Get the length of the path through the points.
+ */
+float NWPathLength( const float *xs, const float *ys, int count );
+
+/**
+ *  Get the smallest rectangle which has all points. empty if count is 0.
+ */
+NWRect NWBoundingBox( const float *xs, const float *ys, int count );
+
+/**
+ *  Get the mean of the points. (0, 0) if count is 0.
+ */
+NWPoint NWCentroid( const float *xs, const float *ys, int count );
+
+/**
+ *  Resample the path to out_count points at equal distance along it.
+ *  the first and the last points are kept.
+ *  @return false if the path has no length, or out_count < 2.
+ */
+bool NWResample( const float *xs, const float *ys, int count,
+                 float *out_xs, float *out_ys, int out_count );
+
+/**
+ *  Sum of dot and cross products of the point pairs, i.e. for each i
+ *  dot += ax*bx + ay*by, cross += ax*by - ay*bx.
+ *  with normalized paths, dot is the cosine similarity of a and b.
+ */
+void NWDotCross( const float *ax, const float *ay, const float *bx, const float *by,
+                 int count, float *dot, float *cross );
+
+// the scalar code of the kernels above, always available.
+// the vectorized ones match them within the rounding of the summation order.
+float   NWPathLengthScalar( const float *xs, const float *ys, int count );
+NWRect  NWBoundingBoxScalar( const float *xs, const float *ys, int count );
+NWPoint NWCentroidScalar( const float *xs, const float *ys, int count );
+bool    NWResampleScalar( const float *xs, const float *ys, int count,
+                          float *out_xs, float *out_ys, int out_count );
+void    NWDotCrossScalar( const float *ax, const float *ay, const float *bx, const float *by,
+                          int count, float *dot, float *cross );
+
+
+#endif /* defined(__NWGeometry__) */
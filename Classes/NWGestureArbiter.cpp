@@ -0,0 +1,361 @@
+//
+//  NWGestureArbiter.cpp
+//  NoviceWorks
+//
+//  Pluggable gesture recognizers with explicit states, and the arbiter
+//  which decides which of them win.
+//
+//
+
+// std
+#include <algorithm>
+
+// myclass
+#include "NWGestureArbiter.hpp"
+
+
+namespace {
+
+// receiver used while no listener is set.
+NWGestureListener sNullListener;
+
+bool contains( const std::vector<NWStateRecognizer*> &list, const NWStateRecognizer *r )
+{
+    return std::find( list.begin(), list.end(), r ) != list.end();
+}
+
+void erase( std::vector<NWStateRecognizer*> &list, const NWStateRecognizer *r )
+{
+    list.erase( std::remove( list.begin(), list.end(), r ), list.end() );
+}
+
+} // unnamed namespace
+
+
+#pragma -mark NWStateRecognizer
+NWStateRecognizer::NWStateRecognizer() :
+  mState( POSSIBLE )
+, mIsHeld( false )
+, mTouchMask( 0 )
+, mPriority( 0 )
+, mArbiter( NULL )
+{
+}
+
+NWStateRecognizer::~NWStateRecognizer()
+{
+    if( this->mArbiter ) this->mArbiter->removeRecognizer( this );
+}
+
+void NWStateRecognizer::requireToFail( NWStateRecognizer *other )
+{
+    if( other && other != this && !contains( this->mRequireToFail, other ) ) {
+        this->mRequireToFail.push_back( other );
+    }
+}
+
+void NWStateRecognizer::allowSimultaneous( NWStateRecognizer *other )
+{
+    if( !other || other == this ) return;
+    if( !contains( this->mSimultaneous, other ) ) this->mSimultaneous.push_back( other );
+    if( !contains( other->mSimultaneous, this ) ) other->mSimultaneous.push_back( this );
+}
+
+bool NWStateRecognizer::canRecognizeWith( const NWStateRecognizer *other ) const
+{
+    return contains( this->mSimultaneous, other );
+}
+
+// default: a cancelled finger ends the gesture.
+void NWStateRecognizer::touchCancelled( const NWArbiterTouch &touch )
+{
+    this->setState( this->isActive() ? CANCELLED : FAILED );
+}
+
+void NWStateRecognizer::setState( State state )
+{
+    if( this->mArbiter ) this->mArbiter->changeState( this, state );
+    else                 this->mState = state;
+}
+
+
+#pragma -mark Class Basic Method.
+NWGestureArbiter::NWGestureArbiter() :
+  mDownCount( 0 )
+, mListener( &sNullListener )
+, mClock( NWMonotonicClock::sharedClock() )
+{
+}
+
+NWGestureArbiter::~NWGestureArbiter()
+{
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        this->mRecognizers[i]->mArbiter = NULL;
+    }
+}
+
+void NWGestureArbiter::addRecognizer( NWStateRecognizer *recognizer )
+{
+    if( !recognizer || recognizer->mArbiter == this ) return;
+    if( recognizer->mArbiter ) recognizer->mArbiter->removeRecognizer( recognizer );
+
+    recognizer->mArbiter = this;
+    recognizer->mPriority = static_cast<int>( this->mRecognizers.size() );
+    this->mRecognizers.push_back( recognizer );
+}
+
+void NWGestureArbiter::removeRecognizer( NWStateRecognizer *recognizer )
+{
+    if( !recognizer || recognizer->mArbiter != this ) return;
+    erase( this->mRecognizers, recognizer );
+    recognizer->mArbiter = NULL;
+
+    // nobody waits for it any more.
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        NWStateRecognizer *r = this->mRecognizers[i];
+        r->mPriority = i;
+        erase( r->mRequireToFail, recognizer );
+        erase( r->mSimultaneous, recognizer );
+    }
+    this->release( recognizer );
+}
+
+void NWGestureArbiter::setListener( NWGestureListener *listener )
+{
+    this->mListener = listener ? listener : &sNullListener;
+}
+
+NWGestureListener* NWGestureArbiter::getListener()
+{
+    return this->mListener == &sNullListener ? NULL : this->mListener;
+}
+
+void NWGestureArbiter::setClock( NWClock *clock )
+{
+    this->mClock = clock ? clock : NWMonotonicClock::sharedClock();
+}
+
+const NWArbiterTouch* NWGestureArbiter::getTouch( int id ) const
+{
+    int slot = this->findSlot( id );
+    return slot >= 0 ? &this->mTouches[ slot ] : NULL;
+}
+
+// O(1) for a small id in its own slot, O(MAX_TOUCHES) otherwise.
+int NWGestureArbiter::findSlot( int id ) const
+{
+    if( id < 0 ) return -1;
+    if( id < NWGestureRecognizer::MAX_TOUCHES && this->mTouches[id].id == id ) return id;
+    for( int i = 0; i < NWGestureRecognizer::MAX_TOUCHES; ++i ) {
+        if( this->mTouches[i].id == id ) return i;
+    }
+    return -1;
+}
+
+// the slot of the id, its own slot, an unused one, then an up one.
+// -1 while all are down.
+int NWGestureArbiter::allocateSlot( int id ) const
+{
+    int slot = this->findSlot( id );
+    if( slot >= 0 ) return slot;
+    if( id < NWGestureRecognizer::MAX_TOUCHES && !this->mTouches[id].isDown ) return id;
+
+    int up = -1;
+    for( int i = 0; i < NWGestureRecognizer::MAX_TOUCHES; ++i ) {
+        if( this->mTouches[i].id == -1 ) return i;
+        if( up < 0 && !this->mTouches[i].isDown ) up = i;
+    }
+    return up;
+}
+
+
+#pragma -mark Touch Event
+// only the recognizers not finished get the touches.
+void NWGestureArbiter::touches( NWTouchPhase phase, const NWTouchSample *samples, int count )
+{
+    int n = static_cast<int>( this->mRecognizers.size() );
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( sample.id < 0 ) continue;
+        int slot = phase == NW_TOUCH_BEGAN ? this->allocateSlot( sample.id ) : this->findSlot( sample.id );
+        if( slot < 0 ) continue;
+
+        NWArbiterTouch &touch = this->mTouches[ slot ];
+        NWPoint point( sample.x, sample.y );
+        if( phase == NW_TOUCH_BEGAN ) {
+            if( !touch.isDown ) ++this->mDownCount;
+            touch.id = sample.id;
+            touch.isDown = true;
+            touch.startPoint = point;
+            touch.startTime = sample.time;
+            touch.velocityTracker.clear();
+        } else {
+            if( !touch.isDown ) continue;
+            if( phase != NW_TOUCH_MOVED ) {
+                touch.isDown = false;
+                --this->mDownCount;
+            }
+        }
+        touch.point = point;
+        touch.time = sample.time;
+        touch.velocityTracker.addSample( sample.x, sample.y, sample.time );
+        if( phase == NW_TOUCH_BEGAN ) this->mListener->onDown( point, sample.id );
+
+        unsigned int bit = 1u << slot;
+        for( int r = 0; r < n; ++r ) {
+            NWStateRecognizer *recognizer = this->mRecognizers[r];
+            if( recognizer->isFinished() ) continue;
+            if( phase == NW_TOUCH_BEGAN ) {
+                recognizer->mTouchMask |= bit;
+            } else if( !( recognizer->mTouchMask & bit ) ) {
+                continue;
+            }
+
+            switch( phase ) {
+                case NW_TOUCH_BEGAN:     recognizer->touchBegan( touch );     break;
+                case NW_TOUCH_MOVED:     recognizer->touchMoved( touch );     break;
+                case NW_TOUCH_ENDED:     recognizer->touchEnded( touch );     break;
+                case NW_TOUCH_CANCELLED: recognizer->touchCancelled( touch ); break;
+            }
+        }
+    }
+
+    for( int r = 0; r < n; ++r ) {
+        if( !this->mRecognizers[r]->isFinished() ) this->mRecognizers[r]->touchesDone();
+    }
+    this->resetFinished();
+}
+
+
+#pragma -mark Timer
+void NWGestureArbiter::update( NWTime now )
+{
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        NWStateRecognizer *recognizer = this->mRecognizers[i];
+        if( recognizer->isFinished() ) continue;
+
+        NWTime deadline = recognizer->getDeadline();
+        if( deadline >= 0 && deadline <= now ) recognizer->timer( now );
+    }
+    this->resetFinished();
+}
+
+NWTime NWGestureArbiter::getNextDeadline() const
+{
+    NWTime deadline = -1;
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        const NWStateRecognizer *recognizer = this->mRecognizers[i];
+        if( recognizer->isFinished() ) continue;
+
+        NWTime d = recognizer->getDeadline();
+        if( d >= 0 && ( deadline < 0 || d < deadline ) ) deadline = d;
+    }
+    return deadline;
+}
+
+// start over when all fingers are up.
+void NWGestureArbiter::resetFinished()
+{
+    if( this->mDownCount > 0 ) return;
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        NWStateRecognizer *recognizer = this->mRecognizers[i];
+        if( !recognizer->isFinished() || recognizer->mIsHeld ) continue;
+        recognizer->reset();
+        recognizer->mState = NWStateRecognizer::POSSIBLE;
+        recognizer->mTouchMask = 0;
+    }
+}
+
+
+#pragma -mark Arbitration
+bool NWGestureArbiter::isConflicting( const NWStateRecognizer *a, const NWStateRecognizer *b ) const
+{
+    return a != b && ( a->mTouchMask & b->mTouchMask ) && !a->canRecognizeWith( b );
+}
+
+void NWGestureArbiter::changeState( NWStateRecognizer *recognizer, NWStateRecognizer::State state )
+{
+    typedef NWStateRecognizer R;
+    if( recognizer->isFinished() ) return;
+
+    if( state == R::FAILED || state == R::CANCELLED ) {
+        this->fail( recognizer, state );
+        return;
+    }
+
+    // recognized now.
+    if( recognizer->mState == R::POSSIBLE ) {
+        recognizer->mState = state == R::CHANGED ? R::BEGAN : state;
+        if( this->accept( recognizer ) ) recognizer->deliver( this->mListener );
+        return;
+    }
+
+    recognizer->mState = state;
+    if( !recognizer->mIsHeld ) recognizer->deliver( this->mListener );
+}
+
+// can the recognized one go? fails or holds it if not.
+bool NWGestureArbiter::accept( NWStateRecognizer *recognizer )
+{
+    // wait for the others to fail.
+    bool is_waiting = false;
+    for( int i = 0; i < static_cast<int>( recognizer->mRequireToFail.size() ); ++i ) {
+        const NWStateRecognizer *other = recognizer->mRequireToFail[i];
+        if( other->isRecognized() && !other->mIsHeld ) {
+            this->fail( recognizer, NWStateRecognizer::FAILED );
+            return false;
+        }
+        if( !other->isFinished() || other->mIsHeld ) is_waiting = true;
+    }
+    recognizer->mIsHeld = is_waiting;
+    if( is_waiting ) return false;
+
+    // the higher one on the same fingers has won already.
+    int n = static_cast<int>( this->mRecognizers.size() );
+    for( int i = 0; i < recognizer->mPriority && i < n; ++i ) {
+        const NWStateRecognizer *other = this->mRecognizers[i];
+        if( other->isRecognized() && !other->mIsHeld && this->isConflicting( recognizer, other ) ) {
+            this->fail( recognizer, NWStateRecognizer::FAILED );
+            return false;
+        }
+    }
+
+    // the lower ones on the same fingers, and the ones waiting for this, lose.
+    for( int i = 0; i < n; ++i ) {
+        NWStateRecognizer *other = this->mRecognizers[i];
+        if( other == recognizer || other->mState == NWStateRecognizer::FAILED ||
+            other->mState == NWStateRecognizer::CANCELLED ) continue;
+
+        bool loses = contains( other->mRequireToFail, recognizer ) ||
+                     ( i > recognizer->mPriority && this->isConflicting( recognizer, other ) );
+        if( !loses ) continue;
+        if( other->isActive() && !other->mIsHeld ) {
+            this->fail( other, NWStateRecognizer::CANCELLED );
+        } else if( other->mState == NWStateRecognizer::POSSIBLE || other->mIsHeld ) {
+            this->fail( other, NWStateRecognizer::FAILED );
+        }
+    }
+    return true;
+}
+
+void NWGestureArbiter::fail( NWStateRecognizer *recognizer, NWStateRecognizer::State state )
+{
+    bool was_delivered = recognizer->isActive() && !recognizer->mIsHeld;
+    recognizer->mState = state;
+    recognizer->mIsHeld = false;
+
+    // let it close what it has started. e.g. DragEnded.
+    if( was_delivered && state == NWStateRecognizer::CANCELLED ) recognizer->deliver( this->mListener );
+    this->release( recognizer );
+}
+
+// deliver the ones which were waiting for the failed one.
+void NWGestureArbiter::release( NWStateRecognizer *failed )
+{
+    for( int i = 0; i < static_cast<int>( this->mRecognizers.size() ); ++i ) {
+        NWStateRecognizer *other = this->mRecognizers[i];
+        if( !other->mIsHeld ) continue;
+        if( failed->mArbiter == this && !contains( other->mRequireToFail, failed ) ) continue;
+        if( this->accept( other ) ) other->deliver( this->mListener );
+    }
+}
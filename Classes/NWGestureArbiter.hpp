@@ -0,0 +1,226 @@
+//
+//  NWGestureArbiter.hpp
+//  NoviceWorks
+//
+//  Pluggable gesture recognizers with explicit states, and the arbiter
+//  which decides which of them win.
+//
+//
+
+#ifndef __NWGestureArbiter__
+#define __NWGestureArbiter__
+
+#include <vector>
+
+#include "NWGestureRecognizer.hpp"
+#include "NWVelocityTracker.hpp"
+
+class NWGestureArbiter;
+
+/**
+ *  @struct NWArbiterTouch
+ *  @brief  A finger seen by NWGestureArbiter. shared by all recognizers.
+ */
+struct NWArbiterTouch
+{
+    int     id;
+    bool    isDown;
+    NWPoint startPoint;
+    NWTime  startTime;
+    NWPoint point;          // latest.
+    NWTime  time;
+    NWVelocityTracker velocityTracker;
+
+    NWArbiterTouch() : id( -1 ), isDown( false ), startTime( 0 ), time( 0 ) {}
+
+    float getDistance() const { return this->startPoint.getDistance( this->point ); }
+    float getDistanceSq() const { return this->startPoint.getDistanceSq( this->point ); }
+};
+
+
+/**
+ *  @class  NWStateRecognizer
+ *  @brief  One gesture recognizer plugged into NWGestureArbiter.
+ *
+ *  it starts POSSIBLE, and moves by setState():
+ *  - discrete gesture (Tap)   : POSSIBLE -> ENDED, or FAILED.
+ *  - continuous gesture (Pan) : POSSIBLE -> BEGAN -> CHANGED... -> ENDED,
+ *                               or FAILED, or CANCELLED by the arbiter.
+ *  the arbiter calls deliver() for each state it accepts, and reset()
+ *  when all fingers are up and it's finished. finished recognizers don't
+ *  receive the touches any more until reset().
+ */
+class NWStateRecognizer
+{
+public:
+    enum State {
+        POSSIBLE = 0,
+        BEGAN,
+        CHANGED,
+        ENDED,
+        FAILED,
+        CANCELLED,
+    };
+
+    NWStateRecognizer();
+    virtual ~NWStateRecognizer();
+
+    State getState() const { return this->mState; }
+    bool isActive() const { return this->mState == BEGAN || this->mState == CHANGED; }
+    bool isRecognized() const { return this->isActive() || this->mState == ENDED; }
+    bool isFinished() const { return this->mState >= ENDED; }
+
+    /**
+     *  Hold back this one until other fails. e.g. SingleTap waits DoubleTap.
+     *  if other is recognized, this one fails.
+     */
+    void requireToFail( NWStateRecognizer *other );
+
+    /**
+     *  Let this one and other be recognized at once on the same fingers.
+     *  both ways.
+     */
+    void allowSimultaneous( NWStateRecognizer *other );
+    bool canRecognizeWith( const NWStateRecognizer *other ) const;
+
+    /**
+     *  Get the fingers this one has received since reset().
+     *  bit ( 1 << slot ), the slot of the touch in the arbiter, not its id.
+     */
+    unsigned int getTouchMask() const { return this->mTouchMask; }
+
+    NWGestureArbiter* getArbiter() const { return this->mArbiter; }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Override
+    //////////////////////////////////////////////////////////////////////
+    virtual void touchBegan( const NWArbiterTouch &touch ) {}
+    virtual void touchMoved( const NWArbiterTouch &touch ) {}
+    virtual void touchEnded( const NWArbiterTouch &touch ) {}
+    virtual void touchCancelled( const NWArbiterTouch &touch );
+
+    /**
+     *  Called once after all touches of a touch event.
+     */
+    virtual void touchesDone() {}
+
+    /**
+     *  Get the time timer() should be called. negative: nothing to wait.
+     */
+    virtual NWTime getDeadline() const { return -1; }
+    virtual void timer( NWTime now ) {}
+
+    /**
+     *  Forget the gesture. state is back to POSSIBLE after this.
+     */
+    virtual void reset() {}
+
+    /**
+     *  Call the callbacks of the accepted state (getState()).
+     */
+    virtual void deliver( NWGestureListener *listener ) {}
+
+protected:
+    /**
+     *  Move to the state. the arbiter may refuse it (it's FAILED then),
+     *  or hold it until requireToFail() ones fail.
+     */
+    void setState( State state );
+
+private:
+    friend class NWGestureArbiter;
+
+    State   mState;
+    bool    mIsHeld;        // recognized, waiting for requireToFail() ones.
+    unsigned int mTouchMask;
+    int     mPriority;      // order in the arbiter. smaller wins.
+    NWGestureArbiter *mArbiter;
+    std::vector<NWStateRecognizer*> mRequireToFail;
+    std::vector<NWStateRecognizer*> mSimultaneous;
+
+    NWStateRecognizer( const NWStateRecognizer& );
+    NWStateRecognizer& operator=( const NWStateRecognizer& );
+};
+
+
+/**
+ *  @class  NWGestureArbiter
+ *  @brief  Drives NWStateRecognizers and resolves their conflicts.
+ *
+ *  same touch / timer interface as NWGestureRecognizer, so it can take
+ *  its place (see NWGestureLayer::setArbiter()).
+ *
+ *  two recognizers conflict if they have a finger in common and are not
+ *  allowSimultaneous(). when one is recognized:
+ *  - if a conflicting one added before it is recognized, it fails.
+ *  - otherwise the conflicting ones added after it are cancelled
+ *    (active) or failed (possible).
+ *  so the order of addRecognizer() is the priority.
+ */
+class NWGestureArbiter
+{
+public:
+    NWGestureArbiter();
+    ~NWGestureArbiter();
+
+    /**
+     *  Add a recognizer. the earlier one has the higher priority.
+     *  @warning recognizer isn't retained.
+     */
+    void addRecognizer( NWStateRecognizer *recognizer );
+    void removeRecognizer( NWStateRecognizer *recognizer );
+    int getRecognizerCount() const { return static_cast<int>( this->mRecognizers.size() ); }
+
+    /**
+     *  Set the receiver of gestures. NULL discards all gestures.
+     *  @warning listener isn't retained.
+     */
+    void setListener( NWGestureListener *listener );
+    NWGestureListener* getListener();
+
+    void setClock( NWClock *clock );
+    NWClock* getClock() const { return this->mClock; }
+
+    // Touch events. onDown is called for each new finger, like NWGestureRecognizer.
+    void touches( NWTouchPhase phase, const NWTouchSample *samples, int count );
+
+    /**
+     *  Call timer() of the recognizers whose deadline has come.
+     */
+    void update( NWTime now );
+    void update() { this->update( this->mClock->now() ); }
+    NWTime getNextDeadline() const;
+
+    /**
+     *  @return NULL if there is no touch of id.
+     *  @warning the touch of an up finger is kept until its slot is reused.
+     */
+    const NWArbiterTouch* getTouch( int id ) const;
+    int getDownCount() const { return this->mDownCount; }
+
+private:
+    friend class NWStateRecognizer;
+
+    std::vector<NWStateRecognizer*> mRecognizers;
+    // any id takes a slot; a small id its own one if it's up. see NWGestureRecognizer.
+    NWArbiterTouch  mTouches[ NWGestureRecognizer::MAX_TOUCHES ];
+    int             mDownCount;
+    NWGestureListener *mListener;
+    NWClock        *mClock;
+
+    int findSlot( int id ) const;
+    int allocateSlot( int id ) const;
+    void changeState( NWStateRecognizer *recognizer, NWStateRecognizer::State state );
+    bool isConflicting( const NWStateRecognizer *a, const NWStateRecognizer *b ) const;
+    bool accept( NWStateRecognizer *recognizer );
+    void release( NWStateRecognizer *failed );
+    void fail( NWStateRecognizer *recognizer, NWStateRecognizer::State state );
+    void resetFinished();
+
+    NWGestureArbiter( const NWGestureArbiter& );
+    NWGestureArbiter& operator=( const NWGestureArbiter& );
+};
+
+
+#endif /* defined(__NWGestureArbiter__) */
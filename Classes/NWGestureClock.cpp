@@ -0,0 +1,49 @@
+//
+//  NWGestureClock.cpp
+//  NoviceWorks
+//
+//  Time source of NWGestureRecognizer.
+//
+//
+
+// platform
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// myclass
+#include "NWGestureClock.hpp"
+
+
+#pragma -mark NWMonotonicClock
+NWTime NWMonotonicClock::now()
+{
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if( timebase.denom == 0 ) mach_timebase_info( &timebase );
+    uint64_t ticks = mach_absolute_time();
+    return static_cast<NWTime>( ticks / timebase.denom * timebase.numer +
+                                ticks % timebase.denom * timebase.numer / timebase.denom );
+#elif defined(_WIN32)
+    static LARGE_INTEGER frequency = { 0 };
+    if( frequency.QuadPart == 0 ) QueryPerformanceFrequency( &frequency );
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter( &counter );
+    return static_cast<NWTime>( counter.QuadPart / frequency.QuadPart * 1000000000LL +
+                                counter.QuadPart % frequency.QuadPart * 1000000000LL / frequency.QuadPart );
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return static_cast<NWTime>( ts.tv_sec ) * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+NWMonotonicClock* NWMonotonicClock::sharedClock()
+{
+    static NWMonotonicClock clock;
+    return &clock;
+}
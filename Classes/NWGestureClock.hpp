@@ -0,0 +1,71 @@
+//
+//  NWGestureClock.hpp
+//  NoviceWorks
+//
+//  Time source of NWGestureRecognizer.
+//
+//
+
+#ifndef __NWGestureClock__
+#define __NWGestureClock__
+
+#include <stdint.h>
+
+/**
+ *  Time of the gesture recognizer. nanoseconds of a monotonic clock.
+ */
+typedef int64_t NWTime;
+
+inline NWTime NWTimeFromSec( double sec ) {
+    return static_cast<NWTime>( sec * 1000000000.0 + ( sec < 0.0 ? -0.5 : 0.5 ) );
+}
+inline double NWTimeToSec( NWTime time ) {
+    return static_cast<double>( time ) * 0.000000001;
+}
+
+
+/**
+ *  @class  NWClock
+ *  @brief  Interface of the time source. swap it for tests and benchmarks.
+ */
+class NWClock
+{
+public:
+    virtual ~NWClock() {}
+    virtual NWTime now() = 0;
+};
+
+/**
+ *  @class  NWMonotonicClock
+ *  @brief  Platform monotonic clock. not affected by the wall clock (NTP).
+ */
+class NWMonotonicClock : public NWClock
+{
+public:
+    virtual NWTime now();
+
+    /**
+     *  Get the shared instance. default clock of NWGestureRecognizer.
+     */
+    static NWMonotonicClock* sharedClock();
+};
+
+/**
+ *  @class  NWManualClock
+ *  @brief  Virtual time which moves only when it's told.
+ */
+class NWManualClock : public NWClock
+{
+public:
+    explicit NWManualClock( NWTime start = 0 ) : mNow( start ) {}
+
+    virtual NWTime now()            { return this->mNow; }
+    void setTime( NWTime time )     { this->mNow = time; }
+    void advance( NWTime delta )    { this->mNow += delta; }
+
+private:
+    NWTime mNow;
+};
+
+
+#endif /* defined(__NWGestureClock__) */
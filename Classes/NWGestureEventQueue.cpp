@@ -0,0 +1,213 @@
+//
+//  NWGestureEventQueue.cpp
+//  NoviceWorks
+//
+//  Gestures as plain records, for consuming them in a batch.
+//
+//
+
+// std
+#include <cstring>
+
+// myclass
+#include "NWGestureEventQueue.hpp"
+
+
+#pragma -mark Class Basic Method.
+NWGestureEventQueue::NWGestureEventQueue( int capacity, NWClock *clock ) :
+  mEvents( capacity > 0 ? capacity : 1 )
+, mSize( 0 )
+, mDroppedCount( 0 )
+, mEventMask( ~0u )
+, mClock( NULL )
+, mInputTime( 0 )
+{
+    this->setClock( clock );
+}
+
+NWGestureEventQueue::~NWGestureEventQueue()
+{
+}
+
+void NWGestureEventQueue::setClock( NWClock *clock )
+{
+    this->mClock = clock ? clock : NWMonotonicClock::sharedClock();
+}
+
+void NWGestureEventQueue::clear()
+{
+    this->mSize = 0;
+    this->mDroppedCount = 0;
+}
+
+
+#pragma -mark Push
+NWGestureEvent* NWGestureEventQueue::push( NWGestureEventType type, int id )
+{
+    if( !( this->mEventMask & maskOf( type ) ) ) return NULL;
+    if( this->mSize >= this->capacity() ) {
+        ++this->mDroppedCount;
+        return NULL;
+    }
+
+    NWGestureEvent *event = &this->mEvents[ this->mSize++ ];
+    memset( event, 0, sizeof( NWGestureEvent ) );
+    event->type = type;
+    event->id   = id;
+    event->time = this->mClock->now();
+    event->inputTime = this->mInputTime;
+    return event;
+}
+
+void NWGestureEventQueue::pushEvent( const NWGestureEvent &event )
+{
+    NWGestureEvent *slot = this->push( event.type, event.id );
+    if( slot ) *slot = event;
+}
+
+void NWGestureEventQueue::pushPoint( NWGestureEventType type, const NWPoint &p, int id )
+{
+    NWGestureEvent *event = this->push( type, id );
+    if( !event ) return;
+    event->x = p.x;
+    event->y = p.y;
+}
+
+void NWGestureEventQueue::pushPinch( NWGestureEventType type, float magnification, int id1, int id2 )
+{
+    NWGestureEvent *event = this->push( type, id1 );
+    if( !event ) return;
+    event->id2   = id2;
+    event->scale = magnification;
+}
+
+void NWGestureEventQueue::pushTransform( NWGestureEventType type, const NWTransform &transform )
+{
+    NWGestureEvent *event = this->push( type, transform.firstId );
+    if( !event ) return;
+    event->id2      = transform.touchCount;
+    event->direction = transform.group;
+    event->x        = transform.centroid.x;
+    event->y        = transform.centroid.y;
+    event->vx       = transform.translation.x;
+    event->vy       = transform.translation.y;
+    event->scale    = transform.scale;
+    event->rotation = transform.rotation;
+}
+
+
+#pragma -mark NWGestureListener
+void NWGestureEventQueue::onSingleTap( const NWPoint &touchPoint ) {
+    this->pushPoint( NW_GESTURE_SINGLE_TAP, touchPoint, 0 );
+}
+void NWGestureEventQueue::onDoubleTap( const NWPoint &touchPoint ) {
+    this->pushPoint( NW_GESTURE_DOUBLE_TAP, touchPoint, 0 );
+}
+bool NWGestureEventQueue::isDoubleTapSupport( const NWPoint &touchPoint ) {
+    return ( this->mEventMask & maskOf( NW_GESTURE_DOUBLE_TAP ) ) != 0;
+}
+void NWGestureEventQueue::onSingleTapTentative( const NWPoint &touchPoint ) {
+    this->pushPoint( NW_GESTURE_SINGLE_TAP_TENTATIVE, touchPoint, 0 );
+}
+void NWGestureEventQueue::onSingleTapRevoked( const NWPoint &touchPoint ) {
+    this->pushPoint( NW_GESTURE_SINGLE_TAP_REVOKED, touchPoint, 0 );
+}
+void NWGestureEventQueue::onDown( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_DOWN, touchPoint, id );
+}
+void NWGestureEventQueue::onHold( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_HOLD, touchPoint, id );
+}
+void NWGestureEventQueue::onTap( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_TAP, touchPoint, id );
+}
+void NWGestureEventQueue::onCancelled( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_CANCELLED, touchPoint, id );
+}
+void NWGestureEventQueue::onScroll( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_SCROLL, touchPoint, id );
+}
+void NWGestureEventQueue::onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy ) {
+    NWGestureEvent *event = this->push( NW_GESTURE_FLICK, id );
+    if( !event ) return;
+    event->x = touchPoint.x;
+    event->y = touchPoint.y;
+    event->direction = direction;
+    event->vx = vx;
+    event->vy = vy;
+}
+void NWGestureEventQueue::onSwipe( const NWPoint &touchPoint, int id, int direction ) {
+    NWGestureEvent *event = this->push( NW_GESTURE_SWIPE, id );
+    if( !event ) return;
+    event->x = touchPoint.x;
+    event->y = touchPoint.y;
+    event->direction = direction;
+}
+void NWGestureEventQueue::onDrag( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_DRAG, touchPoint, id );
+}
+void NWGestureEventQueue::onDragEnded( const NWPoint &touchPoint, int id ) {
+    this->pushPoint( NW_GESTURE_DRAG_ENDED, touchPoint, id );
+}
+void NWGestureEventQueue::onPinchIn( float magnification, int id1, int id2 ) {
+    this->pushPinch( NW_GESTURE_PINCH_IN, magnification, id1, id2 );
+}
+void NWGestureEventQueue::onPinchOut( float magnification, int id1, int id2 ) {
+    this->pushPinch( NW_GESTURE_PINCH_OUT, magnification, id1, id2 );
+}
+void NWGestureEventQueue::onPinchAction( float magnification, int id1, int id2 ) {
+    this->pushPinch( NW_GESTURE_PINCH_ACTION, magnification, id1, id2 );
+}
+void NWGestureEventQueue::onPinchEnded( float magnification, int id1, int id2 ) {
+    this->pushPinch( NW_GESTURE_PINCH_ENDED, magnification, id1, id2 );
+}
+void NWGestureEventQueue::onTransform( const NWTransform &transform ) {
+    this->pushTransform( NW_GESTURE_TRANSFORM, transform );
+}
+void NWGestureEventQueue::onTransformEnded( const NWTransform &transform ) {
+    this->pushTransform( NW_GESTURE_TRANSFORM_ENDED, transform );
+}
+
+
+#pragma -mark Dispatch
+void NWGestureEventQueue::dispatch( const NWGestureEvent &event, NWGestureListener *listener )
+{
+    NWPoint point( event.x, event.y );
+    switch( event.type ) {
+        case NW_GESTURE_SINGLE_TAP:     listener->onSingleTap( point ); break;
+        case NW_GESTURE_DOUBLE_TAP:     listener->onDoubleTap( point ); break;
+        case NW_GESTURE_SINGLE_TAP_TENTATIVE: listener->onSingleTapTentative( point ); break;
+        case NW_GESTURE_SINGLE_TAP_REVOKED:   listener->onSingleTapRevoked( point ); break;
+        case NW_GESTURE_DOWN:           listener->onDown( point, event.id ); break;
+        case NW_GESTURE_HOLD:           listener->onHold( point, event.id ); break;
+        case NW_GESTURE_TAP:            listener->onTap( point, event.id ); break;
+        case NW_GESTURE_CANCELLED:      listener->onCancelled( point, event.id ); break;
+        case NW_GESTURE_SCROLL:         listener->onScroll( point, event.id ); break;
+        case NW_GESTURE_FLICK:
+            listener->onFlick( point, event.id, event.direction, event.vx, event.vy );
+            break;
+        case NW_GESTURE_SWIPE:          listener->onSwipe( point, event.id, event.direction ); break;
+        case NW_GESTURE_DRAG:           listener->onDrag( point, event.id ); break;
+        case NW_GESTURE_DRAG_ENDED:     listener->onDragEnded( point, event.id ); break;
+        case NW_GESTURE_PINCH_IN:       listener->onPinchIn( event.scale, event.id, event.id2 ); break;
+        case NW_GESTURE_PINCH_OUT:      listener->onPinchOut( event.scale, event.id, event.id2 ); break;
+        case NW_GESTURE_PINCH_ACTION:   listener->onPinchAction( event.scale, event.id, event.id2 ); break;
+        case NW_GESTURE_PINCH_ENDED:    listener->onPinchEnded( event.scale, event.id, event.id2 ); break;
+        case NW_GESTURE_TRANSFORM:
+        case NW_GESTURE_TRANSFORM_ENDED: {
+            NWTransform transform;
+            transform.centroid      = point;
+            transform.translation   = NWPoint( event.vx, event.vy );
+            transform.scale         = event.scale;
+            transform.rotation      = event.rotation;
+            transform.touchCount    = event.id2;
+            transform.firstId       = event.id;
+            transform.group         = event.direction;
+            if( event.type == NW_GESTURE_TRANSFORM ) listener->onTransform( transform );
+            else                                     listener->onTransformEnded( transform );
+            break;
+        }
+        default:
+            break;
+    }
+}
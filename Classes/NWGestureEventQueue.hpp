@@ -0,0 +1,187 @@
+//
+//  NWGestureEventQueue.hpp
+//  NoviceWorks
+//
+//  Gestures as plain records, for consuming them in a batch.
+//
+//
+
+#ifndef __NWGestureEventQueue__
+#define __NWGestureEventQueue__
+
+#include <cstddef>
+#include <vector>
+
+#include "NWGestureClock.hpp"
+#include "NWGestureRecognizer.hpp"
+
+/**
+ *  @enum   NWGestureEventType
+ *  @brief  Kind of NWGestureEvent. same as the callbacks of NWGestureListener.
+ */
+enum NWGestureEventType {
+    NW_GESTURE_SINGLE_TAP = 0,
+    NW_GESTURE_DOUBLE_TAP,
+    NW_GESTURE_DOWN,
+    NW_GESTURE_HOLD,
+    NW_GESTURE_TAP,
+    NW_GESTURE_CANCELLED,
+    NW_GESTURE_SCROLL,
+    NW_GESTURE_FLICK,
+    NW_GESTURE_SWIPE,
+    NW_GESTURE_DRAG,
+    NW_GESTURE_DRAG_ENDED,
+    NW_GESTURE_PINCH_IN,
+    NW_GESTURE_PINCH_OUT,
+    NW_GESTURE_PINCH_ACTION,
+    NW_GESTURE_PINCH_ENDED,
+    NW_GESTURE_TRANSFORM,
+    NW_GESTURE_TRANSFORM_ENDED,
+    NW_GESTURE_SINGLE_TAP_TENTATIVE,
+    NW_GESTURE_SINGLE_TAP_REVOKED,
+
+    NW_GESTURE_EVENT_TYPES
+};
+
+/**
+ *  @struct NWGestureEvent
+ *  @brief  One gesture. POD, so it can be copied by memcpy.
+ *
+ *  fields which the type doesn't use are 0.
+ *  - point gestures  : id, x, y. Flick & Swipe: direction, Flick: vx, vy.
+ *  - Pinch*          : id, id2, scale (magnification).
+ *  - Transform*      : x, y (centroid), vx, vy (translation), scale,
+ *                      rotation, id2 (number of the fingers), id (first finger),
+ *                      direction (NWTransform::group).
+ */
+struct NWGestureEvent
+{
+    NWGestureEventType  type;
+    int     id;
+    int     id2;
+    int     direction;
+    NWTime  time;       // when it's queued, on the clock of the queue.
+    NWTime  inputTime;  // of the touch sample which made it. 0 unless the
+                        // latency is left to the queue (NWGestureRecognizer::setLatencyQueue()).
+    float   x, y;
+    float   vx, vy;
+    float   scale;
+    float   rotation;
+};
+
+/**
+ *  @class  NWGestureEventQueue
+ *  @brief  NWGestureListener which writes the gestures into a preallocated array.
+ *
+ *  set it to NWGestureRecognizer::setListener() (or NWGestureLayer::setEventQueue()),
+ *  and drain it once per frame:
+ *
+ *      for( int i = 0; i < queue.size(); ++i ) handle( queue[i] );
+ *      queue.clear();
+ *
+ *  it doesn't allocate after the constructor. when it's full,
+ *  new events are dropped and counted by getDroppedCount().
+ *  @warning not thread safe. drain it on the thread feeding the recognizer.
+ */
+class NWGestureEventQueue : public NWGestureListener
+{
+public:
+    static const int DEFAULT_CAPACITY = 256;
+
+    /**
+     *  @param  capacity    max events between clear().
+     *  @param  clock       time stamp of the events. NULL is the monotonic clock.
+     */
+    explicit NWGestureEventQueue( int capacity = DEFAULT_CAPACITY, NWClock *clock = NULL );
+    virtual ~NWGestureEventQueue();
+
+    void setClock( NWClock *clock );
+    NWClock* getClock() { return this->mClock; }
+
+    /**
+     *  Set which types are queued. bit ( 1 << NWGestureEventType ).
+     *  e.g. drop PinchIn/Out and keep PinchAction only.
+     *  without NW_GESTURE_DOUBLE_TAP, SingleTap is queued without waiting for DoubleTap.
+     */
+    void setEventMask( unsigned int mask ) { this->mEventMask = mask; }
+    unsigned int getEventMask() const { return this->mEventMask; }
+    static unsigned int maskOf( NWGestureEventType type ) { return 1u << type; }
+
+    int size() const        { return this->mSize; }
+    int capacity() const    { return static_cast<int>( this->mEvents.size() ); }
+    bool empty() const      { return this->mSize == 0; }
+    const NWGestureEvent* data() const { return this->mSize > 0 ? &this->mEvents[0] : NULL; }
+    const NWGestureEvent& operator[]( int i ) const { return this->mEvents[i]; }
+
+    /**
+     *  Forget the queued events and the dropped count.
+     */
+    void clear();
+
+    /**
+     *  Get how many events were dropped since clear() because it was full.
+     */
+    int getDroppedCount() const { return this->mDroppedCount; }
+
+    /**
+     *  Set the time of the touch sample the next events come from (NWGestureEvent::inputTime).
+     *  the stats of NWGestureRecognizer set it, see NWGestureRecognizer::setLatencyQueue().
+     */
+    void setInputTime( NWTime time ) { this->mInputTime = time; }
+
+    /**
+     *  Queue the event made somewhere else as it is (e.g. on the other thread).
+     *  it's masked or dropped like the callbacks.
+     */
+    void pushEvent( const NWGestureEvent &event );
+
+    /**
+     *  Call the callback of listener which made the event.
+     *  e.g. to deliver the events recorded on the other thread.
+     */
+    static void dispatch( const NWGestureEvent &event, NWGestureListener *listener );
+
+
+    // NWGestureListener
+    virtual void onSingleTap( const NWPoint &touchPoint );
+    virtual void onDoubleTap( const NWPoint &touchPoint );
+    virtual bool isDoubleTapSupport( const NWPoint &touchPoint );
+    virtual void onSingleTapTentative( const NWPoint &touchPoint );
+    virtual void onSingleTapRevoked( const NWPoint &touchPoint );
+    virtual void onDown( const NWPoint &touchPoint, int id );
+    virtual void onHold( const NWPoint &touchPoint, int id );
+    virtual void onTap( const NWPoint &touchPoint, int id );
+    virtual void onCancelled( const NWPoint &touchPoint, int id );
+    virtual void onScroll( const NWPoint &touchPoint, int id );
+    using NWGestureListener::onFlick;
+    virtual void onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy );
+    virtual void onSwipe( const NWPoint &touchPoint, int id, int direction );
+    virtual void onDrag( const NWPoint &touchPoint, int id );
+    virtual void onDragEnded( const NWPoint &touchPoint, int id );
+    virtual void onPinchIn( float magnification, int id1, int id2 );
+    virtual void onPinchOut( float magnification, int id1, int id2 );
+    virtual void onPinchAction( float magnification, int id1, int id2 );
+    virtual void onPinchEnded( float magnification, int id1, int id2 );
+    virtual void onTransform( const NWTransform &transform );
+    virtual void onTransformEnded( const NWTransform &transform );
+
+private:
+    std::vector<NWGestureEvent> mEvents;    // allocated at constructor.
+    int             mSize;
+    int             mDroppedCount;
+    unsigned int    mEventMask;
+    NWClock        *mClock;
+    NWTime          mInputTime;
+
+    // return NULL if it's masked or full.
+    NWGestureEvent* push( NWGestureEventType type, int id );
+    void pushPoint( NWGestureEventType type, const NWPoint &p, int id );
+    void pushPinch( NWGestureEventType type, float magnification, int id1, int id2 );
+    void pushTransform( NWGestureEventType type, const NWTransform &transform );
+
+    NWGestureEventQueue( const NWGestureEventQueue& );
+    NWGestureEventQueue& operator=( const NWGestureEventQueue& );
+};
+
+
+#endif /* defined(__NWGestureEventQueue__) */
@@ -10,14 +10,15 @@
 #include <string>
 #include <vector>
 #include <cmath>
-#include <ctime>
-#include <sys/time.h>
 
 // cocos2dx
 #include "cocos2d.h"
 
 // myclass
 #include "NWGestureLayer.hpp"
+#include "NWGestureThread.hpp"
+#include "NWGestureArbiter.hpp"
+#include "NWGestureStats.hpp"
 
 
 using namespace cocos2d;
@@ -25,220 +26,245 @@ using std::string;
 using std::vector;
 
 
-namespace {
+#pragma -mark Class Basic Method.
+NWGestureLayer::NWGestureLayer() :
+  mRecognizer()
+, mListenerBridge( this )
+, mEventQueue( NULL )
+, mGestureThread( NULL )
+, mArbiter( NULL )
+, mRouter()
 
-#pragma -mark Support Functions
+// Config: Hold & Drag
+, mDetectionAccuracyOfHold( 0.1f )
 
-double getTimeOfDay() {
-    struct timeval tv;
-    gettimeofday( &tv, NULL );
-    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) * 0.000001;
-}
+// Config: SingleTap & DoubleTap
+, mIsDoubleTapSupported( true )
 
+// Config: Layout
+, mDistanceThresholdForMovedInMM( 0.0f )
+, mDistanceThresholdForGroupInMM( 0.0f )
+, mLayout()
+, mIsLayoutPending( false )
 
-#pragma -mark TouchInfo Class
-class TouchInfo : public CCObject {
-public:
-    int     id;
-    double  startTime;      // sec
-    bool    hasMoved;
-    bool    hasHold;
-    bool    hasEnded;
-    vector<CCPoint> touchHistory;
+// Private Attribute
+, mScheduledDeadline( -1 )
 
-    static TouchInfo* create( CCTouch *touch ) {
-        TouchInfo *ti = new TouchInfo();
-        if( !ti ) {
-            CC_SAFE_DELETE( ti );
-            return NULL;
-        }
-        ti->autorelease();
-        
-        // set info
-        if( touch ) {
-            ti->id = touch->getID();
-            ti->insertHistory( touch );
-        } else {
-            ti->id = -1;
-        }
-        ti->startTime = getTimeOfDay();
-        ti->hasMoved = false;
-        ti->hasHold  = false;
-        ti->hasEnded = false;
+// Coalesced Dispatch
+, mIsCoalescedDispatch( false )
+, mIsFlushScheduled( false )
+, mPendingMoveCount( 0 )
+, mLastTransformGroup( 0 )
 
-        return ti;
-    }
-    
-    void insertHistory( CCTouch *touch ) {
-        CCPoint p = touch->getLocation();
-        touchHistory.push_back( p );
+// Gesture Target
+, mIsGestureTargetAutoSync( false )
+{
+    CCLOG( "NWGestureLayer: constructor" );
+    this->mRecognizer.setListener( &this->mListenerBridge );
+    this->mTouchSamples.reserve( NWGestureRecognizer::MAX_TOUCHES );
+    for( int i = 0; i < NWGestureRecognizer::MAX_TOUCHES; ++i ) {
+        this->mTouchHistoryBuffers[i].reserve( NW_GESTURE_HISTORY_RESERVE );
     }
-    
-    float getTotalDistance() {
-        float total_distance = 0.0f;
-        int size = this->touchHistory.size();
-        for(int i = 1; i < size; ++i ) {
-            CCPoint pre = this->touchHistory[i-1];
-            CCPoint cur = this->touchHistory[i];
-            total_distance += pre.getDistance( cur );
-        }
-        return total_distance;
+    for( int i = 0; i < NWGestureRecognizer::MAX_TRANSFORMS; ++i ) {
+        PendingTransform &pending = this->mPendingTransforms[i];
+        pending.hasTransform = false;
+        pending.hasPinch = false;
+        pending.magnification = 1.0f;
+        pending.deliveredMagnification = 1.0f;
     }
-    
-    int getDirection( float correction_val ) {
-        CCPoint start = this->touchHistory[0];
-        CCPoint end   = this->touchHistory.back();
-        
-        float dx = end.x - start.x;
-        float dy = end.y - start.y;
-        
-        // Error correction
-        if( dx != 0.0f ) {
-            if( dx > 0.0f ) dx = dx < correction_val ? 0.0f : dx;
-            else dx = dx > -correction_val ? 0.0f : dx;
-        }
-        
-        // setup distance flag.
-        int dist = 0;
-        if( dx != 0.0f ) dist |= dx < 0.0f ? NWGestureLayer::LEFT : NWGestureLayer::RIGHT;
-        if( dy != 0.0f ) dist |= dy < 0.0f ? NWGestureLayer::DOWN : NWGestureLayer::UP;
 
-        return dist;
-    }
-};
+    // thresholds and the grid of the gesture targets for this window.
+    this->updateLayoutMetrics();
+}
 
-void safeInsertObjectToCCArray( CCArray *ary, CCObject *obj, int index )
+NWGestureLayer::~NWGestureLayer()
 {
-    int cnt = ary->count();
-    if( index < cnt ) {
-        ary->replaceObjectAtIndex( index, obj );
-        return;
-    }
+    CCLOG( "NWGestureLayer: destructor" );
+#if NW_GESTURE_THREADED
+    delete this->mGestureThread;
+#endif
+    this->removeAllGestureTargets();
+    if( this->mArbiter ) this->mArbiter->setListener( NULL );
+    this->mRecognizer.setListener( NULL );
+}
+
+bool NWGestureLayer::init()
+{
+    CCLOG( "NWGestureLayer: init" );
+    if( !CCLayer::init() ) return false;
     
-    // insert dummy objects.
-    for(int i = cnt; i < index; ++i ) {
-        ary->addObject( TouchInfo::create( NULL ) );
-    }
-    ary->addObject( obj );
+    this->setTouchEnabled( true );
+    this->setTouchMode( kCCTouchesAllAtOnce );
+    
+    return true;
 }
 
+void NWGestureLayer::onExit()
+{
+    // deliver the rest before the scheduler of this layer stops.
+    this->flushCoalescedEvents();
+    CCLayer::onExit();
+}
 
-} // unnamed namespace
+void NWGestureLayer::setDoubleTapSupport( bool is_supported )
+{
+    this->mIsDoubleTapSupported = is_supported;
+    this->updateThreadDoubleTapSupport();
+}
 
 
-#pragma -mark Class Basic Method.
-NWGestureLayer::NWGestureLayer() :
-// Private Attribute
-  mFirstTapId( -1 )
-, mFirstTapTime( 0 )
-, mFirstTapPoint( CCPointZero )
-, mBaseDistanceOfPinch( 0.0f )
-, mPreviousDistanceOfPinch( 0.0f )
-
-// Common
-, mDistanceThresholdForMoved( 0.0f )    // default value set in constructor.
-
-// Config: Option
-, mIsMultitapSupported( true )
-, mIsPinchActionSupported( true )
- 
-// Config: SingleTap & DoubleTap
-, mTimeThresholdForDoubleTap( 0.25 )
+#pragma -mark Layout
+void NWGestureLayer::setDistanceThresholdForMovedInMM( float mm )
+{
+    this->mDistanceThresholdForMovedInMM = mm > 0.0f ? mm : 0.0f;
+    this->updateLayoutMetrics();
+}
 
-// Config: Hold & Drag
-, mDetectionAccuracyOfHold( 0.1f )
-, mTimeThresholdForHold( 1.0 )
+void NWGestureLayer::setDistanceThresholdForGroupInMM( float mm )
+{
+    this->mDistanceThresholdForGroupInMM = mm > 0.0f ? mm : 0.0f;
+    if( mm <= 0.0f ) this->mRecognizer.setDistanceThresholdForGroup( 0.0f );
+    this->updateLayoutMetrics();
+}
 
-// Config: Flick
-, mTimeThresholdForFlick( 0.25 )
+void NWGestureLayer::updateLayoutMetrics()
 {
-    CCLOG( "NWGestureLayer: constructor" );
+    this->mLayout.update();
 
-    // get window value
-    CCSize win_size = CCDirector::sharedDirector()->getWinSize();
-    float win_diagonal = sqrtf(
-            win_size.width * win_size.width +
-            win_size.height * win_size.height );
+    // grid of the gesture targets. the router is on the main thread.
+    const CCSize &win_size = this->mLayout.getSize();
+    this->mRouter.setBounds( NWRect( 0.0f, 0.0f, win_size.width, win_size.height ),
+                             this->mLayout.getDiagonal() / 20.0f );
 
-    // base value for determine move or not.
-    this->mDistanceThresholdForMoved = win_diagonal / 10.0f;
-    
-    // pinch
-    mTouchIdForPinch[0] = -1;
-    mTouchIdForPinch[1] = -1;
+    // the thread reads the thresholds. applied when it stops.
+    if( this->isThreadedMode() ) {
+        this->mIsLayoutPending = true;
+    } else {
+        this->applyLayoutThresholds();
+    }
 }
 
-NWGestureLayer::~NWGestureLayer()
+void NWGestureLayer::applyLayoutThresholds()
 {
-    CCLOG( "NWGestureLayer: destructor" );
-    mTouchInfos.removeAllObjects();
+    this->mIsLayoutPending = false;
 
-    //CC_SAFE_RELEASE_NULL( &mTouchInfos );
+    // base value for determine move or not.
+    float points_per_mm = this->mLayout.getPointsPerMM();
+    if( this->mDistanceThresholdForMovedInMM > 0.0f ) {
+        this->mRecognizer.setDistanceThresholdForMoved( this->mDistanceThresholdForMovedInMM * points_per_mm );
+    } else if( this->mDistanceThresholdForMovedInMM == 0.0f ) {
+        this->mRecognizer.setDistanceThresholdForMoved( this->mLayout.getDiagonal() / 10.0f );
+    }
+    if( this->mDistanceThresholdForGroupInMM > 0.0f ) {
+        this->mRecognizer.setDistanceThresholdForGroup( this->mDistanceThresholdForGroupInMM * points_per_mm );
+    }
 }
 
-bool NWGestureLayer::init()
-{
-    CCLOG( "NWGestureLayer: init" );
-    if( !CCLayer::init() ) return false;
-    
-    this->setTouchEnabled( true );
-    this->setTouchMode( kCCTouchesAllAtOnce );
-    
-    // schedule hold handler.
-    this->schedule(
-        schedule_selector( NWGestureLayer::scheduleHoldHandler ),
-        this->mDetectionAccuracyOfHold );
-    
-    return true;
-}
 
 #pragma -mark Getter
 vector<CCPoint>* NWGestureLayer::getTouchHistory( int id )
 {
-    int size = this->mTouchInfos.count();
-    if( size <= id ) {
-        return NULL;
+    const NWTouchHistory *history = this->mRecognizer.getTouchHistory( id );
+    if( !history ) return NULL;
+
+    // each touch has its own buffer, so the histories of 2 fingers can be held at once.
+    vector<CCPoint> &buffer = this->mTouchHistoryBuffers[ this->mRecognizer.getTouchSlot( id ) ];
+    int size = history->size();
+    buffer.resize( size );
+    for( int i = 0; i < size; ++i ) {
+        NWPoint p = (*history)[i];
+        buffer[i].setPoint( p.x, p.y );
     }
-    
-    TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex( id ) );
-    return &info->touchHistory;
+    return &buffer;
+}
+const NWTouchHistory* NWGestureLayer::getTouchHistoryView( int id )
+{
+    return this->mRecognizer.getTouchHistory( id );
 }
 float NWGestureLayer::getTotalDistance( int id )
 {
-    int size = this->mTouchInfos.count();
-    if( size <= id ) return 0.0f;
-    
-    TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex( id ) );
-    return info->getTotalDistance();
+    return this->mRecognizer.getTotalDistance( id );
+}
+int NWGestureLayer::getDirection( int id )
+{
+    return this->mRecognizer.getDirection( id );
+}
+CCRect NWGestureLayer::getBoundingBox( int id )
+{
+    NWRect r = this->mRecognizer.getBoundingBox( id );
+    return CCRect( r.x, r.y, r.width, r.height );
+}
+CCPoint NWGestureLayer::getNetDisplacement( int id )
+{
+    NWPoint d = this->mRecognizer.getNetDisplacement( id );
+    return CCPoint( d.x, d.y );
+}
+CCPoint NWGestureLayer::getVelocity( int id )
+{
+    NWPoint v = this->mRecognizer.getVelocity( id );
+    return CCPoint( v.x, v.y );
+}
+CCPoint NWGestureLayer::getSmoothedPoint( int id )
+{
+    NWPoint p = this->mRecognizer.getSmoothedPoint( id );
+    return CCPoint( p.x, p.y );
+}
+CCPoint NWGestureLayer::getPredictedPoint( int id )
+{
+    NWPoint p = this->mRecognizer.getPredictedPoint( id );
+    return CCPoint( p.x, p.y );
 }
 
 
 #pragma -mark Cocos2dx Touch Event
-void NWGestureLayer::ccTouchesBegan( CCSet *pTouches, CCEvent *pEvent )
+// convert touches to mTouchSamples. return the touch of id 0 (for single tap).
+CCTouch* NWGestureLayer::makeTouchSamples( CCSet *pTouches )
 {
     CCTouch *touch_id0 = NULL;
+    NWTime now = this->mRecognizer.getClock()->now();
 
+    this->mTouchSamples.clear();
     for( CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it ) {
         CCTouch *touch = static_cast<CCTouch*>(*it);
-        int id = touch->getID();
-        
-        // for single tap.
-        if( id == 0 ) touch_id0 = touch;
-        if( !this->mIsMultitapSupported && id ) continue;
-
-        TouchInfo *ti = TouchInfo::create( touch );
-        safeInsertObjectToCCArray( &this->mTouchInfos, ti, ti->id );
-        
-        // callback
-        CCPoint touch_point = touch->getLocation();
-        this->onDown( touch_point, ti->id );
-        
-        // pinch
-        if( this->mIsPinchActionSupported ) this->pinchActionHandler( touch );
+        if( touch->getID() == 0 ) touch_id0 = touch;
+
+        CCPoint p = touch->getLocation();
+        NWTouchSample sample = { touch->getID(), p.x, p.y, this->getTouchTime( touch, now ) };
+        this->mTouchSamples.push_back( sample );
     }
+    return touch_id0;
+}
+
+// pass mTouchSamples to the recognizer, or to its thread.
+void NWGestureLayer::feedTouchSamples( NWTouchPhase phase )
+{
+#if NW_GESTURE_THREADED
+    if( this->mGestureThread ) {
+        if( !this->mTouchSamples.empty() ) {
+            this->mGestureThread->touches( phase, &this->mTouchSamples[0], this->mTouchSamples.size() );
+        }
+        return;
+    }
+#endif
+    if( !this->mTouchSamples.empty() ) {
+        this->mRecognizer.touches( phase, &this->mTouchSamples[0], this->mTouchSamples.size() );
+        if( this->mArbiter ) {
+            this->mArbiter->touches( phase, &this->mTouchSamples[0], this->mTouchSamples.size() );
+        }
+    }
+    this->rescheduleDeadline();
+}
+
+void NWGestureLayer::ccTouchesBegan( CCSet *pTouches, CCEvent *pEvent )
+{
+    NWStatsScope scope( this->getGestureStats(), NWGestureStats::STAGE_LAYER_TOUCHES );
+    if( this->mLayout.isChanged() ) this->updateLayoutMetrics();
+    this->syncGestureTargets();
+    CCTouch *touch_id0 = this->makeTouchSamples( pTouches );
+    this->feedTouchSamples( NW_TOUCH_BEGAN );
     
     // callback
-    if( !this->mIsMultitapSupported && touch_id0 ) {
+    if( !this->isMultitapSupport() && touch_id0 ) {
         this->onTouchBegan( touch_id0, pEvent );
     } else {
         this->onTouchesBegan( pTouches, pEvent );
@@ -247,43 +273,12 @@ void NWGestureLayer::ccTouchesBegan( CCSet *pTouches, CCEvent *pEvent )
 
 void NWGestureLayer::ccTouchesMoved( CCSet *pTouches, CCEvent *pEvent )
 {
-    CCTouch *touch_id0 = NULL;
-    
-    for( CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it ) {
-        CCTouch *touch = static_cast<CCTouch*>(*it);
-        int id = touch->getID();
-        
-        // for single tap.
-        if( id == 0 ) touch_id0 = touch;
-        if( !this->mIsMultitapSupported && id ) continue;
-        
-        TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex(id) );
-        
-        // check move
-        if( !info->hasMoved ) {
-            float distance = info->touchHistory[0].getDistance( touch->getLocation() );
-            if( distance > this->mDistanceThresholdForMoved ) {
-                info->hasMoved = true;
-            }
-        }
-        
-        // insert history.
-        info->insertHistory( touch );
-        
-        // pinch action.
-        if( this->mIsPinchActionSupported && this->pinchActionHandler( touch ) ) {
-            // pass.
-        
-        // moved! callback
-        } else if( info->hasMoved ) {
-            CCPoint touch_point = touch->getLocation();
-            if( info->hasHold ) this->onDrag( touch_point, id );
-            else                this->onScroll( touch_point, id );
-        }
-    }
+    NWStatsScope scope( this->getGestureStats(), NWGestureStats::STAGE_LAYER_TOUCHES );
+    CCTouch *touch_id0 = this->makeTouchSamples( pTouches );
+    this->feedTouchSamples( NW_TOUCH_MOVED );
     
     // callback
-    if( !this->mIsMultitapSupported && touch_id0 ) {
+    if( !this->isMultitapSupport() && touch_id0 ) {
         this->onTouchMoved( touch_id0, pEvent );
     } else {
         this->onTouchesMoved( pTouches, pEvent );
@@ -292,55 +287,12 @@ void NWGestureLayer::ccTouchesMoved( CCSet *pTouches, CCEvent *pEvent )
 
 void NWGestureLayer::ccTouchesEnded( CCSet *pTouches, CCEvent *pEvent )
 {
-    CCTouch *touch_id0 = NULL;
-    
-    for(CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it ) {
-        CCTouch *touch = static_cast<CCTouch*>(*it);
-        int id = touch->getID();
-        
-        // for single tap.
-        if( id == 0 ) touch_id0 = touch;
-        if( !this->mIsMultitapSupported && id ) continue;
-        
-        TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex(id) );
-        info->insertHistory( touch );
-        info->hasEnded = true;
-        
-        // callback
-        CCPoint touch_point = touch->getLocation();
-        // end of drag.
-        if( info->hasHold ) {
-            this->onDragEnded( touch_point, id );
-         
-        // Pinch Action.
-        } else if( this->mIsPinchActionSupported &&
-                   this->pinchActionHandler( touch, true ) ) {
-            // pass.
-            
-        // end of scroll
-        } else if( info->hasMoved ) {
-            // check time
-            double scroll_time = getTimeOfDay() - info->startTime;
-            int dir_flags = info->getDirection( this->getDistanceThresholdForMoved() );
-            
-            // is Flick!
-            if( scroll_time < this->mTimeThresholdForFlick ) {
-                this->onFlick( touch_point, id, dir_flags );
-                
-            // is Swipe
-            } else {
-                this->onSwipe( touch_point, id, dir_flags );
-            }
-            
-        // end of Tap.
-        } else if( !info->hasMoved ) {
-            this->onTap( touch_point, id );
-            this->tapEventManager( touch );
-        }
-    }
+    NWStatsScope scope( this->getGestureStats(), NWGestureStats::STAGE_LAYER_TOUCHES );
+    CCTouch *touch_id0 = this->makeTouchSamples( pTouches );
+    this->feedTouchSamples( NW_TOUCH_ENDED );
     
     // callback
-    if( !this->mIsMultitapSupported && touch_id0 ) {
+    if( !this->isMultitapSupport() && touch_id0 ) {
         this->onTouchEnded( touch_id0, pEvent );
     } else {
         this->onTouchesEnded( pTouches, pEvent );
@@ -349,29 +301,12 @@ void NWGestureLayer::ccTouchesEnded( CCSet *pTouches, CCEvent *pEvent )
 
 void NWGestureLayer::ccTouchesCancelled( CCSet *pTouches, CCEvent *pEvent )
 {
-    CCTouch *touch_id0 = NULL;
-    
-    for(CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it ) {
-        CCTouch *touch = static_cast<CCTouch*>(*it);
-        int id = touch->getID();
-        
-        // for single tap.
-        if( id == 0 ) touch_id0 = touch;
-        if( !this->mIsMultitapSupported && id ) continue;
-        
-        TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex(id) );
-        info->insertHistory( touch );
-        info->hasEnded = true;
-        
-        CCPoint touch_point = touch->getLocation();
-        this->onCancelled( touch_point, id );
-
-        // pinch
-        if( this->mIsPinchActionSupported ) this->pinchActionHandler( touch, true );
-    }
+    NWStatsScope scope( this->getGestureStats(), NWGestureStats::STAGE_LAYER_TOUCHES );
+    CCTouch *touch_id0 = this->makeTouchSamples( pTouches );
+    this->feedTouchSamples( NW_TOUCH_CANCELLED );
     
     // callback
-    if( !this->mIsMultitapSupported && touch_id0 ) {
+    if( !this->isMultitapSupport() && touch_id0 ) {
         this->onTouchCancelled( touch_id0, pEvent );
     } else {
         this->onTouchesCancelled( pTouches, pEvent );
@@ -379,177 +314,476 @@ void NWGestureLayer::ccTouchesCancelled( CCSet *pTouches, CCEvent *pEvent )
 }
 
 
-#pragma -mark SingeTap or DoubleTap
+#pragma -mark SingleTap & Hold Timer
 // this func will used in schedule.
-void NWGestureLayer::scheduleSingleTapHandler()
+void NWGestureLayer::scheduleDeadlineHandler()
+{
+    this->mScheduledDeadline = -1;      // scheduleOnce is done.
+    this->mRecognizer.update();
+    if( this->mArbiter ) this->mArbiter->update( this->getClock()->now() );
+    this->rescheduleDeadline();
+}
+
+// arm one timer for the earliest deadline. nothing is scheduled while idle.
+void NWGestureLayer::rescheduleDeadline()
 {
-    if( this->mFirstTapId < 0 ) return;
-    TouchInfo *info = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex( this->mFirstTapId ) );
-    if( info ) {
-        onSingleTap( info->touchHistory.back() );
+    NWTime deadline = this->mRecognizer.getNextDeadline();
+    if( this->mArbiter ) {
+        NWTime d = this->mArbiter->getNextDeadline();
+        if( d >= 0 && ( deadline < 0 || d < deadline ) ) deadline = d;
     }
-    
-    this->mFirstTapId = -1;
-    this->mFirstTapTime = 0;
-    this->mFirstTapPoint = CCPointZero;
-}
-
-void NWGestureLayer::tapEventManager( CCTouch *touch )
-{
-    // stop singletap handler.
-    this->unschedule( schedule_selector( NWGestureLayer::scheduleSingleTapHandler ) );
-
-    // Check Double Tap
-    do {
-        // check ID.
-        if( touch->getID() != this->mFirstTapId ) break;
-        
-        // check tap interval
-        double interval = getTimeOfDay() - this->mFirstTapTime;
-        if( interval > this->mTimeThresholdForDoubleTap ) break;
-        
-        // check tap distance.
-        float distance = this->mFirstTapPoint.getDistance( touch->getLocation() );
-        if( distance > this->mDistanceThresholdForMoved ) break;
-        
-        // DoubleTap!
-        CCPoint tap_point = touch->getLocation();
-        onDoubleTap( tap_point );
-        
-        // finish.
-        this->mFirstTapId = -1;
-        this->mFirstTapTime = 0;
-        this->mFirstTapPoint = CCPointZero;
-        return;
-        
-    } while(0);
-    
-    // Reset! new tap.
-    this->mFirstTapId = touch->getID();
-    this->mFirstTapTime = getTimeOfDay();
-    this->mFirstTapPoint = touch->getLocation();
-    
-    // start a schedule for the SingleTap callback.
+    if( deadline == this->mScheduledDeadline ) return;
+
+    if( this->mScheduledDeadline >= 0 ) {
+        this->unschedule( schedule_selector( NWGestureLayer::scheduleDeadlineHandler ) );
+    }
+    this->mScheduledDeadline = deadline;
+    if( deadline < 0 ) return;
+
+    NWTime delay = deadline - this->mRecognizer.getClock()->now();
     this->scheduleOnce(
-        schedule_selector( NWGestureLayer::scheduleSingleTapHandler ),
-        this->mTimeThresholdForDoubleTap );
+        schedule_selector( NWGestureLayer::scheduleDeadlineHandler ),
+        delay > 0 ? static_cast<float>( NWTimeToSec( delay ) ) : 0.0f );
 }
 
-#pragma -mark Hold Action
-void NWGestureLayer::scheduleHoldHandler()
+
+#pragma -mark Event Queue
+void NWGestureLayer::setEventQueue( NWGestureEventQueue *queue )
 {
-    double now = getTimeOfDay();
+    this->flushCoalescedEvents();
+    this->mEventQueue = queue;
+    if( queue ) queue->setClock( this->getClock() );
 
-    CCObject *element;
-    CCARRAY_FOREACH( &this->mTouchInfos, element ) {
-        TouchInfo *ti = static_cast<TouchInfo*>( element );
-        if( ti->id == -1 || ti->hasMoved || ti->hasEnded || ti->hasHold ) {
-            continue;
-        }
-        // is pinch ---> continue;
-        if( (this->mTouchIdForPinch[0] != -1 && this->mTouchIdForPinch[1] != -1) &&
-            (ti->id == this->mTouchIdForPinch[0] || ti->id == this->mTouchIdForPinch[1]) ) {
-                continue;
-        }
+    this->updateGestureListener();
+    this->updateThreadDoubleTapSupport();
+}
 
-        double elapsed_time = now - ti->startTime;
-        if( elapsed_time > this->mTimeThresholdForHold ) {
-            ti->hasHold = true;
-            CCPoint hold_point = ti->touchHistory.back();
-            this->onHold( hold_point, ti->id );
+// where the gestures go: targets, then the event queue or the callbacks.
+NWGestureListener* NWGestureLayer::getGestureListener()
+{
+    NWGestureListener *listener = &this->mListenerBridge;
+    if( this->mEventQueue ) listener = this->mEventQueue;
+    if( this->mRouter.getTargetCount() > 0 ) {
+        this->mRouter.setFallbackListener( listener );
+        listener = &this->mRouter;
+    }
+    return listener;
+}
+
+void NWGestureLayer::updateGestureListener()
+{
+    // the thread owns the listener of the recognizer. see threadEventHandler().
+    if( this->mGestureThread ) return;
+    if( this->mArbiter ) {
+        this->mArbiter->setListener( this->getGestureListener() );
+        this->mRecognizer.setListener( NULL );
+    } else {
+        this->mRecognizer.setListener( this->getGestureListener() );
+    }
+}
+
+
+#pragma -mark Arbiter
+void NWGestureLayer::setClock( NWClock *clock )
+{
+    this->mRecognizer.setClock( clock );
+    if( this->mArbiter ) this->mArbiter->setClock( clock );
+}
+
+void NWGestureLayer::setArbiter( NWGestureArbiter *arbiter )
+{
+    if( arbiter == this->mArbiter ) return;
+    this->flushCoalescedEvents();
+    if( this->mArbiter ) this->mArbiter->setListener( NULL );
+
+    this->mArbiter = arbiter;
+    if( arbiter ) arbiter->setClock( this->getClock() );
+    this->updateGestureListener();
+    this->rescheduleDeadline();
+}
+
+
+#pragma -mark Threaded Mode
+#if NW_GESTURE_THREADED
+void NWGestureLayer::setThreadedMode( bool is_threaded )
+{
+    if( is_threaded == this->isThreadedMode() ) return;
+
+    if( is_threaded ) {
+        // the thread has the timer of the recognizer instead.
+        if( this->mScheduledDeadline >= 0 ) {
+            this->unschedule( schedule_selector( NWGestureLayer::scheduleDeadlineHandler ) );
+            this->mScheduledDeadline = -1;
         }
+        this->mGestureThread = new NWGestureThread( &this->mRecognizer );
+        this->updateThreadDoubleTapSupport();
+        this->mGestureThread->start();
+        this->schedule( schedule_selector( NWGestureLayer::threadEventHandler ) );
+    } else {
+        this->unschedule( schedule_selector( NWGestureLayer::threadEventHandler ) );
+        this->mGestureThread->stop();
+        this->threadEventHandler();     // the rest.
+        delete this->mGestureThread;
+        this->mGestureThread = NULL;
+        if( this->mIsLayoutPending ) this->applyLayoutThresholds();
+
+        this->updateGestureListener();
+        this->rescheduleDeadline();
     }
 }
+#endif
 
-#pragma -mark Pinch Action
-float NWGestureLayer::getDistanceBetweenTwoTouch( int id1, int id2 )
+// isDoubleTapSupport() is asked on the thread, where the targets and
+// the queue can't be read. it gets the answer of the layer instead.
+void NWGestureLayer::updateThreadDoubleTapSupport()
 {
-    TouchInfo *t1, *t2;
-    t1 = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex( id1 ) );
-    t2 = static_cast<TouchInfo*>( this->mTouchInfos.objectAtIndex( id2 ) );
-    
-    CCPoint t1p = t1->touchHistory.back();
-    CCPoint t2p = t2->touchHistory.back();
-    
-    return t1p.getDistance( t2p );
-}
-
-// return is pinch action.
-bool NWGestureLayer::pinchActionHandler( CCTouch *touch, bool is_end )
-{
-    do {
-        int id = touch->getID();
-        
-        // finish.
-        if( is_end ) {
-            int id1 = this->mTouchIdForPinch[0];
-            int id2 = this->mTouchIdForPinch[1];
-            int end_id = id == id1 ? id1 : id == id2 ? id2 : -1;
-            if( end_id != -1 ) {
-                // callback
-                if( id1 != -1 && id2 != -1 ) {
-                    float distance = fabsf( this->getDistanceBetweenTwoTouch( id1, id2 ) );
-                    float magnification = 1.0f;
-                    if( this->mBaseDistanceOfPinch != 0.0f ) {
-                        magnification = distance / this->mBaseDistanceOfPinch;
-                    }
-                    this->onPinchEnded( magnification, id1, id2 );
-                }
-
-                this->mTouchIdForPinch[ end_id ] = -1;
-                this->mBaseDistanceOfPinch = 0.0f;
-                this->mPreviousDistanceOfPinch = 0.0f;
-            }
-            break;
+#if NW_GESTURE_THREADED
+    if( !this->mGestureThread ) return;
+    bool is_supported = this->mIsDoubleTapSupported;
+    if( this->mEventQueue ) {
+        is_supported = ( this->mEventQueue->getEventMask() & NWGestureEventQueue::maskOf( NW_GESTURE_DOUBLE_TAP ) ) != 0;
+    }
+    this->mGestureThread->setDoubleTapSupport( is_supported );
+#endif
+}
+
+// this func will used in schedule. every frame while threaded.
+void NWGestureLayer::threadEventHandler()
+{
+#if NW_GESTURE_THREADED
+    if( !this->mGestureThread ) return;
+    NWGestureListener *listener = this->getGestureListener();
+    if( listener == this->mEventQueue ) {
+        // as it is, to keep the time of the events.
+        NWGestureEvent event;
+        while( this->mGestureThread->popEvent( &event ) ) this->mEventQueue->pushEvent( event );
+    } else {
+        this->mGestureThread->dispatchEvents( listener );
+    }
+#endif
+}
+
+
+#pragma -mark Gesture Target
+namespace {
+
+NWRect toNWRect( const CCRect &rect )
+{
+    return NWRect( rect.origin.x, rect.origin.y, rect.size.width, rect.size.height );
+}
+
+// bounding box of the node in the world.
+NWRect getWorldRect( CCNode *node )
+{
+    const CCSize &size = node->getContentSize();
+    return toNWRect( CCRectApplyAffineTransform(
+            CCRect( 0.0f, 0.0f, size.width, size.height ), node->nodeToWorldTransform() ) );
+}
+
+}   // unnamed namespace
+
+int NWGestureLayer::addGestureTarget( const CCRect &rect, NWGestureListener *listener,
+                                      unsigned int mask, int priority )
+{
+    int handle = this->mRouter.addTarget( toNWRect( rect ), listener, mask, priority );
+    if( handle >= static_cast<int>( this->mGestureTargetNodes.size() ) ) {
+        this->mGestureTargetNodes.resize( handle + 1, NULL );
+    }
+    this->updateGestureListener();
+    return handle;
+}
+
+int NWGestureLayer::addGestureTarget( CCNode *node, NWGestureListener *listener,
+                                      unsigned int mask, int priority )
+{
+    int handle = this->mRouter.addTarget( getWorldRect( node ), listener, mask, priority );
+    if( handle >= static_cast<int>( this->mGestureTargetNodes.size() ) ) {
+        this->mGestureTargetNodes.resize( handle + 1, NULL );
+    }
+    node->retain();
+    this->mGestureTargetNodes[ handle ] = node;
+    this->updateGestureListener();
+    return handle;
+}
+
+void NWGestureLayer::removeGestureTarget( int handle )
+{
+    if( handle < 0 || handle >= static_cast<int>( this->mGestureTargetNodes.size() ) ) return;
+    this->mRouter.removeTarget( handle );
+    if( this->mGestureTargetNodes[ handle ] ) {
+        this->mGestureTargetNodes[ handle ]->release();
+        this->mGestureTargetNodes[ handle ] = NULL;
+    }
+    this->updateGestureListener();
+}
+
+void NWGestureLayer::removeAllGestureTargets()
+{
+    this->mRouter.removeAllTargets();
+    for( int i = 0; i < static_cast<int>( this->mGestureTargetNodes.size() ); ++i ) {
+        if( this->mGestureTargetNodes[i] ) this->mGestureTargetNodes[i]->release();
+    }
+    this->mGestureTargetNodes.clear();
+    this->mDirtyGestureTargets.clear();
+    this->updateGestureListener();
+}
+
+void NWGestureLayer::setGestureTargetRect( int handle, const CCRect &rect )
+{
+    this->mRouter.setTargetRect( handle, toNWRect( rect ) );
+}
+
+void NWGestureLayer::updateGestureTarget( int handle )
+{
+    if( handle < 0 || handle >= static_cast<int>( this->mGestureTargetNodes.size() ) ) return;
+    CCNode *node = this->mGestureTargetNodes[ handle ];
+    if( !node ) return;
+    this->mRouter.setTargetRect( handle, getWorldRect( node ) );
+    this->mRouter.setTargetEnabled( handle, node->isVisible() && node->isRunning() );
+}
+
+void NWGestureLayer::setGestureTargetDirty( int handle )
+{
+    if( handle < 0 || handle >= static_cast<int>( this->mGestureTargetNodes.size() ) ) return;
+    if( !this->mGestureTargetNodes[ handle ] ) return;
+    for( int i = 0; i < static_cast<int>( this->mDirtyGestureTargets.size() ); ++i ) {
+        if( this->mDirtyGestureTargets[i] == handle ) return;
+    }
+    this->mDirtyGestureTargets.push_back( handle );
+}
+
+// the marked ones, or all with auto sync.
+void NWGestureLayer::syncGestureTargets()
+{
+    if( this->mIsGestureTargetAutoSync ) {
+        for( int i = 0; i < static_cast<int>( this->mGestureTargetNodes.size() ); ++i ) {
+            if( this->mGestureTargetNodes[i] ) this->updateGestureTarget( i );
         }
-        
-        // setting finger id
-        bool is_new_register = false;
-        if( this->mTouchIdForPinch[0] != id &&
-            this->mTouchIdForPinch[1] != id ) {
-            // register new touch id.
-            if( this->mTouchIdForPinch[0] == -1 )      this->mTouchIdForPinch[0] = id;
-            else if( this->mTouchIdForPinch[1] == -1 ) this->mTouchIdForPinch[1] = id;
-            else break; // pass.
-            
-            is_new_register = true;
+    } else {
+        for( int i = 0; i < static_cast<int>( this->mDirtyGestureTargets.size() ); ++i ) {
+            this->updateGestureTarget( this->mDirtyGestureTargets[i] );
         }
-        
-        // check two finger.
-        if( this->mTouchIdForPinch[0] == -1 || this->mTouchIdForPinch[1] == -1 ) {
+    }
+    this->mDirtyGestureTargets.clear();
+}
+
+
+#pragma -mark Coalesced Dispatch
+void NWGestureLayer::setCoalescedDispatch( bool is_coalesced )
+{
+    if( !is_coalesced ) this->flushCoalescedEvents();
+    this->mIsCoalescedDispatch = is_coalesced;
+}
+
+// keep only the latest point of each touch.
+void NWGestureLayer::queueMove( const NWPoint &p, int id, bool is_drag )
+{
+    PendingMove *move = NULL;
+    for( int i = 0; i < this->mPendingMoveCount; ++i ) {
+        if( this->mPendingMoves[i].id == id ) {
+            move = &this->mPendingMoves[i];
             break;
         }
-        
-        // alias
-        int id1 = this->mTouchIdForPinch[0];
-        int id2 = this->mTouchIdForPinch[1];
-        
-        // if there is a new registration, calculate base distance.
-        if( is_new_register ) {
-            this->mPreviousDistanceOfPinch = this->mBaseDistanceOfPinch = fabsf(
-                this->getDistanceBetweenTwoTouch( id1, id2 )
-            );
+    }
+    if( !move ) {
+        if( this->mPendingMoveCount >= NWGestureRecognizer::MAX_TOUCHES ) {
+            this->flushCoalescedEvents();
         }
-        
-        // get magnification
-        float distance = fabsf( this->getDistanceBetweenTwoTouch( id1, id2 ) );
-        float magnification = 1.0f;
-        if( this->mBaseDistanceOfPinch != 0.0f ) {
-            magnification = distance / this->mBaseDistanceOfPinch;
+        move = &this->mPendingMoves[this->mPendingMoveCount++];
+        move->id = id;
+    }
+    move->point = p;
+    move->isDrag = is_drag;
+    this->scheduleFlush();
+}
+
+// the pinch of the transform just queued.
+void NWGestureLayer::queuePinch( float magnification, int id1, int id2 )
+{
+    PendingTransform &pending = this->mPendingTransforms[ this->mLastTransformGroup ];
+    pending.hasPinch = true;
+    pending.magnification = magnification;
+    pending.pinchIds[0] = id1;
+    pending.pinchIds[1] = id2;
+    this->scheduleFlush();
+}
+
+void NWGestureLayer::queueTransform( const NWTransform &transform )
+{
+    PendingTransform &pending = this->mPendingTransforms[ this->mLastTransformGroup ];
+    pending.hasTransform = true;
+    pending.transform = transform;
+    this->scheduleFlush();
+}
+
+void NWGestureLayer::setLastTransformGroup( const NWTransform &transform )
+{
+    int group = transform.group;
+    this->mLastTransformGroup = 0 <= group && group < NWGestureRecognizer::MAX_TRANSFORMS ? group : 0;
+}
+
+// deliver at the next tick. scheduled only while something is pending.
+void NWGestureLayer::scheduleFlush()
+{
+    if( this->mIsFlushScheduled ) return;
+    this->mIsFlushScheduled = true;
+    this->scheduleOnce( schedule_selector( NWGestureLayer::coalescedEventHandler ), 0.0f );
+}
+
+// this func will used in schedule.
+void NWGestureLayer::coalescedEventHandler()
+{
+    this->mIsFlushScheduled = false;
+    this->flushCoalescedEvents();
+}
+
+// same order as the recognizer: transform and pinch of each gesture, then each touch.
+void NWGestureLayer::flushCoalescedEvents()
+{
+    for( int g = 0; g < NWGestureRecognizer::MAX_TRANSFORMS; ++g ) {
+        PendingTransform &pending = this->mPendingTransforms[g];
+        if( pending.hasTransform ) {
+            pending.hasTransform = false;
+            this->onTransform( pending.transform );
         }
-        
-        // callback
-        this->onPinchAction( magnification, id1, id2 );
-        if( distance < this->mPreviousDistanceOfPinch ) {
-            this->onPinchIn( magnification, id1, id2 );
-        } else {
-            this->onPinchOut( magnification, id1, id2 );
+        if( pending.hasPinch ) {
+            pending.hasPinch = false;
+            float magnification = pending.magnification;
+            int id1 = pending.pinchIds[0];
+            int id2 = pending.pinchIds[1];
+
+            // direction of the whole frame.
+            this->onPinchAction( magnification, id1, id2 );
+            if( magnification < pending.deliveredMagnification ) {
+                this->onPinchIn( magnification, id1, id2 );
+            } else {
+                this->onPinchOut( magnification, id1, id2 );
+            }
+            pending.deliveredMagnification = magnification;
         }
-        
-        this->mPreviousDistanceOfPinch = distance;
-        return true;
-    } while(0);
-    return false;
+    }
+
+    // callbacks may queue again, so take the moves out first.
+    int count = this->mPendingMoveCount;
+    PendingMove moves[NWGestureRecognizer::MAX_TOUCHES];
+    for( int i = 0; i < count; ++i ) moves[i] = this->mPendingMoves[i];
+    this->mPendingMoveCount = 0;
+
+    for( int i = 0; i < count; ++i ) {
+        CCPoint touch_point( moves[i].point.x, moves[i].point.y );
+        if( moves[i].isDrag ) this->onDrag( touch_point, moves[i].id );
+        else                  this->onScroll( touch_point, moves[i].id );
+    }
 }
 
 
+#pragma -mark ListenerBridge
+void NWGestureLayer::ListenerBridge::onSingleTap( const NWPoint &p ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onSingleTap( touch_point );
+}
+void NWGestureLayer::ListenerBridge::onDoubleTap( const NWPoint &p ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onDoubleTap( touch_point );
+}
+bool NWGestureLayer::ListenerBridge::isDoubleTapSupport( const NWPoint &p ) {
+    return mLayer->isDoubleTapSupport();
+}
+void NWGestureLayer::ListenerBridge::onSingleTapTentative( const NWPoint &p ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onSingleTapTentative( touch_point );
+}
+void NWGestureLayer::ListenerBridge::onSingleTapRevoked( const NWPoint &p ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onSingleTapRevoked( touch_point );
+}
+void NWGestureLayer::ListenerBridge::onDown( const NWPoint &p, int id ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onDown( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onHold( const NWPoint &p, int id ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onHold( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onTap( const NWPoint &p, int id ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onTap( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onCancelled( const NWPoint &p, int id ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onCancelled( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onScroll( const NWPoint &p, int id ) {
+    if( mLayer->mIsCoalescedDispatch ) {
+        mLayer->queueMove( p, id, false );
+        return;
+    }
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onScroll( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onFlick( touch_point, id, direction, vx, vy );
+}
+void NWGestureLayer::ListenerBridge::onSwipe( const NWPoint &p, int id, int direction ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onSwipe( touch_point, id, direction );
+}
+void NWGestureLayer::ListenerBridge::onDrag( const NWPoint &p, int id ) {
+    if( mLayer->mIsCoalescedDispatch ) {
+        mLayer->queueMove( p, id, true );
+        return;
+    }
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onDrag( touch_point, id );
+}
+void NWGestureLayer::ListenerBridge::onDragEnded( const NWPoint &p, int id ) {
+    mLayer->flushCoalescedEvents();
+    CCPoint touch_point( p.x, p.y );
+    mLayer->onDragEnded( touch_point, id );
+}
+// PinchIn & PinchOut are made from PinchAction at flush.
+void NWGestureLayer::ListenerBridge::onPinchIn( float magnification, int id1, int id2 ) {
+    if( mLayer->mIsCoalescedDispatch ) return;
+    mLayer->onPinchIn( magnification, id1, id2 );
+}
+void NWGestureLayer::ListenerBridge::onPinchOut( float magnification, int id1, int id2 ) {
+    if( mLayer->mIsCoalescedDispatch ) return;
+    mLayer->onPinchOut( magnification, id1, id2 );
+}
+void NWGestureLayer::ListenerBridge::onPinchAction( float magnification, int id1, int id2 ) {
+    if( mLayer->mIsCoalescedDispatch ) {
+        mLayer->queuePinch( magnification, id1, id2 );
+        return;
+    }
+    mLayer->onPinchAction( magnification, id1, id2 );
+}
+void NWGestureLayer::ListenerBridge::onPinchEnded( float magnification, int id1, int id2 ) {
+    mLayer->flushCoalescedEvents();
+    mLayer->mPendingTransforms[ mLayer->mLastTransformGroup ].deliveredMagnification = 1.0f;
+    mLayer->onPinchEnded( magnification, id1, id2 );
+}
+void NWGestureLayer::ListenerBridge::onTransform( const NWTransform &transform ) {
+    mLayer->setLastTransformGroup( transform );
+    if( mLayer->mIsCoalescedDispatch ) {
+        mLayer->queueTransform( transform );
+        return;
+    }
+    mLayer->onTransform( transform );
+}
+void NWGestureLayer::ListenerBridge::onTransformEnded( const NWTransform &transform ) {
+    mLayer->setLastTransformGroup( transform );
+    mLayer->flushCoalescedEvents();
+    mLayer->onTransformEnded( transform );
+}
+
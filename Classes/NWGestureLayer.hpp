@@ -10,11 +10,21 @@
 #define __NWGestureLayer__
 
 #include "cocos2d.h"
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureEventQueue.hpp"
+#include "NWGestureRouter.hpp"
+#include "NWLayoutMetrics.hpp"
+
+class NWGestureThread;
+class NWGestureArbiter;
 
 /**
  *  @class  NWGestureLayer
  *  @brief  Layer for detecting gestures.
  *
+ *  Adapter of NWGestureRecognizer for cocos2d-x.
+ *  converts CCTouch to NWTouchSample and drives the recognizer's timer.
+ *
  *  @author  Mitsuaki.N
  *  @date    create on 2013/12/17
  *  @version 1.0.0
@@ -30,7 +40,10 @@ public:
      *  @brief  Define the directions. used by flick functions.
      */
     enum Direction {
-        UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8,
+        UP    = NWGestureRecognizer::UP,
+        DOWN  = NWGestureRecognizer::DOWN,
+        LEFT  = NWGestureRecognizer::LEFT,
+        RIGHT = NWGestureRecognizer::RIGHT,
     };
     static bool isUpDir( int dir )          { return dir &  UP;   }
     static bool isDownDir( int dir )        { return dir & DOWN;  }
@@ -47,6 +60,7 @@ public:
     NWGestureLayer();
     virtual ~NWGestureLayer();
     virtual bool init();
+    virtual void onExit();
 
     // Override touch events.
     virtual void ccTouchesBegan( cocos2d::CCSet *pTouches, cocos2d::CCEvent *pEvent );
@@ -63,48 +77,131 @@ public:
      *  @warning This func may not call from except for init().
      */
     void setMulitapSupport( bool is_supported ) {
-        this->mIsMultitapSupported = is_supported;
+        this->mRecognizer.setMulitapSupport( is_supported );
     }
     bool isMultitapSupport() {
-        return this->mIsMultitapSupported;
+        return this->mRecognizer.isMultitapSupport();
     }
     
     /**
      *  Set whether to support the PinchAction.
      */
     void setPinchActionSupport( bool is_supported ) {
-        this->mIsPinchActionSupported = is_supported;
+        this->mRecognizer.setPinchActionSupport( is_supported );
     }
     bool isPinchActionSupport() {
-        return this->mIsPinchActionSupported;
+        return this->mRecognizer.isPinchActionSupport();
+    }
+
+    /**
+     *  Set whether this layer uses the DoubleTap.
+     *  if not supported, onSingleTap is called at once without waiting for
+     *  TimeThresholdForDoubleTap. the gesture targets answer for themselves
+     *  by their mask (NW_GESTURE_DOUBLE_TAP), and the event queue by its mask.
+     *  in threaded mode, the thread can't ask them: it waits by this setting,
+     *  or by the mask of the event queue when it's set, for all targets.
+     *  set the mask of the queue before setEventQueue().
+     */
+    void setDoubleTapSupport( bool is_supported );
+    bool isDoubleTapSupport() {
+        return this->mIsDoubleTapSupported;
+    }
+
+    /**
+     *  Set whether to call onSingleTapTentative at once at the first tap,
+     *  then onSingleTap (confirmed) or onSingleTapRevoked (before onDoubleTap).
+     *  for instant feedback of the tap while DoubleTap is used.
+     */
+    void setTentativeSingleTap( bool is_tentative ) {
+        this->mRecognizer.setTentativeSingleTap( is_tentative );
+    }
+    bool isTentativeSingleTap() {
+        return this->mRecognizer.isTentativeSingleTap();
     }
 
     /**
      *  Set the Base distance for determine moved or not.
+     *  default is 1/10 of the window diagonal, updated by updateLayoutMetrics().
+     *  @param  distance    points. fixed until the next call of
+     *                      setDistanceThresholdForMovedInMM().
      */
     void setDistanceThresholdForMoved( float distance ) {
-        this->mDistanceThresholdForMoved = distance;
+        this->mDistanceThresholdForMovedInMM = -1.0f;
+        this->mRecognizer.setDistanceThresholdForMoved( distance );
     }
     float getDistanceThresholdForMoved() {
-        return this->mDistanceThresholdForMoved;
+        return this->mRecognizer.getDistanceThresholdForMoved();
+    }
+
+    /**
+     *  Set the Base distance for determine moved or not in millimetres
+     *  on the screen, the same for any resolution and density.
+     *  converted to points by updateLayoutMetrics().
+     *  @param  mm  0 returns to 1/10 of the window diagonal.
+     */
+    void setDistanceThresholdForMovedInMM( float mm );
+    float getDistanceThresholdForMovedInMM() {
+        return this->mDistanceThresholdForMovedInMM;
     }
     
+    /**
+     *  Set the distance to group the fingers into one PinchAction (Transform).
+     *  fingers far from each other make separate gestures,
+     *  told apart by NWTransform::group.
+     *  @param  distance    px. 0: all fingers are one gesture.
+     */
+    void setDistanceThresholdForGroup( float distance ) {
+        this->mDistanceThresholdForGroupInMM = 0.0f;
+        this->mRecognizer.setDistanceThresholdForGroup( distance );
+    }
+    float getDistanceThresholdForGroup() {
+        return this->mRecognizer.getDistanceThresholdForGroup();
+    }
+
+    /**
+     *  Set the distance to group the fingers in millimetres on the screen.
+     *  converted to points by updateLayoutMetrics().
+     *  @param  mm  0: all fingers are one gesture.
+     */
+    void setDistanceThresholdForGroupInMM( float mm );
+    float getDistanceThresholdForGroupInMM() {
+        return this->mDistanceThresholdForGroupInMM;
+    }
+
+    /**
+     *  Recompute the distance thresholds from the window size, the design
+     *  resolution and the DPI. call it after a rotation or a resize.
+     *  it's also checked at each touch began, so a change of the window
+     *  size takes effect from the next touch without calling this.
+     *  in threaded mode, the recognizer keeps the old thresholds until
+     *  setThreadedMode( false ), since the thread is reading them.
+     */
+    void updateLayoutMetrics();
+
+    /**
+     *  Get points per millimetre on the screen, as of updateLayoutMetrics().
+     */
+    float getPointsPerMM() {
+        return this->mLayout.getPointsPerMM();
+    }
+
     /**
      *  Set time threshold for determining Single-tap or Double-tap.
-     *  if there is the next tap within this time,
+     *  if there is the next tap near the first one within this time,
      *  those tap is determined to the Double-tap.
      *  @param  time    sec.
      */
     void setTimeThresholdForDoubleTap( double time ) {
-        this->mTimeThresholdForDoubleTap = time;
+        this->mRecognizer.setTimeThresholdForDoubleTap( time );
     }
     double getTimeThresholdForDoubleTap() {
-        return this->mTimeThresholdForDoubleTap;
+        return this->mRecognizer.getTimeThresholdForDoubleTap();
     }
     
     /**
      *  Set detection accuracy of hold.
-     *  It's the schedule interval value for monitoring the hold.
+     *  @deprecated Hold is detected by the timer at its exact time now.
+     *              this value is no longer used.
      *  @param  time    sec.
      */
     void setDetectionAccuracyOfHold( float time ) {
@@ -119,24 +216,214 @@ public:
      *  @param  time    sec.
      */
     void setTimeThresholdForHold( double time ) {
-        this->mTimeThresholdForHold = time;
+        this->mRecognizer.setTimeThresholdForHold( time );
     }
     double getTimeThresholdForHold() {
-        return this->mTimeThresholdForHold;
+        return this->mRecognizer.getTimeThresholdForHold();
     }
     
     /**
      *  Set time threshold for decide whether Flick or Swipe.
-     *  if touch move is ended within this time,
-     *  a touch movement is determined to Flick.
+     *  it's used for the default of VelocityThresholdForFlick.
      *  @param  time    sec
-     *  @warning I don't understand real method of detecting a Flick! ごめんよ！
      */
     void setTimeThresholdForFlick( double time ) {
-        this->mTimeThresholdForFlick = time;
+        this->mRecognizer.setTimeThresholdForFlick( time );
     }
     double getTimeThresholdForFlick() {
-        return this->mTimeThresholdForFlick;
+        return this->mRecognizer.getTimeThresholdForFlick();
+    }
+
+    /**
+     *  Set release velocity threshold for decide whether Flick or Swipe.
+     *  if the finger leaves faster than this, it's determined to Flick.
+     *  velocity is estimated from the samples of the last 100 ms.
+     *  @param  velocity    px/sec. 0 means
+     *                      DistanceThresholdForMoved / TimeThresholdForFlick.
+     */
+    void setVelocityThresholdForFlick( float velocity ) {
+        this->mRecognizer.setVelocityThresholdForFlick( velocity );
+    }
+    float getVelocityThresholdForFlick() {
+        return this->mRecognizer.getVelocityThresholdForFlick();
+    }
+    
+    
+    /**
+     *  Set the time source of gestures. NULL is the monotonic clock.
+     *  @warning clock isn't retained.
+     */
+    void setClock( NWClock *clock );
+    NWClock* getClock() {
+        return this->mRecognizer.getClock();
+    }
+
+    /**
+     *  Set the recorder of the raw touch events (e.g. NWTouchTraceWriter).
+     *  recorded trace can be replayed by tools/nwgesture_replay.
+     *  @warning recorder isn't retained.
+     */
+    void setTouchRecorder( NWTouchRecorder *recorder ) {
+        this->mRecognizer.setTouchRecorder( recorder );
+    }
+    NWTouchRecorder* getTouchRecorder() {
+        return this->mRecognizer.getTouchRecorder();
+    }
+
+    /**
+     *  Set where the latency and the cost of the gestures are recorded (NWGestureStats).
+     *  recorded only when built with NW_GESTURE_STATS=1. poll or dump() it at any time.
+     *  in threaded mode, the latency is to when the layer takes the gesture
+     *  on the main thread.
+     *  @warning stats isn't retained. set it before setThreadedMode( true ).
+     */
+    void setGestureStats( NWGestureStats *stats ) {
+        this->mRecognizer.setStats( stats );
+    }
+    NWGestureStats* getGestureStats() {
+        return this->mRecognizer.getStats();
+    }
+
+    /**
+     *  Set how much of the touch path is kept.
+     *  e.g. NWHistoryPolicy( 64, 4.0f, 0.0 ) keeps up to 64 samples
+     *  and drops samples that moved less than 4px.
+     *  @warning This func may not call from except for init().
+     */
+    void setHistoryPolicy( const NWHistoryPolicy &policy ) {
+        this->mRecognizer.setHistoryPolicy( policy );
+    }
+    const NWHistoryPolicy& getHistoryPolicy() {
+        return this->mRecognizer.getHistoryPolicy();
+    }
+
+    /**
+     *  Set the smoothing and the prediction of getSmoothedPoint() and
+     *  getPredictedPoint(). e.g. NWFilterPolicy( 1.0f, 0.05f, 1.0 / 60.0 )
+     *  smooths by the One Euro filter and predicts a frame ahead at 60 Hz.
+     *  the callbacks keep receiving the raw points.
+     *  @warning This func may not call from except for init().
+     */
+    void setFilterPolicy( const NWFilterPolicy &policy ) {
+        this->mRecognizer.setFilterPolicy( policy );
+    }
+    const NWFilterPolicy& getFilterPolicy() {
+        return this->mRecognizer.getFilterPolicy();
+    }
+
+    /**
+     *  Set whether to coalesce the continuous gestures per frame.
+     *  if true, onScroll, onDrag, onPinch* and onTransform are called
+     *  at most once per touch (per gesture) in a frame with the latest value,
+     *  from the next scheduler tick. the other gestures are called at once,
+     *  after the pending ones to keep the order.
+     *  the intermediate points are still in getTouchHistoryView().
+     */
+    void setCoalescedDispatch( bool is_coalesced );
+    bool isCoalescedDispatch() {
+        return this->mIsCoalescedDispatch;
+    }
+
+    /**
+     *  Write the gestures into the queue instead of calling the callbacks.
+     *  the on* callbacks of gestures (onTap, onScroll, ...) are not called
+     *  while it's set. onTouch* callbacks are still called.
+     *  the queue's clock is set to getClock().
+     *  @param  queue   NULL returns to the callbacks.
+     *  @warning queue isn't retained.
+     */
+    void setEventQueue( NWGestureEventQueue *queue );
+    NWGestureEventQueue* getEventQueue() {
+        return this->mEventQueue;
+    }
+
+#if NW_GESTURE_THREADED
+    /**
+     *  Set whether to run the recognizer on its own thread (NWGestureThread).
+     *  the touches are passed to the thread, and the gestures are called back
+     *  (or queued to the event queue) from the scheduler on the main thread.
+     *  @warning set the parameters before this. the parameters and
+     *           "Get touch infomation" funcs are not thread safe while it's on.
+     */
+    void setThreadedMode( bool is_threaded );
+#endif
+    bool isThreadedMode() {
+        return this->mGestureThread != NULL;
+    }
+
+    /**
+     *  Recognize the gestures by the arbiter (e.g. with NWStandardRecognizers)
+     *  instead of the built-in recognizer. the built-in one still tracks the
+     *  touches for "Get touch infomation" funcs, but its gestures are dropped.
+     *  the arbiter's clock and listener are set by this layer.
+     *  @param  arbiter NULL returns to the built-in recognizer.
+     *  @warning arbiter isn't retained. it's not used in threaded mode.
+     */
+    void setArbiter( NWGestureArbiter *arbiter );
+    NWGestureArbiter* getArbiter() {
+        return this->mArbiter;
+    }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Gesture Target
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Add a region which receives the gestures started on it.
+     *  the gestures of a touch go to the target touched down (see NWGestureRouter).
+     *  gestures without target go to the callbacks of this layer as before.
+     *  @param  rect        world coordinate.
+     *  @param  mask        types to receive. bit ( 1 << NWGestureEventType ).
+     *  @param  priority    the higher one wins where targets overlap.
+     *  @return handle of the target.
+     *  @warning listener isn't retained.
+     */
+    int addGestureTarget( const cocos2d::CCRect &rect, NWGestureListener *listener,
+                          unsigned int mask = ~0u, int priority = 0 );
+
+    /**
+     *  Add a node as a target. its rect is the bounding box in the world.
+     *  node is retained until removeGestureTarget().
+     *  invisible or not running node doesn't receive.
+     */
+    int addGestureTarget( cocos2d::CCNode *node, NWGestureListener *listener,
+                          unsigned int mask = ~0u, int priority = 0 );
+
+    void removeGestureTarget( int handle );
+    void removeAllGestureTargets();
+
+    /**
+     *  Move the target of the rect.
+     */
+    void setGestureTargetRect( int handle, const cocos2d::CCRect &rect );
+
+    /**
+     *  Read the bounding box of the target node again. call it when it moved.
+     */
+    void updateGestureTarget( int handle );
+
+    /**
+     *  Mark the target node as moved. its bounding box is read again at
+     *  the next touch down, once however many times it's marked.
+     *  O(marked nodes) per touch down.
+     */
+    void setGestureTargetDirty( int handle );
+
+    /**
+     *  Set whether to update all target nodes at each touch down. default false.
+     *  it's O(nodes) per touch down, but needs no call when nodes move.
+     *  without it, call setGestureTargetDirty() or updateGestureTarget()
+     *  for the moved nodes.
+     */
+    void setGestureTargetAutoSync( bool is_auto ) {
+        this->mIsGestureTargetAutoSync = is_auto;
+    }
+    bool isGestureTargetAutoSync() {
+        return this->mIsGestureTargetAutoSync;
+    }
+
+    NWGestureRouter* getRouter() {
+        return &this->mRouter;
     }
     
     
@@ -147,16 +434,35 @@ public:
      *  Get tap path.
      *  @param id   this id is passed to each callback func.
      *  @warning Don't specify except passed id from callback funcs.
+     *  @return NULL if there is no touch of id.
+     *  @warning returned vector is a copy, overwritten by the next call for
+     *           the touch, or for a later touch in its slot.
      */
     std::vector<cocos2d::CCPoint>* getTouchHistory( int id = 0 );
+
+    /**
+     *  Get tap path without copying. samples are kept by HistoryPolicy.
+     *  @param id   this id is passed to each callback func.
+     *  @return NULL if there is no touch of id.
+     *  @warning an ended touch is released after its ending callback,
+     *           so it's already gone when the event queue hands out the end.
+     */
+    const NWTouchHistory* getTouchHistoryView( int id = 0 );
     
     /**
-     *  Get total move distance of tap.
+     *  Get total move distance of tap. O(1).
      *  @param id   this id is passed to each callback func.
      *  @warning Don't specify except passed id from callback funcs.
      */
     float getTotalDistance( int id = 0 );
     
+    /**
+     *  Get the engine independent recognizer.
+     */
+    NWGestureRecognizer* getRecognizer() {
+        return &this->mRecognizer;
+    }
+
     /**
      *  Get direction of move from start ponit to end point.
      *  direction is a collection of Direction Flags.
@@ -165,12 +471,60 @@ public:
      *  @warning Don't specify except passed id from callback funcs.
      */
     int getDirection( int id = 0 );
+
+    /**
+     *  Get the bounding box of all points the touch passed.
+     *  @param id   this id is passed to each callback func.
+     *  @warning Don't specify except passed id from callback funcs.
+     */
+    cocos2d::CCRect getBoundingBox( int id );
+
+    /**
+     *  Get the vector from touch start point to the latest point.
+     *  @param id   this id is passed to each callback func.
+     *  @warning Don't specify except passed id from callback funcs.
+     */
+    cocos2d::CCPoint getNetDisplacement( int id = 0 );
+
+    /**
+     *  Get the current velocity of the touch (px/sec).
+     *  @param id   this id is passed to each callback func.
+     *  @warning Don't specify except passed id from callback funcs.
+     */
+    cocos2d::CCPoint getVelocity( int id = 0 );
+
+    /**
+     *  Get the latest point of the touch smoothed by FilterPolicy.
+     *  e.g. move the sprite to it in onDrag() instead of the raw point.
+     *  @param id   this id is passed to each callback func.
+     *  @warning Don't specify except passed id from callback funcs.
+     */
+    cocos2d::CCPoint getSmoothedPoint( int id = 0 );
+
+    /**
+     *  Get the point the touch will be at after FilterPolicy's predictionTime.
+     *  @param id   this id is passed to each callback func.
+     *  @warning Don't specify except passed id from callback funcs.
+     */
+    cocos2d::CCPoint getPredictedPoint( int id = 0 );
     
 
     //////////////////////////////////////////////////////////////////////
     // Callback
     // -- according to your necessity override those callback func.
     //////////////////////////////////////////////////////////////////////
+    /**
+     *  Get the time when the touch happened.
+     *  cocos2d-x doesn't pass the event time, so the default is the time
+     *  this touch event is handled. override it if the platform glue
+     *  knows the real time (e.g. MotionEvent.getEventTime on Android).
+     *  @param now  current time of getClock().
+     *  @return nanosec on the same clock as getClock().
+     */
+    virtual NWTime getTouchTime( cocos2d::CCTouch *touch, NWTime now ) {
+        return now;
+    }
+
     // touch callback: Single-tap Mode only.
     virtual void onTouchBegan( cocos2d::CCTouch *touch, cocos2d::CCEvent *event ) {}
     virtual void onTouchMoved( cocos2d::CCTouch *touch, cocos2d::CCEvent *event ) {}
@@ -187,6 +541,9 @@ public:
     // callback for touch actions.
     virtual void onSingleTap( cocos2d::CCPoint &touchPoint ) {}
     virtual void onDoubleTap( cocos2d::CCPoint &touchPoint ) {}
+    // with setTentativeSingleTap( true ).
+    virtual void onSingleTapTentative( cocos2d::CCPoint &touchPoint ) {}
+    virtual void onSingleTapRevoked( cocos2d::CCPoint &touchPoint ) {}
     
     virtual void onDown( cocos2d::CCPoint &touchPoint, int id ) {}
     virtual void onHold( cocos2d::CCPoint &touchPoint, int id ) {}
@@ -195,6 +552,10 @@ public:
     
     virtual void onScroll( cocos2d::CCPoint &touchPoint, int id ) {}
     virtual void onFlick( cocos2d::CCPoint &touchPoint, int id, int direction ) {}
+    // Flick with the release velocity (px/sec). default calls onFlick above.
+    virtual void onFlick( cocos2d::CCPoint &touchPoint, int id, int direction, float vx, float vy ) {
+        this->onFlick( touchPoint, id, direction );
+    }
     virtual void onSwipe( cocos2d::CCPoint &touchPoint, int id, int direction ) {}
     virtual void onDrag( cocos2d::CCPoint &touchPoint, int id ) {}
     virtual void onDragEnded( cocos2d::CCPoint &touchPoint, int id ) {}
@@ -203,52 +564,131 @@ public:
     virtual void onPinchOut( float magnification, int id1, int id2 ) {}
     virtual void onPinchAction( float magnification, int id1, int id2 ) {}
     virtual void onPinchEnded( float magnification, int id1, int id2 ) {}
+
+    // callback for multi-touch gesture: scale, rotation and move of all fingers.
+    virtual void onTransform( const NWTransform &transform ) {}
+    virtual void onTransformEnded( const NWTransform &transform ) {}
     
     
 private:
+    //////////////////////////////////////////////////////////////////////
+    // Recognizer
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Forward the recognizer's gestures to the NWGestureLayer callbacks.
+     */
+    class ListenerBridge : public NWGestureListener {
+    public:
+        explicit ListenerBridge( NWGestureLayer *layer ) : mLayer( layer ) {}
+
+        virtual void onSingleTap( const NWPoint &p );
+        virtual void onDoubleTap( const NWPoint &p );
+        virtual bool isDoubleTapSupport( const NWPoint &p );
+        virtual void onSingleTapTentative( const NWPoint &p );
+        virtual void onSingleTapRevoked( const NWPoint &p );
+        virtual void onDown( const NWPoint &p, int id );
+        virtual void onHold( const NWPoint &p, int id );
+        virtual void onTap( const NWPoint &p, int id );
+        virtual void onCancelled( const NWPoint &p, int id );
+        virtual void onScroll( const NWPoint &p, int id );
+        using NWGestureListener::onFlick;
+        virtual void onFlick( const NWPoint &p, int id, int direction, float vx, float vy );
+        virtual void onSwipe( const NWPoint &p, int id, int direction );
+        virtual void onDrag( const NWPoint &p, int id );
+        virtual void onDragEnded( const NWPoint &p, int id );
+        virtual void onPinchIn( float magnification, int id1, int id2 );
+        virtual void onPinchOut( float magnification, int id1, int id2 );
+        virtual void onPinchAction( float magnification, int id1, int id2 );
+        virtual void onPinchEnded( float magnification, int id1, int id2 );
+        virtual void onTransform( const NWTransform &transform );
+        virtual void onTransformEnded( const NWTransform &transform );
+
+    private:
+        NWGestureLayer *mLayer;
+    };
+
+    NWGestureRecognizer mRecognizer;
+    ListenerBridge      mListenerBridge;
+    NWGestureEventQueue *mEventQueue;
+    NWGestureThread     *mGestureThread;    // NULL: not threaded.
+    NWGestureArbiter    *mArbiter;          // NULL: the built-in recognizer.
+    NWGestureRouter      mRouter;
+
+    NWGestureListener* getGestureListener();
+    void updateGestureListener();
+    void updateThreadDoubleTapSupport();
+
+
     //////////////////////////////////////////////////////////////////////
     // Config Parameter
     //////////////////////////////////////////////////////////////////////
-    // Common
-    float   mDistanceThresholdForMoved;
-    
-    // SingleTap & DoubleTap
-    double  mTimeThresholdForDoubleTap;
-    
-    // Hold & Drag
+    // Hold & Drag (unused)
     float   mDetectionAccuracyOfHold;
-    double  mTimeThresholdForHold;
 
-    // Flick
-    double  mTimeThresholdForFlick;
+    // SingleTap & DoubleTap
+    bool    mIsDoubleTapSupported;
+
+    // Layout: thresholds in mm. Moved: 0 is 1/10 of the window diagonal,
+    // negative is fixed points. Group: 0 is fixed points.
+    float   mDistanceThresholdForMovedInMM;
+    float   mDistanceThresholdForGroupInMM;
+    NWLayoutMetrics mLayout;            // window of the thresholds.
+    bool    mIsLayoutPending;           // thresholds not given to the recognizer yet.
+    void applyLayoutThresholds();
 
 
     //////////////////////////////////////////////////////////////////////
     // Private Attribute and Functions.
     //////////////////////////////////////////////////////////////////////
-    // Parameter
-    bool    mIsMultitapSupported;
-    bool    mIsPinchActionSupported;
-    cocos2d::CCArray mTouchInfos;
+    std::vector<NWTouchSample>      mTouchSamples;      // reused buffer.
+    std::vector<cocos2d::CCPoint>   mTouchHistoryBuffers[NWGestureRecognizer::MAX_TOUCHES];   // index is the slot.
+    NWTime  mScheduledDeadline;     // negative: not scheduled.
 
-    // SingleTap & DoubleTap
-    int     mFirstTapId;
-    double  mFirstTapTime;
-    cocos2d::CCPoint mFirstTapPoint;
-    
-    void tapEventManager( cocos2d::CCTouch *touch);
-    void scheduleSingleTapHandler();
-    
-    // Hold & Drag
-    void scheduleHoldHandler();
-    
-    // PinchAction
-    float   mBaseDistanceOfPinch;
-    float   mPreviousDistanceOfPinch;
-    int     mTouchIdForPinch[2];
-    
-    float getDistanceBetweenTwoTouch( int id1, int id2 );
-    bool pinchActionHandler( cocos2d::CCTouch *touch, bool is_end = false );
+    // Coalesced Dispatch: the latest continuous gestures in this frame.
+    struct PendingMove {
+        int     id;
+        NWPoint point;
+        bool    isDrag;
+    };
+    bool        mIsCoalescedDispatch;
+    bool        mIsFlushScheduled;
+    PendingMove mPendingMoves[NWGestureRecognizer::MAX_TOUCHES];
+    int         mPendingMoveCount;
+    struct PendingTransform {
+        bool        hasTransform;
+        NWTransform transform;
+        bool        hasPinch;
+        float       magnification;
+        float       deliveredMagnification;
+        int         pinchIds[2];
+    };
+    PendingTransform mPendingTransforms[NWGestureRecognizer::MAX_TRANSFORMS];   // index is group.
+    int         mLastTransformGroup;    // Pinch* follows the Transform* of it.
+
+    cocos2d::CCTouch* makeTouchSamples( cocos2d::CCSet *pTouches );
+    void feedTouchSamples( NWTouchPhase phase );
+
+    // SingleTap & Hold: timer of the recognizer.
+    void scheduleDeadlineHandler();
+    void rescheduleDeadline();
+
+    // Threaded Mode: gestures from the thread.
+    void threadEventHandler();
+
+    // Gesture Target: nodes of the targets. indexed by handle, NULL for rect.
+    std::vector<cocos2d::CCNode*>   mGestureTargetNodes;
+    std::vector<int>                mDirtyGestureTargets;   // handles to read again.
+    bool    mIsGestureTargetAutoSync;
+    void syncGestureTargets();
+
+    // Coalesced Dispatch
+    void queueMove( const NWPoint &p, int id, bool is_drag );
+    void queuePinch( float magnification, int id1, int id2 );
+    void queueTransform( const NWTransform &transform );
+    void setLastTransformGroup( const NWTransform &transform );
+    void scheduleFlush();
+    void coalescedEventHandler();
+    void flushCoalescedEvents();
 };
 
 
@@ -0,0 +1,1037 @@
+//
+//  NWGestureRecognizer.cpp
+//  NoviceWorks
+//
+//  Engine independent part of NWGestureLayer.
+//
+//
+
+// std
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+// myclass
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureStats.hpp"
+
+
+using std::vector;
+
+
+namespace {
+
+// receiver used while no listener is set.
+NWGestureListener sNullListener;
+
+} // unnamed namespace
+
+
+#pragma -mark NWPoint
+float NWPoint::getDistance( const NWPoint &other ) const
+{
+    float dx = other.x - this->x;
+    float dy = other.y - this->y;
+    return sqrtf( dx * dx + dy * dy );
+}
+
+
+#pragma -mark NWTouchHistory
+NWTouchHistory::NWTouchHistory() :
+  mPolicy()
+, mMinInterval( 0 )
+, mHead( 0 )
+, mSize( 0 )
+, mTotalDistance( 0.0f )
+{
+    this->setPolicy( mPolicy );
+}
+
+void NWTouchHistory::setPolicy( const NWHistoryPolicy &policy )
+{
+    this->mPolicy = policy;
+    this->mMinInterval = NWTimeFromSec( policy.minInterval );
+
+    // new buffers, so a smaller capacity gives the memory back.
+    int cap = this->getReserve();
+    std::vector<float>( cap ).swap( this->mXs );
+    std::vector<float>( cap ).swap( this->mYs );
+    std::vector<NWTime>( cap ).swap( this->mTimes );
+    this->clear();
+}
+
+// buffer size of the policy. grown from it only if unlimited.
+int NWTouchHistory::getReserve() const
+{
+    int cap = this->mPolicy.capacity > 0 ? this->mPolicy.capacity : NW_GESTURE_HISTORY_RESERVE;
+    return cap < 2 ? 2 : cap;       // first and latest.
+}
+
+void NWTouchHistory::clear()
+{
+    this->mHead = 0;
+    this->mSize = 0;
+    this->mTotalDistance = 0.0f;
+}
+
+void NWTouchHistory::release()
+{
+    if( static_cast<int>( this->mXs.size() ) > this->getReserve() ) {
+        this->setPolicy( this->mPolicy );
+    } else {
+        this->clear();
+    }
+}
+
+// is the latest sample far enough from the previous kept one.
+bool NWTouchHistory::isTailKept() const
+{
+    float  min_distance = this->mPolicy.minDistance;
+    NWTime min_interval = this->mMinInterval;
+    if( min_distance <= 0.0f && min_interval <= 0 ) return true;
+
+    const NWPoint &tail = (*this)[ this->mSize - 1 ];
+    const NWPoint &prev = (*this)[ this->mSize - 2 ];
+    if( min_distance > 0.0f ) {
+        float dx = tail.x - prev.x;
+        float dy = tail.y - prev.y;
+        if( dx * dx + dy * dy > min_distance * min_distance ) return true;
+    }
+    if( min_interval > 0 ) {
+        if( this->getTime( this->mSize - 1 ) - this->getTime( this->mSize - 2 ) > min_interval ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NWTouchHistory::push( const NWPoint &point, NWTime time )
+{
+    if( this->mSize > 0 ) {
+        this->mTotalDistance += this->back().getDistance( point );
+    }
+
+    // decimation: overwrite the latest sample until it goes far enough.
+    if( this->mSize >= 2 && !this->isTailKept() ) {
+        int index = this->toIndex( this->mSize - 1 );
+        this->mXs[ index ] = point.x;
+        this->mYs[ index ] = point.y;
+        this->mTimes[ index ]  = time;
+        return;
+    }
+
+    int cap = this->mXs.size();
+    if( this->mSize == cap ) {
+        if( this->mPolicy.capacity > 0 ) {
+            // drop the oldest.
+            this->mHead = this->toIndex( 1 );
+            --this->mSize;
+        } else {
+            this->grow();
+        }
+    }
+
+    int index = this->toIndex( this->mSize );
+    this->mXs[ index ] = point.x;
+    this->mYs[ index ] = point.y;
+    this->mTimes[ index ]  = time;
+    ++this->mSize;
+}
+
+// unlimited policy only. double the buffer with oldest at 0.
+void NWTouchHistory::grow()
+{
+    int cap = this->mXs.size();
+    std::vector<float>  xs( cap * 2 );
+    std::vector<float>  ys( cap * 2 );
+    std::vector<NWTime> times( cap * 2 );
+    this->copyTo( &xs[0], &ys[0] );
+    for( int i = 0; i < this->mSize; ++i ) times[i] = this->getTime( i );
+    this->mXs.swap( xs );
+    this->mYs.swap( ys );
+    this->mTimes.swap( times );
+    this->mHead = 0;
+}
+
+// the ring is two runs: head to the end of the buffer, and the wrapped rest.
+int NWTouchHistory::copyTo( float *xs, float *ys ) const
+{
+    int cap = this->mXs.size();
+    int first = cap - this->mHead < this->mSize ? cap - this->mHead : this->mSize;
+    if( first > 0 ) {
+        memcpy( xs, &this->mXs[ this->mHead ], first * sizeof( float ) );
+        memcpy( ys, &this->mYs[ this->mHead ], first * sizeof( float ) );
+    }
+    if( this->mSize > first ) {
+        memcpy( xs + first, &this->mXs[0], ( this->mSize - first ) * sizeof( float ) );
+        memcpy( ys + first, &this->mYs[0], ( this->mSize - first ) * sizeof( float ) );
+    }
+    return this->mSize;
+}
+
+
+#pragma -mark TouchInfo
+NWGestureRecognizer::TouchInfo::TouchInfo() :
+  id( -1 )
+, startTime( 0 )
+, hasMoved( false )
+, hasHold( false )
+, hasEnded( false )
+, minX( 0.0f ), minY( 0.0f ), maxX( 0.0f ), maxY( 0.0f )
+, hasTransformed( false )
+, transformGroup( -1 )
+{
+}
+
+void NWGestureRecognizer::TouchInfo::reset( const NWTouchSample &sample )
+{
+    this->id = sample.id;
+    this->startTime = sample.time;
+    this->hasMoved = false;
+    this->hasHold  = false;
+    this->hasEnded = false;
+    this->hasTransformed = false;
+    this->startPoint = NWPoint( sample.x, sample.y );
+    this->minX = this->maxX = sample.x;
+    this->minY = this->maxY = sample.y;
+    this->touchHistory.release();    // keep buffer, unless a long touch grew it.
+    this->velocityTracker.clear();
+    this->touchFilter.clear();
+    this->insertHistory( sample );
+}
+
+// free the slot. the ended touch is gone from the getters.
+void NWGestureRecognizer::TouchInfo::release()
+{
+    this->id = -1;
+    this->touchHistory.release();
+}
+
+void NWGestureRecognizer::TouchInfo::insertHistory( const NWTouchSample &sample )
+{
+    this->lastPoint = NWPoint( sample.x, sample.y );
+    this->touchHistory.push( this->lastPoint, sample.time );
+    this->velocityTracker.addSample( sample.x, sample.y, sample.time );
+    if( this->touchFilter.isEnabled() ) this->touchFilter.addSample( sample.x, sample.y, sample.time );
+
+    if( sample.x < this->minX ) this->minX = sample.x;
+    if( sample.x > this->maxX ) this->maxX = sample.x;
+    if( sample.y < this->minY ) this->minY = sample.y;
+    if( sample.y > this->maxY ) this->maxY = sample.y;
+}
+
+float NWGestureRecognizer::TouchInfo::getTotalDistance() const
+{
+    return this->touchHistory.getTotalDistance();
+}
+
+int NWGestureRecognizer::TouchInfo::getDirection( float correction_val ) const
+{
+    NWPoint displacement = this->getNetDisplacement();
+    float dx = displacement.x;
+    float dy = displacement.y;
+
+    // Error correction
+    if( dx != 0.0f ) {
+        if( dx > 0.0f ) dx = dx < correction_val ? 0.0f : dx;
+        else dx = dx > -correction_val ? 0.0f : dx;
+    }
+
+    // setup distance flag.
+    int dist = 0;
+    if( dx != 0.0f ) dist |= dx < 0.0f ? NWGestureRecognizer::LEFT : NWGestureRecognizer::RIGHT;
+    if( dy != 0.0f ) dist |= dy < 0.0f ? NWGestureRecognizer::DOWN : NWGestureRecognizer::UP;
+
+    return dist;
+}
+
+NWRect NWGestureRecognizer::TouchInfo::getBoundingBox() const
+{
+    return NWRect( this->minX, this->minY, this->maxX - this->minX, this->maxY - this->minY );
+}
+
+NWPoint NWGestureRecognizer::TouchInfo::getNetDisplacement() const
+{
+    return NWPoint( this->lastPoint.x - this->startPoint.x, this->lastPoint.y - this->startPoint.y );
+}
+
+
+#pragma -mark Class Basic Method.
+NWGestureRecognizer::NWGestureRecognizer() :
+// Config: Common
+  mDistanceThresholdForMoved( 0.0f )
+, mDistanceThresholdForGroup( 0.0f )
+, mDistanceThresholdForMovedSq( 0.0f )
+, mDistanceThresholdForGroupSq( 0.0f )
+, mIsMultitapSupported( true )
+, mIsPinchActionSupported( true )
+
+// Config: SingleTap & DoubleTap
+, mTimeThresholdForDoubleTap( NWTimeFromSec( 0.25 ) )
+, mIsTentativeSingleTap( false )
+
+// Config: Hold & Drag
+, mTimeThresholdForHold( NWTimeFromSec( 1.0 ) )
+
+// Config: Flick
+, mTimeThresholdForFlick( NWTimeFromSec( 0.25 ) )
+, mVelocityThresholdForFlick( 0.0f )
+
+// Config: History
+, mHistoryPolicy()
+
+// Private Attribute
+, mListener( &sNullListener )
+, mClock( NWMonotonicClock::sharedClock() )
+, mRecorder( NULL )
+, mStats( NULL )
+, mLatencyQueue( NULL )
+#if NW_GESTURE_STATS
+, mStatsListener( NULL )
+#endif
+, mHasEndedTouches( false )
+{
+    for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+        this->mTapSequences[i].id = -1;
+        this->mTapSequences[i].time = 0;
+    }
+}
+
+NWGestureRecognizer::~NWGestureRecognizer()
+{
+#if NW_GESTURE_STATS
+    delete this->mStatsListener;
+#endif
+}
+
+void NWGestureRecognizer::setListener( NWGestureListener *listener )
+{
+#if NW_GESTURE_STATS
+    if( this->mStats ) {
+        this->mStatsListener->setListener( listener );
+        return;
+    }
+#endif
+    this->mListener = listener ? listener : &sNullListener;
+}
+
+NWGestureListener* NWGestureRecognizer::getListener()
+{
+#if NW_GESTURE_STATS
+    if( this->mStats ) return this->mStatsListener->getListener();
+#endif
+    return this->mListener == &sNullListener ? NULL : this->mListener;
+}
+
+
+void NWGestureRecognizer::setClock( NWClock *clock )
+{
+    this->mClock = clock ? clock : NWMonotonicClock::sharedClock();
+#if NW_GESTURE_STATS
+    if( this->mStatsListener ) this->mStatsListener->setClock( this->mClock );
+#endif
+}
+
+// the stats listener stands in front of the listener while stats is set.
+void NWGestureRecognizer::setStats( NWGestureStats *stats )
+{
+#if NW_GESTURE_STATS
+    NWGestureListener *listener = this->getListener();
+    if( stats && !this->mStatsListener ) {
+        this->mStatsListener = new NWGestureStatsListener();
+        this->mStatsListener->setClock( this->mClock );
+        this->mStatsListener->setLatencyQueue( this->mLatencyQueue );
+    }
+    this->mStats = stats;
+    if( this->mStatsListener ) this->mStatsListener->setStats( stats );
+    if( stats ) this->mListener = this->mStatsListener;
+    this->setListener( listener );
+#else
+    this->mStats = stats;
+#endif
+}
+
+void NWGestureRecognizer::setLatencyQueue( NWGestureEventQueue *queue )
+{
+    this->mLatencyQueue = queue;
+#if NW_GESTURE_STATS
+    if( this->mStatsListener ) this->mStatsListener->setLatencyQueue( queue );
+#endif
+}
+
+inline void NWGestureRecognizer::setInputTime( NWTime time )
+{
+#if NW_GESTURE_STATS
+    if( this->mStats ) this->mStatsListener->setInputTime( time );
+#endif
+}
+
+void NWGestureRecognizer::setHistoryPolicy( const NWHistoryPolicy &policy )
+{
+    this->mHistoryPolicy = policy;
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        this->mTouchInfos[i].touchHistory.setPolicy( policy );
+    }
+}
+
+void NWGestureRecognizer::setFilterPolicy( const NWFilterPolicy &policy )
+{
+    this->mFilterPolicy = policy;
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        this->mTouchInfos[i].touchFilter.setPolicy( policy );
+    }
+}
+
+
+float NWGestureRecognizer::getVelocityThresholdForFlick() const
+{
+    if( this->mVelocityThresholdForFlick > 0.0f ) return this->mVelocityThresholdForFlick;
+    if( this->mTimeThresholdForFlick <= 0 ) return 0.0f;
+    return this->mDistanceThresholdForMoved /
+           static_cast<float>( NWTimeToSec( this->mTimeThresholdForFlick ) );
+}
+
+
+#pragma -mark Getter
+// small ids are in the slot of the id, the others in any slot. O(1), or O(MAX_TOUCHES).
+NWGestureRecognizer::TouchInfo* NWGestureRecognizer::findTouchInfo( int id )
+{
+    if( id < 0 ) return NULL;
+    if( id < MAX_TOUCHES && this->mTouchInfos[id].id == id ) return &this->mTouchInfos[id];
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        if( this->mTouchInfos[i].id == id ) return &this->mTouchInfos[i];
+    }
+    return NULL;
+}
+const NWGestureRecognizer::TouchInfo* NWGestureRecognizer::findTouchInfo( int id ) const
+{
+    return const_cast<NWGestureRecognizer*>( this )->findTouchInfo( id );
+}
+
+// the slot for a new touch: the last touch of the id, the slot of the id,
+// a free one, or the one of an ended touch. NULL if all are down.
+NWGestureRecognizer::TouchInfo* NWGestureRecognizer::allocateTouchInfo( int id )
+{
+    TouchInfo *info = this->findTouchInfo( id );
+    if( info ) return info;
+    if( id < MAX_TOUCHES && ( this->mTouchInfos[id].id == -1 || this->mTouchInfos[id].hasEnded ) ) {
+        return &this->mTouchInfos[id];
+    }
+
+    TouchInfo *ended = NULL;
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[i];
+        if( ti.id == -1 ) return &ti;
+        if( ti.hasEnded && !ended ) ended = &ti;
+    }
+    return ended;
+}
+
+const NWTouchHistory* NWGestureRecognizer::getTouchHistory( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? &info->touchHistory : NULL;
+}
+int NWGestureRecognizer::getTouchSlot( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? this->getSlot( info ) : -1;
+}
+float NWGestureRecognizer::getTotalDistance( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? info->getTotalDistance() : 0.0f;
+}
+int NWGestureRecognizer::getDirection( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? info->getDirection( this->mDistanceThresholdForMoved ) : 0;
+}
+NWRect NWGestureRecognizer::getBoundingBox( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? info->getBoundingBox() : NWRect();
+}
+NWPoint NWGestureRecognizer::getNetDisplacement( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? info->getNetDisplacement() : NWPoint();
+}
+NWPoint NWGestureRecognizer::getVelocity( int id ) const
+{
+    NWPoint velocity;
+    const TouchInfo *info = this->findTouchInfo( id );
+    if( info ) info->velocityTracker.getVelocity( &velocity.x, &velocity.y );
+    return velocity;
+}
+
+NWPoint NWGestureRecognizer::getSmoothedPoint( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    if( !info ) return NWPoint();
+
+    NWPoint p = info->lastPoint;
+    if( info->touchFilter.isEnabled() ) info->touchFilter.getPoint( &p.x, &p.y );
+    return p;
+}
+
+NWPoint NWGestureRecognizer::getPredictedPoint( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    if( !info ) return NWPoint();
+
+    NWPoint p = this->getSmoothedPoint( id );
+    float ahead = static_cast<float>( this->mFilterPolicy.predictionTime );
+    if( ahead <= 0.0f || info->hasEnded ) return p;
+
+    NWPoint v;
+    info->velocityTracker.getVelocity( &v.x, &v.y );
+    return NWPoint( p.x + v.x * ahead, p.y + v.y * ahead );
+}
+
+int NWGestureRecognizer::getTransformGroup( int id ) const
+{
+    const TouchInfo *info = this->findTouchInfo( id );
+    return info ? info->transformGroup : -1;
+}
+
+
+#pragma -mark Touch Event
+void NWGestureRecognizer::touches( NWTouchPhase phase, const NWTouchSample *samples, int count )
+{
+    switch( phase ) {
+        case NW_TOUCH_BEGAN:     this->touchesBegan( samples, count );      break;
+        case NW_TOUCH_MOVED:     this->touchesMoved( samples, count );      break;
+        case NW_TOUCH_ENDED:     this->touchesEnded( samples, count );      break;
+        case NW_TOUCH_CANCELLED: this->touchesCancelled( samples, count );  break;
+    }
+}
+
+void NWGestureRecognizer::touchesBegan( const NWTouchSample *samples, int count )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_TOUCHES_BEGAN );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_EVENTS );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_SAMPLES, count );
+    if( this->mRecorder ) this->mRecorder->record( NW_TOUCH_BEGAN, samples, count );
+
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( !this->mIsMultitapSupported && sample.id ) continue;
+        TouchInfo *info = sample.id >= 0 ? this->allocateTouchInfo( sample.id ) : NULL;
+        if( !info ) {
+            NWStatsCount( this->mStats, NWGestureStats::COUNT_DROPPED_TOUCHES );
+            continue;
+        }
+        this->setInputTime( sample.time );
+
+        TouchInfo &ti = *info;
+        // the end of the last touch of the id was lost.
+        if( ti.id >= 0 && !ti.hasEnded ) this->cancelTouch( &ti, ti.lastPoint );
+        ti.reset( sample );
+
+        // callback
+        this->mListener->onDown( ti.lastPoint, ti.id );
+
+        // transform
+        if( this->mIsPinchActionSupported ) this->addTransformTouch( this->getSlot( &ti ) );
+    }
+}
+
+void NWGestureRecognizer::touchesMoved( const NWTouchSample *samples, int count )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_TOUCHES_MOVED );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_EVENTS );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_SAMPLES, count );
+    if( this->mRecorder ) this->mRecorder->record( NW_TOUCH_MOVED, samples, count );
+
+    bool is_transform_moved = false;
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( !this->mIsMultitapSupported && sample.id ) continue;
+
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        this->setInputTime( sample.time );
+        NWPoint touch_point( sample.x, sample.y );
+
+        // check move
+        if( !info->hasMoved &&
+            info->startPoint.getDistanceSq( touch_point ) > this->mDistanceThresholdForMovedSq ) {
+            info->hasMoved = true;
+        }
+
+        // insert history.
+        info->insertHistory( sample );
+
+        // transform. callback once per gesture after all touches are updated.
+        int group = info->transformGroup;
+        if( group >= 0 && this->mTransforms[ group ].count >= 2 ) {
+            this->mTransforms[ group ].hasMoved = true;
+            is_transform_moved = true;
+
+        // moved! callback
+        } else if( info->hasMoved ) {
+            if( info->hasHold ) this->mListener->onDrag( touch_point, sample.id );
+            else                this->mListener->onScroll( touch_point, sample.id );
+        }
+    }
+
+    if( !is_transform_moved ) return;
+    for( int g = 0; g < MAX_TRANSFORMS; ++g ) {
+        if( !this->mTransforms[g].hasMoved ) continue;
+        this->mTransforms[g].hasMoved = false;
+        this->transformHandler( g );
+    }
+}
+
+void NWGestureRecognizer::touchesEnded( const NWTouchSample *samples, int count )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_TOUCHES_ENDED );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_EVENTS );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_SAMPLES, count );
+    if( this->mRecorder ) this->mRecorder->record( NW_TOUCH_ENDED, samples, count );
+
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( !this->mIsMultitapSupported && sample.id ) continue;
+
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        this->setInputTime( sample.time );
+        info->insertHistory( sample );
+        info->hasEnded = true;
+        this->mHasEndedTouches = true;
+
+        // leave transform.
+        if( info->transformGroup >= 0 ) this->removeTransformTouch( this->getSlot( info ) );
+
+        // callback
+        NWPoint touch_point( sample.x, sample.y );
+        // end of drag.
+        if( info->hasHold ) {
+            this->mListener->onDragEnded( touch_point, sample.id );
+
+        // Pinch Action. it was reported by transform.
+        } else if( info->hasTransformed ) {
+            // pass.
+
+        // end of scroll
+        } else if( info->hasMoved ) {
+            // check release velocity
+            float vx, vy;
+            info->velocityTracker.getVelocity( &vx, &vy );
+            float threshold = this->getVelocityThresholdForFlick();
+            int dir_flags = info->getDirection( this->mDistanceThresholdForMoved );
+
+            // is Flick!
+            if( vx * vx + vy * vy > threshold * threshold ) {
+                this->mListener->onFlick( touch_point, sample.id, dir_flags, vx, vy );
+
+            // is Swipe
+            } else {
+                this->mListener->onSwipe( touch_point, sample.id, dir_flags );
+            }
+
+        // end of Tap.
+        } else {
+            this->mListener->onTap( touch_point, sample.id );
+            this->tapEventManager( sample );
+        }
+    }
+    this->releaseEndedTouches();
+}
+
+void NWGestureRecognizer::touchesCancelled( const NWTouchSample *samples, int count )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_TOUCHES_CANCELLED );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_EVENTS );
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_TOUCH_SAMPLES, count );
+    if( this->mRecorder ) this->mRecorder->record( NW_TOUCH_CANCELLED, samples, count );
+
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( !this->mIsMultitapSupported && sample.id ) continue;
+
+        TouchInfo *info = this->findTouchInfo( sample.id );
+        if( !info || info->hasEnded ) continue;
+        this->setInputTime( sample.time );
+        info->insertHistory( sample );
+        this->cancelTouch( info, NWPoint( sample.x, sample.y ) );
+    }
+    this->releaseEndedTouches();
+}
+
+void NWGestureRecognizer::cancelTouch( TouchInfo *info, const NWPoint &touch_point )
+{
+    info->hasEnded = true;
+    this->mHasEndedTouches = true;
+    NWStatsCount( this->mStats, NWGestureStats::COUNT_CANCELLED );
+    this->mListener->onCancelled( touch_point, info->id );
+
+    // transform
+    if( info->transformGroup >= 0 ) this->removeTransformTouch( this->getSlot( info ) );
+}
+
+
+#pragma -mark Timer
+void NWGestureRecognizer::update( NWTime now )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_UPDATE );
+
+    // SingleTap: the expired ones, older first.
+    for( ;; ) {
+        int oldest = -1;
+        for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+            const TapSequence &seq = this->mTapSequences[i];
+            if( seq.id < 0 || now < seq.time + this->mTimeThresholdForDoubleTap ) continue;
+            if( oldest < 0 || seq.time < this->mTapSequences[ oldest ].time ) oldest = i;
+        }
+        if( oldest < 0 ) break;
+        this->singleTapHandler( oldest );
+    }
+    this->holdHandler( now );
+    this->releaseEndedTouches();
+}
+
+// the ended touches no first tap waits on. transforms are left at the end.
+// called at the end of each touches*() and by update(), which fires the
+// waiting first taps, so nothing stays held without a deadline.
+void NWGestureRecognizer::releaseEndedTouches()
+{
+    if( !this->mHasEndedTouches ) return;
+    this->mHasEndedTouches = false;
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[i];
+        if( ti.id == -1 || !ti.hasEnded ) continue;
+
+        bool is_waited = false;
+        for( int t = 0; t < MAX_TAP_SEQUENCES; ++t ) {
+            if( this->mTapSequences[t].id == ti.id ) is_waited = true;
+        }
+        if( is_waited ) this->mHasEndedTouches = true;    // next time.
+        else            ti.release();
+    }
+}
+
+NWTime NWGestureRecognizer::getNextDeadline() const
+{
+    NWTime deadline = -1;
+
+    // SingleTap: the earliest first tap.
+    for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+        const TapSequence &seq = this->mTapSequences[i];
+        if( seq.id < 0 ) continue;
+
+        NWTime tap_time = seq.time + this->mTimeThresholdForDoubleTap;
+        if( deadline < 0 || tap_time < deadline ) deadline = tap_time;
+    }
+
+    // Hold: the earliest candidate.
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        const TouchInfo &ti = this->mTouchInfos[i];
+        if( !this->isHoldCandidate( ti ) ) continue;
+
+        NWTime hold_time = ti.startTime + this->mTimeThresholdForHold;
+        if( deadline < 0 || hold_time < deadline ) deadline = hold_time;
+    }
+    return deadline;
+}
+
+
+#pragma -mark SingeTap or DoubleTap
+void NWGestureRecognizer::singleTapHandler( int index )
+{
+    TapSequence &seq = this->mTapSequences[ index ];
+    NWPoint tap_point = seq.point;
+
+    this->setInputTime( seq.time );
+    seq.id = -1;
+    seq.time = 0;
+    seq.point = NWPoint();
+
+    this->mListener->onSingleTap( tap_point );
+}
+
+// each first tap waits for its own second tap. O(MAX_TAP_SEQUENCES).
+void NWGestureRecognizer::tapEventManager( const NWTouchSample &sample )
+{
+    NWPoint tap_point( sample.x, sample.y );
+
+    // Check Double Tap: the nearest first tap within the time and distance.
+    int found = -1;
+    float found_distance = 0.0f;
+    for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+        const TapSequence &seq = this->mTapSequences[i];
+        if( seq.id < 0 ) continue;
+
+        // check tap interval
+        NWTime interval = sample.time - seq.time;
+        if( interval > this->mTimeThresholdForDoubleTap ) continue;
+
+        // check tap distance.
+        float distance = seq.point.getDistanceSq( tap_point );
+        if( distance > this->mDistanceThresholdForMovedSq ) continue;
+
+        if( found < 0 || distance < found_distance ) {
+            found = i;
+            found_distance = distance;
+        }
+    }
+    if( found >= 0 ) {
+        // finish.
+        TapSequence &seq = this->mTapSequences[ found ];
+        NWPoint first_point = seq.point;
+        seq.id = -1;
+        seq.time = 0;
+        seq.point = NWPoint();
+
+        // DoubleTap! the first tap wasn't SingleTap.
+        if( this->mIsTentativeSingleTap ) this->mListener->onSingleTapRevoked( first_point );
+        this->mListener->onDoubleTap( tap_point );
+        return;
+    }
+
+    // no DoubleTap here. nothing to wait for.
+    if( !this->mListener->isDoubleTapSupport( tap_point ) ) {
+        this->mListener->onSingleTap( tap_point );
+        return;
+    }
+
+    // new tap. pending SingleTap is fired by update().
+    // when all are waiting, the oldest gives up waiting.
+    int index = -1;
+    for( int i = 0; i < MAX_TAP_SEQUENCES; ++i ) {
+        if( this->mTapSequences[i].id < 0 ) {
+            index = i;
+            break;
+        }
+        if( index < 0 || this->mTapSequences[i].time < this->mTapSequences[ index ].time ) index = i;
+    }
+    if( this->mTapSequences[ index ].id >= 0 ) {
+        NWStatsCount( this->mStats, NWGestureStats::COUNT_TAP_EVICTED );
+        this->singleTapHandler( index );
+    }
+
+    TapSequence &seq = this->mTapSequences[ index ];
+    seq.id = sample.id;
+    seq.time = sample.time;
+    seq.point = tap_point;
+    if( this->mIsTentativeSingleTap ) this->mListener->onSingleTapTentative( tap_point );
+}
+
+
+#pragma -mark Hold Action
+// the touch which will be Hold if it stays until the threshold.
+bool NWGestureRecognizer::isHoldCandidate( const TouchInfo &ti ) const
+{
+    if( ti.id == -1 || ti.hasMoved || ti.hasEnded || ti.hasHold ) {
+        return false;
+    }
+    // is pinch ---> not candidate.
+    if( ti.hasTransformed ) return false;
+    return true;
+}
+
+void NWGestureRecognizer::holdHandler( NWTime now )
+{
+    for( int i = 0; i < MAX_TOUCHES; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[i];
+        if( !this->isHoldCandidate( ti ) ) continue;
+
+        NWTime elapsed_time = now - ti.startTime;
+        if( elapsed_time >= this->mTimeThresholdForHold ) {
+            ti.hasHold = true;
+            this->setInputTime( ti.startTime );
+            this->mListener->onHold( ti.lastPoint, ti.id );
+        }
+    }
+}
+
+
+#pragma -mark Pinch Action & Transform
+// the gesture the finger on the point joins. -1 if it starts a new one.
+int NWGestureRecognizer::findTransformGroup( const NWPoint &p ) const
+{
+    int found = -1;
+    float found_distance = 0.0f;
+    for( int g = 0; g < MAX_TRANSFORMS; ++g ) {
+        const TransformGroup &group = this->mTransforms[g];
+        if( group.count == 0 ) continue;
+
+        // squared distance to the nearest finger of the gesture.
+        float distance = -1.0f;
+        for( int i = 0; i < group.count; ++i ) {
+            float d = this->mTouchInfos[ group.slots[i] ].lastPoint.getDistanceSq( p );
+            if( distance < 0.0f || d < distance ) distance = d;
+        }
+        if( found < 0 || distance < found_distance ) {
+            found = g;
+            found_distance = distance;
+        }
+    }
+    if( found >= 0 && this->mDistanceThresholdForGroup > 0.0f &&
+        found_distance > this->mDistanceThresholdForGroupSq ) {
+        // far from all. start a new one if there is room.
+        for( int g = 0; g < MAX_TRANSFORMS; ++g ) {
+            if( this->mTransforms[g].count == 0 ) return -1;
+        }
+    }
+    return found;
+}
+
+void NWGestureRecognizer::addTransformTouch( int slot )
+{
+    TouchInfo &ti = this->mTouchInfos[ slot ];
+    if( ti.transformGroup >= 0 ) return;
+
+    int g = this->findTransformGroup( ti.lastPoint );
+    if( g < 0 ) {
+        for( g = 0; this->mTransforms[g].count > 0; ++g ) {}
+    }
+    TransformGroup &group = this->mTransforms[g];
+
+    // keep the gesture so far, and restart from the new finger set.
+    if( group.count >= 2 ) {
+        group.accumulated = this->getCurrentTransform( g, NULL );
+    } else {
+        group.accumulated = NWTransform();
+    }
+    group.slots[ group.count++ ] = slot;
+    ti.transformGroup = g;
+    this->rebaseTransform( g );
+
+    // start of gesture.
+    if( group.count == 2 ) {
+        for( int i = 0; i < group.count; ++i ) {
+            this->mTouchInfos[ group.slots[i] ].hasTransformed = true;
+        }
+        this->transformHandler( g );
+    } else if( group.count > 2 ) {
+        ti.hasTransformed = true;
+    }
+}
+
+void NWGestureRecognizer::removeTransformTouch( int slot )
+{
+    int g = this->mTouchInfos[ slot ].transformGroup;
+    TransformGroup &group = this->mTransforms[g];
+    NWTransform current = this->getCurrentTransform( g, NULL );
+    bool was_active = group.count >= 2;
+    int id1 = this->mTouchInfos[ group.slots[0] ].id;
+    int id2 = group.count >= 2 ? this->mTouchInfos[ group.slots[1] ].id : -1;
+
+    // keep the order. first two are the ids of PinchAction.
+    int n = 0;
+    for( int i = 0; i < group.count; ++i ) {
+        if( group.slots[i] != slot ) group.slots[ n++ ] = group.slots[i];
+    }
+    group.count = n;
+    this->mTouchInfos[ slot ].transformGroup = -1;
+
+    if( !was_active ) return;
+    if( group.count >= 2 ) {
+        group.accumulated = current;
+        this->rebaseTransform( g );
+        return;
+    }
+
+    // end of gesture.
+    this->transformEndHandler( g, current );
+    this->mListener->onPinchEnded( current.scale, id1, id2 );
+}
+
+// take the current finger positions as the base.
+void NWGestureRecognizer::rebaseTransform( int g )
+{
+    TransformGroup &group = this->mTransforms[g];
+    int n = group.count;
+    if( n == 0 ) return;
+
+    NWPoint centroid;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = this->mTouchInfos[ group.slots[i] ].lastPoint;
+        centroid.x += p.x;
+        centroid.y += p.y;
+    }
+    centroid.x /= n;
+    centroid.y /= n;
+
+    float spread = 0.0f;
+    for( int i = 0; i < n; ++i ) {
+        TouchInfo &ti = this->mTouchInfos[ group.slots[i] ];
+        ti.transformBase = NWPoint( ti.lastPoint.x - centroid.x, ti.lastPoint.y - centroid.y );
+        spread += sqrtf( ti.transformBase.x * ti.transformBase.x +
+                         ti.transformBase.y * ti.transformBase.y );
+    }
+
+    group.baseCentroid = centroid;
+    group.baseSpread = spread / n;
+    group.previousSpread = group.baseSpread;
+}
+
+// O(fingers). rotation is the least squares angle between base and current vectors.
+NWTransform NWGestureRecognizer::getCurrentTransform( int g, float *spread_out ) const
+{
+    const TransformGroup &group = this->mTransforms[g];
+    NWTransform transform = group.accumulated;
+    int n = group.count;
+    transform.touchCount = n;
+    transform.group = g;
+    if( n == 0 ) return transform;
+    transform.firstId = this->mTouchInfos[ group.slots[0] ].id;
+
+    NWPoint centroid;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = this->mTouchInfos[ group.slots[i] ].lastPoint;
+        centroid.x += p.x;
+        centroid.y += p.y;
+    }
+    centroid.x /= n;
+    centroid.y /= n;
+
+    float spread = 0.0f, cross = 0.0f, dot = 0.0f;
+    for( int i = 0; i < n; ++i ) {
+        const TouchInfo &ti = this->mTouchInfos[ group.slots[i] ];
+        float cx = ti.lastPoint.x - centroid.x;
+        float cy = ti.lastPoint.y - centroid.y;
+        spread += sqrtf( cx * cx + cy * cy );
+        cross += ti.transformBase.x * cy - ti.transformBase.y * cx;
+        dot   += ti.transformBase.x * cx + ti.transformBase.y * cy;
+    }
+    spread /= n;
+    if( spread_out ) *spread_out = spread;
+
+    if( group.baseSpread > 0.0f ) transform.scale *= spread / group.baseSpread;
+    if( cross != 0.0f || dot != 0.0f ) transform.rotation += atan2f( cross, dot );
+    transform.translation.x += centroid.x - group.baseCentroid.x;
+    transform.translation.y += centroid.y - group.baseCentroid.y;
+    transform.centroid = centroid;
+    return transform;
+}
+
+// callback a frame of the gesture.
+void NWGestureRecognizer::transformHandler( int g )
+{
+    NWStatsScope scope( this->mStats, NWGestureStats::STAGE_TRANSFORM );
+    TransformGroup &group = this->mTransforms[g];
+    float spread = 0.0f;
+    NWTransform transform = this->getCurrentTransform( g, &spread );
+    int id1 = this->mTouchInfos[ group.slots[0] ].id;
+    int id2 = this->mTouchInfos[ group.slots[1] ].id;
+
+    this->mListener->onTransform( transform );
+    this->mListener->onPinchAction( transform.scale, id1, id2 );
+    if( spread < group.previousSpread ) {
+        this->mListener->onPinchIn( transform.scale, id1, id2 );
+    } else {
+        this->mListener->onPinchOut( transform.scale, id1, id2 );
+    }
+    group.previousSpread = spread;
+}
+
+void NWGestureRecognizer::transformEndHandler( int g, const NWTransform &transform )
+{
+    this->mTransforms[g].accumulated = NWTransform();
+    this->rebaseTransform( g );      // the rest finger.
+    this->mListener->onTransformEnded( transform );
+}
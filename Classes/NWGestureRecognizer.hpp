@@ -0,0 +1,751 @@
+//
+//  NWGestureRecognizer.hpp
+//  NoviceWorks
+//
+//  Engine independent part of NWGestureLayer.
+//
+//
+
+#ifndef __NWGestureRecognizer__
+#define __NWGestureRecognizer__
+
+#include <vector>
+
+#include "NWGestureClock.hpp"
+#include "NWTouchFilter.hpp"
+#include "NWVelocityTracker.hpp"
+
+// Capacity of the touch slot table: touches down at once.
+#ifndef NW_GESTURE_MAX_TOUCHES
+#define NW_GESTURE_MAX_TOUCHES  10
+#endif
+
+// Initial capacity of the touch history of each slot (unlimited policy).
+#ifndef NW_GESTURE_HISTORY_RESERVE
+#define NW_GESTURE_HISTORY_RESERVE  128
+#endif
+
+// Max taps waiting for the second tap (SingleTap or DoubleTap) at once.
+#ifndef NW_GESTURE_MAX_TAP_SEQUENCES
+#define NW_GESTURE_MAX_TAP_SEQUENCES    4
+#endif
+
+// Max multi-touch gestures (PinchAction & Transform) at once.
+#ifndef NW_GESTURE_MAX_TRANSFORMS
+#define NW_GESTURE_MAX_TRANSFORMS   4
+#endif
+
+// Recognition on its own thread (NWGestureThread). needs C++11 atomics & threads.
+#ifndef NW_GESTURE_THREADED
+#define NW_GESTURE_THREADED 0
+#endif
+
+// Latency & cost histograms (NWGestureStats). 0 compiles the hooks out.
+#ifndef NW_GESTURE_STATS
+#define NW_GESTURE_STATS 0
+#endif
+
+/**
+ *  @struct NWPoint
+ *  @brief  Plain 2D point. same layout as cocos2d::CCPoint's x, y.
+ */
+struct NWPoint
+{
+    float x;
+    float y;
+
+    NWPoint() : x( 0.0f ), y( 0.0f ) {}
+    NWPoint( float px, float py ) : x( px ), y( py ) {}
+
+    float getDistance( const NWPoint &other ) const;
+
+    // for comparing with a squared threshold without sqrt.
+    float getDistanceSq( const NWPoint &other ) const {
+        float dx = other.x - this->x;
+        float dy = other.y - this->y;
+        return dx * dx + dy * dy;
+    }
+};
+
+/**
+ *  @struct NWRect
+ *  @brief  Plain rectangle. origin is the bottom-left.
+ */
+struct NWRect
+{
+    float x;
+    float y;
+    float width;
+    float height;
+
+    NWRect() : x( 0.0f ), y( 0.0f ), width( 0.0f ), height( 0.0f ) {}
+    NWRect( float px, float py, float w, float h ) :
+        x( px ), y( py ), width( w ), height( h ) {}
+};
+
+/**
+ *  @struct NWTouchSample
+ *  @brief  One touch of the touch event.
+ *          Fed to NWGestureRecognizer instead of cocos2d::CCTouch.
+ */
+struct NWTouchSample
+{
+    int     id;
+    float   x;
+    float   y;
+    NWTime  time;       // nanosec. when the finger touched, if platform knows.
+};
+
+
+/**
+ *  @struct NWTransform
+ *  @brief  Combined move of the fingers of a multi-touch gesture.
+ *          all values are from the start of the gesture.
+ */
+struct NWTransform
+{
+    NWPoint centroid;       // current center of the fingers.
+    NWPoint translation;    // move of the center.
+    float   scale;          // ratio of the mean distance from the center.
+    float   rotation;       // radian. counterclockwise is positive.
+    int     touchCount;
+    int     firstId;        // id of the first finger on. -1 if none.
+    int     group;          // which gesture. same until it ends. -1 if none.
+
+    NWTransform() : scale( 1.0f ), rotation( 0.0f ), touchCount( 0 ), firstId( -1 ), group( -1 ) {}
+};
+
+/**
+ *  @enum   NWTouchPhase
+ *  @brief  Kind of the touch event.
+ */
+enum NWTouchPhase {
+    NW_TOUCH_BEGAN = 0,
+    NW_TOUCH_MOVED,
+    NW_TOUCH_ENDED,
+    NW_TOUCH_CANCELLED,
+};
+
+class NWGestureEventQueue;
+class NWGestureStats;
+class NWGestureStatsListener;
+
+/**
+ *  @class  NWTouchRecorder
+ *  @brief  Receiver of the raw touch events fed to NWGestureRecognizer.
+ *          see NWTouchTraceWriter.
+ */
+class NWTouchRecorder
+{
+public:
+    virtual ~NWTouchRecorder() {}
+    virtual void record( NWTouchPhase phase, const NWTouchSample *samples, int count ) = 0;
+};
+
+
+/**
+ *  @struct NWHistoryPolicy
+ *  @brief  How much of the touch path is kept in NWTouchHistory.
+ *
+ *  a sample is kept only if it moved more than minDistance or
+ *  came more than minInterval later than the previous kept sample.
+ *  the latest sample is always kept.
+ */
+struct NWHistoryPolicy
+{
+    int     capacity;       // max samples. oldest is dropped. 0: unlimited.
+    float   minDistance;    // px. 0: off.
+    double  minInterval;    // sec. 0: off.
+
+    NWHistoryPolicy() : capacity( 0 ), minDistance( 0.0f ), minInterval( 0.0 ) {}
+    NWHistoryPolicy( int cap, float distance, double interval ) :
+        capacity( cap ), minDistance( distance ), minInterval( interval ) {}
+};
+
+/**
+ *  @class  NWTouchHistory
+ *  @brief  Ring buffer of the touch path. index 0 is the oldest kept sample.
+ *
+ *  total distance is counted on every sample (include dropped ones),
+ *  so it's exact regardless of the policy.
+ *  x and y are stored in separate arrays; copyTo() gives them to the
+ *  kernels of NWGeometry.hpp.
+ */
+class NWTouchHistory
+{
+public:
+    NWTouchHistory();
+
+    /**
+     *  Set the policy. the history is cleared.
+     */
+    void setPolicy( const NWHistoryPolicy &policy );
+    const NWHistoryPolicy& getPolicy() const {
+        return this->mPolicy;
+    }
+
+    void clear();
+    void push( const NWPoint &point, NWTime time );
+
+    /**
+     *  Clear, and give back the buffer grown over the capacity of the policy.
+     */
+    void release();
+
+    int size() const            { return this->mSize; }
+    bool empty() const          { return this->mSize == 0; }
+    NWPoint operator[]( int i ) const {
+        int index = this->toIndex( i );
+        return NWPoint( this->mXs[ index ], this->mYs[ index ] );
+    }
+    NWTime getTime( int i ) const {
+        return this->mTimes[ this->toIndex( i ) ];
+    }
+    NWPoint front() const   { return (*this)[0]; }
+    NWPoint back() const    { return (*this)[ this->mSize - 1 ]; }
+
+    /**
+     *  Copy the kept samples oldest first, as structure of arrays.
+     *  @param  xs, ys  size() floats each.
+     *  @return size().
+     */
+    int copyTo( float *xs, float *ys ) const;
+
+    /**
+     *  Get total move distance of all pushed samples. O(1).
+     */
+    float getTotalDistance() const {
+        return this->mTotalDistance;
+    }
+
+private:
+    NWHistoryPolicy         mPolicy;
+    std::vector<float>      mXs;
+    std::vector<float>      mYs;
+    std::vector<NWTime>     mTimes;
+    NWTime  mMinInterval;
+    int     mHead;
+    int     mSize;
+    float   mTotalDistance;
+
+    int toIndex( int i ) const {
+        int index = this->mHead + i;
+        int cap = this->mXs.size();
+        return index < cap ? index : index - cap;
+    }
+    int getReserve() const;
+    bool isTailKept() const;
+    void grow();
+};
+
+
+/**
+ *  @class  NWGestureListener
+ *  @brief  Receiver of the gestures detected by NWGestureRecognizer.
+ *          according to your necessity override those callback func.
+ */
+class NWGestureListener
+{
+public:
+    virtual ~NWGestureListener() {}
+
+    virtual void onSingleTap( const NWPoint &touchPoint ) {}
+    virtual void onDoubleTap( const NWPoint &touchPoint ) {}
+
+    /**
+     *  Whether a tap on the point may be the first of DoubleTap.
+     *  return false where DoubleTap isn't used, and SingleTap comes at once
+     *  instead of after TimeThresholdForDoubleTap.
+     */
+    virtual bool isDoubleTapSupport( const NWPoint &touchPoint ) { return true; }
+
+    // with NWGestureRecognizer::setTentativeSingleTap( true ): the first tap
+    // comes at once as tentative, then onSingleTap confirms it, or
+    // onSingleTapRevoked (right before onDoubleTap) takes it back.
+    virtual void onSingleTapTentative( const NWPoint &touchPoint ) {}
+    virtual void onSingleTapRevoked( const NWPoint &touchPoint ) {}
+
+    virtual void onDown( const NWPoint &touchPoint, int id ) {}
+    virtual void onHold( const NWPoint &touchPoint, int id ) {}
+    virtual void onTap( const NWPoint &touchPoint, int id ) {}
+    virtual void onCancelled( const NWPoint &touchPoint, int id ) {}
+
+    virtual void onScroll( const NWPoint &touchPoint, int id ) {}
+    virtual void onFlick( const NWPoint &touchPoint, int id, int direction ) {}
+    /**
+     *  Flick with the release velocity (px/sec).
+     *  default calls onFlick() without velocity.
+     */
+    virtual void onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy ) {
+        this->onFlick( touchPoint, id, direction );
+    }
+    virtual void onSwipe( const NWPoint &touchPoint, int id, int direction ) {}
+    virtual void onDrag( const NWPoint &touchPoint, int id ) {}
+    virtual void onDragEnded( const NWPoint &touchPoint, int id ) {}
+
+    virtual void onPinchIn( float magnification, int id1, int id2 ) {}
+    virtual void onPinchOut( float magnification, int id1, int id2 ) {}
+    virtual void onPinchAction( float magnification, int id1, int id2 ) {}
+    virtual void onPinchEnded( float magnification, int id1, int id2 ) {}
+
+    // a frame of the multi-touch gesture (two or more fingers).
+    // Pinch* of the same gesture is called right after onTransform*.
+    virtual void onTransform( const NWTransform &transform ) {}
+    virtual void onTransformEnded( const NWTransform &transform ) {}
+};
+
+
+/**
+ *  @class  NWGestureRecognizer
+ *  @brief  Gesture detection logic without cocos2d-x.
+ *
+ *  Takes plain touch samples (id, x, y, time) and emits the gestures
+ *  to NWGestureListener. It has no timer of its own, so the owner must call
+ *  update() when the time of getNextDeadline() comes.
+ */
+class NWGestureRecognizer
+{
+public:
+    //////////////////////////////////////////////////////////////////////
+    // Enum Type
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  @enum   Direction
+     *  @brief  Define the directions. used by flick functions.
+     */
+    enum Direction {
+        UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8,
+    };
+
+    /**
+     *  Number of touch slots. any id (0 or more) gets a slot while one is free;
+     *  a touch put down while all slots are down is ignored.
+     */
+    static const int MAX_TOUCHES = NW_GESTURE_MAX_TOUCHES;
+
+    /**
+     *  Number of the taps waiting for the second tap at once.
+     *  when it's full, the oldest one is fired as SingleTap at once.
+     */
+    static const int MAX_TAP_SEQUENCES = NW_GESTURE_MAX_TAP_SEQUENCES;
+
+    /**
+     *  Number of the multi-touch gestures at once. see NWTransform::group.
+     */
+    static const int MAX_TRANSFORMS = NW_GESTURE_MAX_TRANSFORMS;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // NWGestureRecognizer Methods.
+    //////////////////////////////////////////////////////////////////////
+    NWGestureRecognizer();
+    ~NWGestureRecognizer();
+
+    /**
+     *  Set the receiver of gestures. NULL discards all gestures.
+     *  @warning listener isn't retained.
+     */
+    void setListener( NWGestureListener *listener );
+    NWGestureListener* getListener();
+
+    // Touch events.
+    void touchesBegan( const NWTouchSample *samples, int count );
+    void touchesMoved( const NWTouchSample *samples, int count );
+    void touchesEnded( const NWTouchSample *samples, int count );
+    void touchesCancelled( const NWTouchSample *samples, int count );
+    void touches( NWTouchPhase phase, const NWTouchSample *samples, int count );
+
+    /**
+     *  Set the recorder of the raw touch events. NULL stops recording.
+     *  @warning recorder isn't retained.
+     */
+    void setTouchRecorder( NWTouchRecorder *recorder ) {
+        this->mRecorder = recorder;
+    }
+    NWTouchRecorder* getTouchRecorder() const {
+        return this->mRecorder;
+    }
+
+    /**
+     *  Set the time source. NULL is the platform monotonic clock.
+     *  NWTouchSample::time must be on the same clock.
+     *  @warning clock isn't retained.
+     */
+    void setClock( NWClock *clock );
+    NWClock* getClock() const {
+        return this->mClock;
+    }
+
+    /**
+     *  Set where the latency and the time of the stages are recorded. NULL stops recording.
+     *  recorded only when built with NW_GESTURE_STATS=1.
+     *  @warning stats isn't retained.
+     */
+    void setStats( NWGestureStats *stats );
+    NWGestureStats* getStats() const {
+        return this->mStats;
+    }
+
+    /**
+     *  Leave the latency of the stats to the reader of queue, the listener
+     *  drained on the other thread (NWGestureThread). its events get the time
+     *  of their touch sample (NWGestureEvent::inputTime), and the reader
+     *  records the latency when it takes them. NULL: recorded at the callback.
+     *  @warning queue isn't retained.
+     */
+    void setLatencyQueue( NWGestureEventQueue *queue );
+
+    /**
+     *  Fire the timed gestures (SingleTap, Hold) whose time has come.
+     *  @param  now     nanosec. same clock as NWTouchSample::time.
+     */
+    void update( NWTime now );
+    void update() {
+        this->update( this->mClock->now() );
+    }
+
+    /**
+     *  Set how much of the touch path is kept.
+     *  @warning Don't call while touches are active.
+     */
+    void setHistoryPolicy( const NWHistoryPolicy &policy );
+    const NWHistoryPolicy& getHistoryPolicy() const {
+        return this->mHistoryPolicy;
+    }
+
+    /**
+     *  Set the smoothing and the prediction of getSmoothedPoint() and
+     *  getPredictedPoint(). the gestures keep using the raw points.
+     *  @warning Don't call while touches are active.
+     */
+    void setFilterPolicy( const NWFilterPolicy &policy );
+    const NWFilterPolicy& getFilterPolicy() const {
+        return this->mFilterPolicy;
+    }
+
+    /**
+     *  Get the time that update() should be called next.
+     *  changes on touch events, so check it again after each of them.
+     *  @return nanosec, or negative value if there is nothing to wait.
+     */
+    NWTime getNextDeadline() const;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Accessor
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Set whether to support the Multi-tap.
+     *  if not supported, touches except for id 0 are ignored.
+     */
+    void setMulitapSupport( bool is_supported ) {
+        this->mIsMultitapSupported = is_supported;
+    }
+    bool isMultitapSupport() const {
+        return this->mIsMultitapSupported;
+    }
+
+    /**
+     *  Set whether to support the PinchAction (and Transform).
+     *  every finger put down joins a gesture (see DistanceThresholdForGroup),
+     *  and it continues while two or more fingers are down.
+     */
+    void setPinchActionSupport( bool is_supported ) {
+        this->mIsPinchActionSupported = is_supported;
+    }
+    bool isPinchActionSupport() const {
+        return this->mIsPinchActionSupported;
+    }
+
+    /**
+     *  Set the Base distance for determine moved or not.
+     */
+    void setDistanceThresholdForMoved( float distance ) {
+        this->mDistanceThresholdForMoved = distance;
+        this->mDistanceThresholdForMovedSq = distance * distance;
+    }
+    float getDistanceThresholdForMoved() const {
+        return this->mDistanceThresholdForMoved;
+    }
+
+    /**
+     *  Set the distance to group the fingers into one multi-touch gesture.
+     *  a finger put down joins the gesture which has a finger within this
+     *  distance (the nearest one), or starts a new gesture.
+     *  so several players can pinch at once on a big screen.
+     *  @param  distance    px. 0: all fingers are one gesture.
+     */
+    void setDistanceThresholdForGroup( float distance ) {
+        this->mDistanceThresholdForGroup = distance;
+        this->mDistanceThresholdForGroupSq = distance * distance;
+    }
+    float getDistanceThresholdForGroup() const {
+        return this->mDistanceThresholdForGroup;
+    }
+
+    /**
+     *  Set whether to deliver the first tap at once as onSingleTapTentative,
+     *  for instant feedback while waiting for the second tap.
+     *  onSingleTap or onSingleTapRevoked follows it. default false.
+     */
+    void setTentativeSingleTap( bool is_tentative ) {
+        this->mIsTentativeSingleTap = is_tentative;
+    }
+    bool isTentativeSingleTap() const {
+        return this->mIsTentativeSingleTap;
+    }
+
+    /**
+     *  Set time threshold for determining Single-tap or Double-tap.
+     *  the second tap must be within DistanceThresholdForMoved of the first.
+     *  taps far from each other are separate, even by the same finger id.
+     *  @param  time    sec.
+     */
+    void setTimeThresholdForDoubleTap( double time ) {
+        this->mTimeThresholdForDoubleTap = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForDoubleTap() const {
+        return NWTimeToSec( this->mTimeThresholdForDoubleTap );
+    }
+
+    /**
+     *  Set time threshold for detecting the Hold.
+     *  @param  time    sec.
+     */
+    void setTimeThresholdForHold( double time ) {
+        this->mTimeThresholdForHold = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForHold() const {
+        return NWTimeToSec( this->mTimeThresholdForHold );
+    }
+
+    /**
+     *  Set time threshold for decide whether Flick or Swipe.
+     *  used only for the default of VelocityThresholdForFlick.
+     *  @param  time    sec
+     */
+    void setTimeThresholdForFlick( double time ) {
+        this->mTimeThresholdForFlick = NWTimeFromSec( time );
+    }
+    double getTimeThresholdForFlick() const {
+        return NWTimeToSec( this->mTimeThresholdForFlick );
+    }
+
+    /**
+     *  Set release velocity threshold for decide whether Flick or Swipe.
+     *  if the touch is released faster than this, it's Flick.
+     *  @param  velocity    px/sec. 0 means
+     *                      DistanceThresholdForMoved / TimeThresholdForFlick.
+     */
+    void setVelocityThresholdForFlick( float velocity ) {
+        this->mVelocityThresholdForFlick = velocity;
+    }
+    float getVelocityThresholdForFlick() const;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Get touch infomation.
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Get tap path.
+     *  @return NULL if there is no touch of id.
+     *  @warning an ended touch is released when its ending callback returns,
+     *           or, if it's a first tap waiting for DoubleTap, when the wait ends.
+     */
+    const NWTouchHistory* getTouchHistory( int id ) const;
+
+    /**
+     *  Get the slot of the touch, 0 to MAX_TOUCHES - 1. O(1) mostly.
+     *  the touches down at once never share a slot.
+     *  @return -1 if there is no touch of id.
+     */
+    int getTouchSlot( int id ) const;
+
+    /**
+     *  Get total move distance of tap. O(1).
+     */
+    float getTotalDistance( int id ) const;
+
+    /**
+     *  Get direction of move from start ponit to end point. O(1).
+     *  @return Direction of between touch start to end.
+     */
+    int getDirection( int id ) const;
+
+    /**
+     *  Get the bounding box of all points the touch passed. O(1).
+     */
+    NWRect getBoundingBox( int id ) const;
+
+    /**
+     *  Get the vector from start point to the latest point. O(1).
+     */
+    NWPoint getNetDisplacement( int id ) const;
+
+    /**
+     *  Get the velocity of the touch at its latest sample.
+     *  least squares over the recent samples. O(NWVelocityTracker::SAMPLES).
+     *  @return px/sec.
+     */
+    NWPoint getVelocity( int id ) const;
+
+    /**
+     *  Get the latest point of the touch smoothed by NWFilterPolicy. O(1).
+     *  the raw latest point if the filter is off.
+     */
+    NWPoint getSmoothedPoint( int id ) const;
+
+    /**
+     *  Get where the touch will be after NWFilterPolicy::predictionTime:
+     *  the smoothed point moved by getVelocity(). O(NWVelocityTracker::SAMPLES).
+     */
+    NWPoint getPredictedPoint( int id ) const;
+
+    /**
+     *  Get the multi-touch gesture the touch is a finger of (NWTransform::group). O(1).
+     *  the gesture is running only while it has 2 fingers or more.
+     *  @return -1 if none, or no touch of id.
+     */
+    int getTransformGroup( int id ) const;
+
+
+private:
+    //////////////////////////////////////////////////////////////////////
+    // TouchInfo
+    //   preallocated slots. a touch takes the slot of its id if the id is
+    //   small and the slot isn't down, or another one; ended touches are
+    //   released at the end of touches*(), or by update() after the DoubleTap
+    //   wait. history buffer is kept between touches, so a
+    //   touch doesn't allocate until it outgrows the buffer, and a grown
+    //   buffer is given back when its slot is released or reused.
+    //////////////////////////////////////////////////////////////////////
+    struct TouchInfo {
+        int     id;             // -1: unused.
+        NWTime  startTime;
+        bool    hasMoved;
+        bool    hasHold;
+        bool    hasEnded;
+        NWTouchHistory touchHistory;
+        NWVelocityTracker velocityTracker;
+        NWTouchFilter touchFilter;
+
+        // running values. updated by insertHistory().
+        NWPoint startPoint;     // history may drop it.
+        NWPoint lastPoint;
+        float   minX, minY, maxX, maxY;
+
+        // Transform
+        bool    hasTransformed;     // was a part of the multi-touch gesture.
+        int     transformGroup;     // index of mTransforms. -1: none.
+        NWPoint transformBase;      // vector from the base centroid.
+
+        TouchInfo();
+        void reset( const NWTouchSample &sample );
+        void release();
+        void insertHistory( const NWTouchSample &sample );
+        float getTotalDistance() const;
+        int getDirection( float correction_val ) const;
+        NWRect getBoundingBox() const;
+        NWPoint getNetDisplacement() const;
+    };
+
+    TouchInfo* findTouchInfo( int id );
+    const TouchInfo* findTouchInfo( int id ) const;
+    TouchInfo* allocateTouchInfo( int id );
+    int getSlot( const TouchInfo *info ) const {
+        return static_cast<int>( info - this->mTouchInfos );
+    }
+    void releaseEndedTouches();
+
+    // end the touch by onCancelled, and leave its transform.
+    void cancelTouch( TouchInfo *info, const NWPoint &touch_point );
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Config Parameter
+    //////////////////////////////////////////////////////////////////////
+    // Common
+    float   mDistanceThresholdForMoved;
+    float   mDistanceThresholdForGroup;
+    float   mDistanceThresholdForMovedSq;   // compared with squared distances.
+    float   mDistanceThresholdForGroupSq;
+    bool    mIsMultitapSupported;
+    bool    mIsPinchActionSupported;
+
+    // SingleTap & DoubleTap
+    NWTime  mTimeThresholdForDoubleTap;
+    bool    mIsTentativeSingleTap;
+
+    // Hold & Drag
+    NWTime  mTimeThresholdForHold;
+
+    // Flick
+    NWTime  mTimeThresholdForFlick;
+    float   mVelocityThresholdForFlick;
+
+    // History
+    NWHistoryPolicy mHistoryPolicy;
+    NWFilterPolicy  mFilterPolicy;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Private Attribute and Functions.
+    //////////////////////////////////////////////////////////////////////
+    NWGestureListener *mListener;
+    NWClock *mClock;
+    NWTouchRecorder *mRecorder;
+    NWGestureStats *mStats;
+    NWGestureEventQueue *mLatencyQueue;
+#if NW_GESTURE_STATS
+    NWGestureStatsListener *mStatsListener;     // in front of the listener while mStats is set.
+#endif
+    TouchInfo mTouchInfos[MAX_TOUCHES];     // index is the slot, not the touch id.
+    bool    mHasEndedTouches;               // update() has slots to release.
+
+    // SingleTap & DoubleTap: first taps waiting for the second.
+    struct TapSequence {
+        int     id;             // -1: unused.
+        NWTime  time;
+        NWPoint point;
+    };
+    TapSequence mTapSequences[ MAX_TAP_SEQUENCES ];
+
+    // the touch the next callbacks come from. for the latency of the stats.
+    void setInputTime( NWTime time );
+
+    void tapEventManager( const NWTouchSample &sample );
+    void singleTapHandler( int index );
+
+    // Hold & Drag
+    bool isHoldCandidate( const TouchInfo &ti ) const;
+    void holdHandler( NWTime now );
+
+    // PinchAction & Transform: fingers grouped into gestures.
+    struct TransformGroup {
+        int     slots[ MAX_TOUCHES ];   // fingers of the gesture. 0 fingers: unused.
+        int     count;
+        bool    hasMoved;               // in this touch event.
+        NWPoint baseCentroid;
+        float   baseSpread;
+        float   previousSpread;
+        NWTransform accumulated;        // until the last rebase.
+
+        TransformGroup() : count( 0 ), hasMoved( false ), baseSpread( 0.0f ), previousSpread( 0.0f ) {}
+    };
+    TransformGroup mTransforms[ MAX_TRANSFORMS ];
+
+    int findTransformGroup( const NWPoint &p ) const;
+    void addTransformTouch( int slot );
+    void removeTransformTouch( int slot );
+    void rebaseTransform( int group );
+    NWTransform getCurrentTransform( int group, float *spread ) const;
+    void transformHandler( int group );
+    void transformEndHandler( int group, const NWTransform &transform );
+
+    // noncopyable
+    NWGestureRecognizer( const NWGestureRecognizer& );
+    NWGestureRecognizer& operator=( const NWGestureRecognizer& );
+};
+
+
+#endif /* defined(__NWGestureRecognizer__) */
@@ -0,0 +1,383 @@
+//
+//  NWGestureRouter.cpp
+//  NoviceWorks
+//
+//  Deliver each gesture to the target under the finger.
+//
+//
+
+// std
+#include <cmath>
+
+// myclass
+#include "NWGestureRouter.hpp"
+
+
+namespace {
+
+NWGestureListener sNullListener;
+
+bool containsPoint( const NWRect &rect, const NWPoint &p )
+{
+    return p.x >= rect.x && p.x <= rect.x + rect.width &&
+           p.y >= rect.y && p.y <= rect.y + rect.height;
+}
+
+}   // unnamed namespace
+
+
+#pragma -mark Class Basic Method.
+NWGestureRouter::NWGestureRouter() :
+  mTargetCount( 0 )
+, mTargetOrder( 0 )
+, mBounds()
+, mCellSize( 0.0f )
+, mColumns( 0 )
+, mRows( 0 )
+, mOwnerCount( 0 )
+, mOwnerOrder( 0 )
+, mPinchOwner( -1 )
+, mFallback( NULL )
+{
+    for( int i = 0; i < NWGestureRecognizer::MAX_TRANSFORMS; ++i ) {
+        this->mIsTransforming[i] = false;
+        this->mTransformOwners[i] = -1;
+    }
+    this->setBounds( NWRect( 0.0f, 0.0f, 1024.0f, 1024.0f ), 64.0f );
+}
+
+NWGestureRouter::~NWGestureRouter()
+{
+}
+
+void NWGestureRouter::setBounds( const NWRect &bounds, float cell_size )
+{
+    this->mBounds = bounds;
+    this->mCellSize = cell_size > 1.0f ? cell_size : 1.0f;
+    this->mColumns = static_cast<int>( ceilf( bounds.width / this->mCellSize ) );
+    this->mRows = static_cast<int>( ceilf( bounds.height / this->mCellSize ) );
+    if( this->mColumns < 1 ) this->mColumns = 1;
+    if( this->mRows < 1 ) this->mRows = 1;
+
+    this->mCells.clear();
+    this->mCells.resize( this->mColumns * this->mRows );
+    for( int i = 0; i < static_cast<int>( this->mTargets.size() ); ++i ) {
+        if( this->mTargets[i].isUsed ) this->insertCells( i );
+    }
+}
+
+
+#pragma -mark Target
+int NWGestureRouter::addTarget( const NWRect &rect, NWGestureListener *listener,
+                                unsigned int mask, int priority )
+{
+    int handle;
+    if( !this->mFreeTargets.empty() ) {
+        handle = this->mFreeTargets.back();
+        this->mFreeTargets.pop_back();
+    } else {
+        handle = static_cast<int>( this->mTargets.size() );
+        this->mTargets.push_back( Target() );
+    }
+
+    Target &target = this->mTargets[ handle ];
+    target.rect      = rect;
+    target.listener  = listener;
+    target.mask      = mask;
+    target.priority  = priority;
+    target.order     = this->mTargetOrder++;
+    target.isUsed    = true;
+    target.isEnabled = true;
+    this->insertCells( handle );
+    ++this->mTargetCount;
+    return handle;
+}
+
+void NWGestureRouter::removeTarget( int handle )
+{
+    if( !this->isTarget( handle ) ) return;
+
+    this->removeCells( handle );
+    this->mTargets[ handle ].isUsed = false;
+    this->mTargets[ handle ].listener = NULL;
+    this->mFreeTargets.push_back( handle );
+    --this->mTargetCount;
+
+    // its touches go to the fallback from now on.
+    for( int i = 0; i < this->mOwnerCount; ++i ) {
+        if( this->mOwners[i].target == handle ) this->mOwners[i].target = -1;
+    }
+    for( int i = 0; i < NWGestureRecognizer::MAX_TRANSFORMS; ++i ) {
+        if( this->mTransformOwners[i] == handle ) this->mTransformOwners[i] = -1;
+    }
+    if( this->mPinchOwner == handle ) this->mPinchOwner = -1;
+}
+
+void NWGestureRouter::removeAllTargets()
+{
+    this->mTargets.clear();
+    this->mFreeTargets.clear();
+    this->mTargetCount = 0;
+    for( int i = 0; i < static_cast<int>( this->mCells.size() ); ++i ) this->mCells[i].clear();
+    for( int i = 0; i < this->mOwnerCount; ++i ) this->mOwners[i].target = -1;
+    for( int i = 0; i < NWGestureRecognizer::MAX_TRANSFORMS; ++i ) this->mTransformOwners[i] = -1;
+    this->mPinchOwner = -1;
+}
+
+// only the cells it leaves and enters are touched.
+void NWGestureRouter::setTargetRect( int handle, const NWRect &rect )
+{
+    if( !this->isTarget( handle ) ) return;
+    Target &target = this->mTargets[ handle ];
+    int x0 = this->cellX( rect.x ), x1 = this->cellX( rect.x + rect.width );
+    int y0 = this->cellY( rect.y ), y1 = this->cellY( rect.y + rect.height );
+    if( x0 == target.cellX0 && x1 == target.cellX1 && y0 == target.cellY0 && y1 == target.cellY1 ) {
+        target.rect = rect;
+        return;
+    }
+
+    // remove from the cells out of the new range.
+    for( int y = target.cellY0; y <= target.cellY1; ++y ) {
+        for( int x = target.cellX0; x <= target.cellX1; ++x ) {
+            if( x >= x0 && x <= x1 && y >= y0 && y <= y1 ) continue;
+            std::vector<int> &cell = this->mCells[ y * this->mColumns + x ];
+            for( int i = 0; i < static_cast<int>( cell.size() ); ++i ) {
+                if( cell[i] != handle ) continue;
+                cell[i] = cell.back();
+                cell.pop_back();
+                break;
+            }
+        }
+    }
+    // add to the cells out of the old range.
+    for( int y = y0; y <= y1; ++y ) {
+        for( int x = x0; x <= x1; ++x ) {
+            if( x >= target.cellX0 && x <= target.cellX1 &&
+                y >= target.cellY0 && y <= target.cellY1 ) continue;
+            this->mCells[ y * this->mColumns + x ].push_back( handle );
+        }
+    }
+    target.rect = rect;
+    target.cellX0 = x0;
+    target.cellX1 = x1;
+    target.cellY0 = y0;
+    target.cellY1 = y1;
+}
+
+const NWRect& NWGestureRouter::getTargetRect( int handle ) const
+{
+    static const NWRect kNoRect;
+    return this->isTarget( handle ) ? this->mTargets[ handle ].rect : kNoRect;
+}
+
+void NWGestureRouter::setTargetMask( int handle, unsigned int mask )
+{
+    if( this->isTarget( handle ) ) this->mTargets[ handle ].mask = mask;
+}
+
+void NWGestureRouter::setTargetEnabled( int handle, bool is_enabled )
+{
+    if( this->isTarget( handle ) ) this->mTargets[ handle ].isEnabled = is_enabled;
+}
+
+int NWGestureRouter::findTarget( const NWPoint &p ) const
+{
+    const std::vector<int> &cell = this->mCells[ this->cellY( p.y ) * this->mColumns + this->cellX( p.x ) ];
+    int found = -1;
+    for( int i = 0; i < static_cast<int>( cell.size() ); ++i ) {
+        const Target &target = this->mTargets[ cell[i] ];
+        if( !target.isUsed || !target.isEnabled || !containsPoint( target.rect, p ) ) continue;
+        if( found >= 0 ) {
+            const Target &best = this->mTargets[ found ];
+            if( target.priority < best.priority ) continue;
+            if( target.priority == best.priority && target.order < best.order ) continue;
+        }
+        found = cell[i];
+    }
+    return found;
+}
+
+int NWGestureRouter::getOwner( int id ) const
+{
+    for( int i = 0; i < this->mOwnerCount; ++i ) {
+        if( this->mOwners[i].id == id ) return this->mOwners[i].target;
+    }
+    return -1;
+}
+
+
+#pragma -mark Grid
+// out of the bounds is clamped to the border cells.
+int NWGestureRouter::cellX( float x ) const
+{
+    int cx = static_cast<int>( floorf( ( x - this->mBounds.x ) / this->mCellSize ) );
+    return cx < 0 ? 0 : cx >= this->mColumns ? this->mColumns - 1 : cx;
+}
+
+int NWGestureRouter::cellY( float y ) const
+{
+    int cy = static_cast<int>( floorf( ( y - this->mBounds.y ) / this->mCellSize ) );
+    return cy < 0 ? 0 : cy >= this->mRows ? this->mRows - 1 : cy;
+}
+
+void NWGestureRouter::insertCells( int handle )
+{
+    Target &target = this->mTargets[ handle ];
+    target.cellX0 = this->cellX( target.rect.x );
+    target.cellX1 = this->cellX( target.rect.x + target.rect.width );
+    target.cellY0 = this->cellY( target.rect.y );
+    target.cellY1 = this->cellY( target.rect.y + target.rect.height );
+    for( int y = target.cellY0; y <= target.cellY1; ++y ) {
+        for( int x = target.cellX0; x <= target.cellX1; ++x ) {
+            this->mCells[ y * this->mColumns + x ].push_back( handle );
+        }
+    }
+}
+
+void NWGestureRouter::removeCells( int handle )
+{
+    const Target &target = this->mTargets[ handle ];
+    for( int y = target.cellY0; y <= target.cellY1; ++y ) {
+        for( int x = target.cellX0; x <= target.cellX1; ++x ) {
+            std::vector<int> &cell = this->mCells[ y * this->mColumns + x ];
+            for( int i = 0; i < static_cast<int>( cell.size() ); ++i ) {
+                if( cell[i] != handle ) continue;
+                cell[i] = cell.back();
+                cell.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+
+#pragma -mark Routing
+// owners live until the id touches down again. the oldest is recycled when full.
+void NWGestureRouter::setOwner( int id, int target )
+{
+    Owner *owner = NULL;
+    for( int i = 0; i < this->mOwnerCount; ++i ) {
+        if( this->mOwners[i].id == id ) {
+            owner = &this->mOwners[i];
+            break;
+        }
+    }
+    if( !owner && this->mOwnerCount < MAX_OWNERS ) {
+        owner = &this->mOwners[ this->mOwnerCount++ ];
+    }
+    if( !owner ) {
+        owner = &this->mOwners[0];
+        for( int i = 1; i < this->mOwnerCount; ++i ) {
+            if( this->mOwners[i].order < owner->order ) owner = &this->mOwners[i];
+        }
+    }
+    owner->id = id;
+    owner->target = target;
+    owner->order = this->mOwnerOrder++;
+}
+
+NWGestureListener* NWGestureRouter::route( NWGestureEventType type, int target )
+{
+    if( target >= 0 ) {
+        const Target &t = this->mTargets[ target ];
+        if( t.isUsed && t.listener && ( t.mask & NWGestureEventQueue::maskOf( type ) ) ) {
+            return t.listener;
+        }
+    }
+    return this->mFallback ? this->mFallback : &sNullListener;
+}
+
+NWGestureListener* NWGestureRouter::routeTouch( NWGestureEventType type, int id )
+{
+    return this->route( type, this->getOwner( id ) );
+}
+
+
+#pragma -mark NWGestureListener
+void NWGestureRouter::onSingleTap( const NWPoint &touchPoint ) {
+    this->route( NW_GESTURE_SINGLE_TAP, this->findTarget( touchPoint ) )->onSingleTap( touchPoint );
+}
+void NWGestureRouter::onDoubleTap( const NWPoint &touchPoint ) {
+    this->route( NW_GESTURE_DOUBLE_TAP, this->findTarget( touchPoint ) )->onDoubleTap( touchPoint );
+}
+// nobody takes DoubleTap: neither the target nor the fallback.
+bool NWGestureRouter::isDoubleTapSupport( const NWPoint &touchPoint ) {
+    NWGestureListener *listener = this->route( NW_GESTURE_DOUBLE_TAP, this->findTarget( touchPoint ) );
+    return listener != &sNullListener && listener->isDoubleTapSupport( touchPoint );
+}
+void NWGestureRouter::onSingleTapTentative( const NWPoint &touchPoint ) {
+    this->route( NW_GESTURE_SINGLE_TAP_TENTATIVE, this->findTarget( touchPoint ) )->onSingleTapTentative( touchPoint );
+}
+void NWGestureRouter::onSingleTapRevoked( const NWPoint &touchPoint ) {
+    this->route( NW_GESTURE_SINGLE_TAP_REVOKED, this->findTarget( touchPoint ) )->onSingleTapRevoked( touchPoint );
+}
+void NWGestureRouter::onDown( const NWPoint &touchPoint, int id ) {
+    int target = this->findTarget( touchPoint );
+    this->setOwner( id, target );
+    this->route( NW_GESTURE_DOWN, target )->onDown( touchPoint, id );
+}
+void NWGestureRouter::onHold( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_HOLD, id )->onHold( touchPoint, id );
+}
+void NWGestureRouter::onTap( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_TAP, id )->onTap( touchPoint, id );
+}
+void NWGestureRouter::onCancelled( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_CANCELLED, id )->onCancelled( touchPoint, id );
+}
+void NWGestureRouter::onScroll( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_SCROLL, id )->onScroll( touchPoint, id );
+}
+void NWGestureRouter::onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy ) {
+    this->routeTouch( NW_GESTURE_FLICK, id )->onFlick( touchPoint, id, direction, vx, vy );
+}
+void NWGestureRouter::onSwipe( const NWPoint &touchPoint, int id, int direction ) {
+    this->routeTouch( NW_GESTURE_SWIPE, id )->onSwipe( touchPoint, id, direction );
+}
+void NWGestureRouter::onDrag( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_DRAG, id )->onDrag( touchPoint, id );
+}
+void NWGestureRouter::onDragEnded( const NWPoint &touchPoint, int id ) {
+    this->routeTouch( NW_GESTURE_DRAG_ENDED, id )->onDragEnded( touchPoint, id );
+}
+
+// Pinch follows the Transform of the same gesture. see NWGestureRecognizer::transformHandler().
+void NWGestureRouter::onPinchIn( float magnification, int id1, int id2 ) {
+    this->route( NW_GESTURE_PINCH_IN, this->mPinchOwner )->onPinchIn( magnification, id1, id2 );
+}
+void NWGestureRouter::onPinchOut( float magnification, int id1, int id2 ) {
+    this->route( NW_GESTURE_PINCH_OUT, this->mPinchOwner )->onPinchOut( magnification, id1, id2 );
+}
+void NWGestureRouter::onPinchAction( float magnification, int id1, int id2 ) {
+    this->route( NW_GESTURE_PINCH_ACTION, this->mPinchOwner )->onPinchAction( magnification, id1, id2 );
+}
+void NWGestureRouter::onPinchEnded( float magnification, int id1, int id2 ) {
+    this->route( NW_GESTURE_PINCH_ENDED, this->mPinchOwner )->onPinchEnded( magnification, id1, id2 );
+}
+
+// the owner is fixed at the start, even if the first finger leaves.
+int NWGestureRouter::getTransformOwner( const NWTransform &transform )
+{
+    int group = transform.group;
+    if( group < 0 || group >= NWGestureRecognizer::MAX_TRANSFORMS ) {
+        return this->getOwner( transform.firstId );
+    }
+    if( !this->mIsTransforming[ group ] ) {
+        this->mIsTransforming[ group ] = true;
+        this->mTransformOwners[ group ] = this->getOwner( transform.firstId );
+    }
+    return this->mTransformOwners[ group ];
+}
+
+void NWGestureRouter::onTransform( const NWTransform &transform ) {
+    this->mPinchOwner = this->getTransformOwner( transform );
+    this->route( NW_GESTURE_TRANSFORM, this->mPinchOwner )->onTransform( transform );
+}
+void NWGestureRouter::onTransformEnded( const NWTransform &transform ) {
+    this->mPinchOwner = this->getTransformOwner( transform );
+    if( transform.group >= 0 && transform.group < NWGestureRecognizer::MAX_TRANSFORMS ) {
+        this->mIsTransforming[ transform.group ] = false;
+        this->mTransformOwners[ transform.group ] = -1;
+    }
+    this->route( NW_GESTURE_TRANSFORM_ENDED, this->mPinchOwner )->onTransformEnded( transform );
+}
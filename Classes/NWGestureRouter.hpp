@@ -0,0 +1,181 @@
+//
+//  NWGestureRouter.hpp
+//  NoviceWorks
+//
+//  Deliver each gesture to the target under the finger.
+//
+//
+
+#ifndef __NWGestureRouter__
+#define __NWGestureRouter__
+
+#include <vector>
+
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureEventQueue.hpp"
+
+/**
+ *  @class  NWGestureRouter
+ *  @brief  NWGestureListener which routes the gestures to the registered targets.
+ *
+ *  a target is a rectangle with its own listener. when a finger touches down,
+ *  the target under it becomes the owner of the touch, and the gestures of
+ *  the touch (Hold, Tap, Scroll, Flick, Drag, ...) go to the owner only.
+ *  Transform goes to the owner of its first finger (per NWTransform::group),
+ *  Pinch follows the Transform just before it, Single/DoubleTap
+ *  to the target under the point. a tap on the target which doesn't take
+ *  DoubleTap is SingleTap at once. a target receives only the types of its
+ *  mask (bit ( 1 << NWGestureEventType )); the rest, and the touches out of
+ *  any target, go to the fallback listener.
+ *
+ *  the targets are kept in a uniform grid, so finding the target costs
+ *  the targets in one cell, not all of them. moving a target updates only
+ *  the cells it leaves and enters.
+ */
+class NWGestureRouter : public NWGestureListener
+{
+public:
+    NWGestureRouter();
+    virtual ~NWGestureRouter();
+
+    /**
+     *  Set the area of the grid and the size of a cell. rebuilds the grid.
+     *  targets out of the area still work; they share the border cells.
+     */
+    void setBounds( const NWRect &bounds, float cell_size );
+
+    /**
+     *  Set the receiver of the gestures which have no target.
+     */
+    void setFallbackListener( NWGestureListener *listener ) { this->mFallback = listener; }
+    NWGestureListener* getFallbackListener() { return this->mFallback; }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Target
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Add a target.
+     *  @param  priority    the higher one wins where targets overlap.
+     *                      the newer one wins on the same priority.
+     *  @return handle of the target.
+     *  @warning listener isn't retained.
+     */
+    int addTarget( const NWRect &rect, NWGestureListener *listener,
+                   unsigned int mask = ~0u, int priority = 0 );
+    void removeTarget( int handle );
+    void removeAllTargets();
+
+    /**
+     *  Move the target. touches already owned by it stay with it.
+     *  the setters ignore a removed or unknown handle.
+     */
+    void setTargetRect( int handle, const NWRect &rect );
+    /**
+     *  @return empty rect for a removed or unknown handle.
+     */
+    const NWRect& getTargetRect( int handle ) const;
+
+    void setTargetMask( int handle, unsigned int mask );
+    void setTargetEnabled( int handle, bool is_enabled );
+
+    /**
+     *  Is the handle of a target which isn't removed.
+     */
+    bool isTarget( int handle ) const {
+        return 0 <= handle && handle < static_cast<int>( this->mTargets.size() ) && this->mTargets[ handle ].isUsed;
+    }
+
+    int getTargetCount() const { return this->mTargetCount; }
+
+    /**
+     *  Find the target on the point.
+     *  @return handle. -1 if there is no target.
+     */
+    int findTarget( const NWPoint &p ) const;
+
+    /**
+     *  Get the target which owns the touch.
+     *  @return handle. -1 if the touch has no owner.
+     */
+    int getOwner( int id ) const;
+
+
+    // NWGestureListener
+    virtual void onSingleTap( const NWPoint &touchPoint );
+    virtual void onDoubleTap( const NWPoint &touchPoint );
+    virtual bool isDoubleTapSupport( const NWPoint &touchPoint );
+    virtual void onSingleTapTentative( const NWPoint &touchPoint );
+    virtual void onSingleTapRevoked( const NWPoint &touchPoint );
+    virtual void onDown( const NWPoint &touchPoint, int id );
+    virtual void onHold( const NWPoint &touchPoint, int id );
+    virtual void onTap( const NWPoint &touchPoint, int id );
+    virtual void onCancelled( const NWPoint &touchPoint, int id );
+    virtual void onScroll( const NWPoint &touchPoint, int id );
+    using NWGestureListener::onFlick;
+    virtual void onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy );
+    virtual void onSwipe( const NWPoint &touchPoint, int id, int direction );
+    virtual void onDrag( const NWPoint &touchPoint, int id );
+    virtual void onDragEnded( const NWPoint &touchPoint, int id );
+    virtual void onPinchIn( float magnification, int id1, int id2 );
+    virtual void onPinchOut( float magnification, int id1, int id2 );
+    virtual void onPinchAction( float magnification, int id1, int id2 );
+    virtual void onPinchEnded( float magnification, int id1, int id2 );
+    virtual void onTransform( const NWTransform &transform );
+    virtual void onTransformEnded( const NWTransform &transform );
+
+private:
+    struct Target {
+        NWRect  rect;
+        NWGestureListener *listener;
+        unsigned int mask;
+        int     priority;
+        unsigned int order;     // to prefer the newer one.
+        bool    isUsed;
+        bool    isEnabled;
+        int     cellX0, cellY0, cellX1, cellY1;     // cells covered. inclusive.
+    };
+    struct Owner {
+        int     id;
+        int     target;
+        unsigned int order;     // to recycle the oldest one.
+    };
+    static const int MAX_OWNERS = NWGestureRecognizer::MAX_TOUCHES * 2;
+
+    // Target
+    std::vector<Target> mTargets;
+    std::vector<int>    mFreeTargets;
+    int                 mTargetCount;
+    unsigned int        mTargetOrder;
+
+    // Grid: handles of the targets on each cell.
+    std::vector< std::vector<int> > mCells;
+    NWRect  mBounds;
+    float   mCellSize;
+    int     mColumns;
+    int     mRows;
+
+    // Touch owner
+    Owner           mOwners[ MAX_OWNERS ];
+    int             mOwnerCount;
+    unsigned int    mOwnerOrder;
+    // owner of each running Transform. index is NWTransform::group.
+    bool            mIsTransforming[ NWGestureRecognizer::MAX_TRANSFORMS ];
+    int             mTransformOwners[ NWGestureRecognizer::MAX_TRANSFORMS ];
+    int             mPinchOwner;        // owner of the last Transform*.
+
+    NWGestureListener *mFallback;
+
+    int cellX( float x ) const;
+    int cellY( float y ) const;
+    void insertCells( int handle );
+    void removeCells( int handle );
+
+    void setOwner( int id, int target );
+    NWGestureListener* route( NWGestureEventType type, int target );
+    NWGestureListener* routeTouch( NWGestureEventType type, int id );
+    int getTransformOwner( const NWTransform &transform );
+};
+
+
+#endif /* defined(__NWGestureRouter__) */
@@ -0,0 +1,282 @@
+//
+//  NWGestureStats.cpp
+//  NoviceWorks
+//
+//  Latency and cost of the gesture recognition, measured in place.
+//
+//
+
+// myclass
+#include "NWGestureStats.hpp"
+
+
+namespace {
+
+// receiver used while no listener is set.
+NWGestureListener sNullListener;
+
+const char *kStageNames[] = {
+    "touches_began", "touches_moved", "touches_ended", "touches_cancelled",
+    "update", "transform", "callback", "layer_touches",
+};
+
+const char *kCounterNames[] = {
+    "touch_events", "touch_samples", "gestures", "cancelled",
+    "dropped_touches", "tap_evicted",
+};
+
+const char *kGestureNames[] = {
+    "SingleTap", "DoubleTap", "Down", "Hold", "Tap", "Cancelled",
+    "Scroll", "Flick", "Swipe", "Drag", "DragEnded",
+    "PinchIn", "PinchOut", "PinchAction", "PinchEnded",
+    "Transform", "TransformEnded", "SingleTapTentative", "SingleTapRevoked",
+};
+
+// shortest bucket. the others are its powers of 2.
+const int kBucketShift = 5;     // 32 ns
+
+// one line of dump(). times in usec.
+void dumpHistogram( FILE *fp, const char *name, const NWHistogram &histogram )
+{
+    if( histogram.getCount() == 0 ) return;
+    fprintf( fp, "  %-18s %10llu %12.3f %12.3f %12.3f %12.3f\n", name,
+             static_cast<unsigned long long>( histogram.getCount() ),
+             histogram.getMean() * 0.001,
+             histogram.getPercentile( 0.5 ) * 0.001,
+             histogram.getPercentile( 0.99 ) * 0.001,
+             histogram.getMax() * 0.001 );
+}
+
+} // unnamed namespace
+
+
+#pragma -mark NWHistogram
+void NWHistogram::add( NWTime duration )
+{
+    if( duration < 0 ) duration = 0;
+    uint64_t value = static_cast<uint64_t>( duration );
+
+    int bucket = 0;
+    for( uint64_t v = value >> kBucketShift; v && bucket < BUCKETS - 1; v >>= 1 ) ++bucket;
+
+    this->mBuckets[ bucket ].add( 1 );
+    this->mCount.add( 1 );
+    this->mSum.add( value );
+    if( value > this->mMax.get() ) this->mMax.set( value );     // one writer.
+}
+
+void NWHistogram::clear()
+{
+    for( int i = 0; i < BUCKETS; ++i ) this->mBuckets[i].set( 0 );
+    this->mCount.set( 0 );
+    this->mSum.set( 0 );
+    this->mMax.set( 0 );
+}
+
+NWTime NWHistogram::getMean() const
+{
+    uint64_t count = this->mCount.get();
+    return count > 0 ? static_cast<NWTime>( this->mSum.get() / count ) : 0;
+}
+
+NWTime NWHistogram::getPercentile( double ratio ) const
+{
+    uint64_t count = 0;
+    uint64_t buckets[ BUCKETS ];
+    for( int i = 0; i < BUCKETS; ++i ) {
+        buckets[i] = this->mBuckets[i].get();
+        count += buckets[i];
+    }
+    if( count == 0 ) return 0;
+
+    uint64_t rank = static_cast<uint64_t>( ratio * count + 0.5 );
+    if( rank < 1 ) rank = 1;
+    // the limit of the bucket, but not over the max.
+    NWTime max = this->getMax();
+    uint64_t seen = 0;
+    for( int i = 0; i < BUCKETS - 1; ++i ) {
+        seen += buckets[i];
+        if( seen >= rank ) return getBucketLimit( i ) < max ? getBucketLimit( i ) : max;
+    }
+    return max;
+}
+
+NWTime NWHistogram::getBucketLimit( int i )
+{
+    return static_cast<NWTime>( 1 ) << ( kBucketShift + i );
+}
+
+
+#pragma -mark NWGestureStats
+void NWGestureStats::clear()
+{
+    for( int i = 0; i < NW_GESTURE_EVENT_TYPES; ++i ) this->mLatencies[i].clear();
+    for( int i = 0; i < STAGES; ++i ) this->mStages[i].clear();
+    for( int i = 0; i < COUNTERS; ++i ) this->mCounters[i].set( 0 );
+}
+
+const char* NWGestureStats::getStageName( Stage stage )
+{
+    return 0 <= stage && stage < STAGES ? kStageNames[ stage ] : "";
+}
+
+const char* NWGestureStats::getCounterName( Counter counter )
+{
+    return 0 <= counter && counter < COUNTERS ? kCounterNames[ counter ] : "";
+}
+
+const char* NWGestureStats::getGestureName( NWGestureEventType type )
+{
+    return 0 <= type && type < NW_GESTURE_EVENT_TYPES ? kGestureNames[ type ] : "";
+}
+
+void NWGestureStats::dump( FILE *fp ) const
+{
+    fprintf( fp, "latency (usec)        count         mean          p50          p99          max\n" );
+    for( int i = 0; i < NW_GESTURE_EVENT_TYPES; ++i ) {
+        NWGestureEventType type = static_cast<NWGestureEventType>( i );
+        dumpHistogram( fp, getGestureName( type ), this->mLatencies[i] );
+    }
+    fprintf( fp, "stage (usec)          count         mean          p50          p99          max\n" );
+    for( int i = 0; i < STAGES; ++i ) {
+        dumpHistogram( fp, getStageName( static_cast<Stage>( i ) ), this->mStages[i] );
+    }
+    fprintf( fp, "counter\n" );
+    for( int i = 0; i < COUNTERS; ++i ) {
+        fprintf( fp, "  %-18s %10llu\n", getCounterName( static_cast<Counter>( i ) ),
+                 static_cast<unsigned long long>( this->mCounters[i].get() ) );
+    }
+}
+
+
+#pragma -mark NWGestureStatsListener
+NWGestureStatsListener::NWGestureStatsListener() :
+  mListener( &sNullListener )
+, mStats( NULL )
+, mClock( NWMonotonicClock::sharedClock() )
+, mInputTime( 0 )
+, mLatencyQueue( NULL )
+{
+}
+
+void NWGestureStatsListener::setListener( NWGestureListener *listener )
+{
+    this->mListener = listener ? listener : &sNullListener;
+}
+
+NWGestureListener* NWGestureStatsListener::getListener() const
+{
+    return this->mListener == &sNullListener ? NULL : this->mListener;
+}
+
+NWTime NWGestureStatsListener::begin( NWGestureEventType type )
+{
+    if( !this->mStats ) return 0;
+    if( this->mLatencyQueue ) this->mLatencyQueue->setInputTime( this->mInputTime );
+    else                      this->mStats->addLatency( type, this->mClock->now() - this->mInputTime );
+    return NWGestureStats::now();
+}
+
+void NWGestureStatsListener::end( NWTime start )
+{
+    if( this->mStats ) this->mStats->addStageTime( NWGestureStats::STAGE_CALLBACK, NWGestureStats::now() - start );
+}
+
+void NWGestureStatsListener::onSingleTap( const NWPoint &p ) {
+    NWTime start = this->begin( NW_GESTURE_SINGLE_TAP );
+    this->mListener->onSingleTap( p );
+    this->end( start );
+}
+void NWGestureStatsListener::onDoubleTap( const NWPoint &p ) {
+    NWTime start = this->begin( NW_GESTURE_DOUBLE_TAP );
+    this->mListener->onDoubleTap( p );
+    this->end( start );
+}
+bool NWGestureStatsListener::isDoubleTapSupport( const NWPoint &p ) {
+    return this->mListener->isDoubleTapSupport( p );
+}
+void NWGestureStatsListener::onSingleTapTentative( const NWPoint &p ) {
+    NWTime start = this->begin( NW_GESTURE_SINGLE_TAP_TENTATIVE );
+    this->mListener->onSingleTapTentative( p );
+    this->end( start );
+}
+void NWGestureStatsListener::onSingleTapRevoked( const NWPoint &p ) {
+    NWTime start = this->begin( NW_GESTURE_SINGLE_TAP_REVOKED );
+    this->mListener->onSingleTapRevoked( p );
+    this->end( start );
+}
+void NWGestureStatsListener::onDown( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_DOWN );
+    this->mListener->onDown( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onHold( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_HOLD );
+    this->mListener->onHold( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onTap( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_TAP );
+    this->mListener->onTap( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onCancelled( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_CANCELLED );
+    this->mListener->onCancelled( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onScroll( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_SCROLL );
+    this->mListener->onScroll( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+    NWTime start = this->begin( NW_GESTURE_FLICK );
+    this->mListener->onFlick( p, id, direction, vx, vy );
+    this->end( start );
+}
+void NWGestureStatsListener::onSwipe( const NWPoint &p, int id, int direction ) {
+    NWTime start = this->begin( NW_GESTURE_SWIPE );
+    this->mListener->onSwipe( p, id, direction );
+    this->end( start );
+}
+void NWGestureStatsListener::onDrag( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_DRAG );
+    this->mListener->onDrag( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onDragEnded( const NWPoint &p, int id ) {
+    NWTime start = this->begin( NW_GESTURE_DRAG_ENDED );
+    this->mListener->onDragEnded( p, id );
+    this->end( start );
+}
+void NWGestureStatsListener::onPinchIn( float magnification, int id1, int id2 ) {
+    NWTime start = this->begin( NW_GESTURE_PINCH_IN );
+    this->mListener->onPinchIn( magnification, id1, id2 );
+    this->end( start );
+}
+void NWGestureStatsListener::onPinchOut( float magnification, int id1, int id2 ) {
+    NWTime start = this->begin( NW_GESTURE_PINCH_OUT );
+    this->mListener->onPinchOut( magnification, id1, id2 );
+    this->end( start );
+}
+void NWGestureStatsListener::onPinchAction( float magnification, int id1, int id2 ) {
+    NWTime start = this->begin( NW_GESTURE_PINCH_ACTION );
+    this->mListener->onPinchAction( magnification, id1, id2 );
+    this->end( start );
+}
+void NWGestureStatsListener::onPinchEnded( float magnification, int id1, int id2 ) {
+    NWTime start = this->begin( NW_GESTURE_PINCH_ENDED );
+    this->mListener->onPinchEnded( magnification, id1, id2 );
+    this->end( start );
+}
+void NWGestureStatsListener::onTransform( const NWTransform &transform ) {
+    NWTime start = this->begin( NW_GESTURE_TRANSFORM );
+    this->mListener->onTransform( transform );
+    this->end( start );
+}
+void NWGestureStatsListener::onTransformEnded( const NWTransform &transform ) {
+    NWTime start = this->begin( NW_GESTURE_TRANSFORM_ENDED );
+    this->mListener->onTransformEnded( transform );
+    this->end( start );
+}
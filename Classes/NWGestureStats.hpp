@@ -0,0 +1,306 @@
+//
+//  NWGestureStats.hpp
+//  NoviceWorks
+//
+//  Latency and cost of the gesture recognition, measured in place.
+//
+//
+
+#ifndef __NWGestureStats__
+#define __NWGestureStats__
+
+#include <cstdio>
+
+#if NW_GESTURE_THREADED
+#include <atomic>
+#endif
+
+#include "NWGestureClock.hpp"
+#include "NWGestureEventQueue.hpp"
+#include "NWGestureRecognizer.hpp"
+
+/**
+ *  @class  NWStatCounter
+ *  @brief  Counter written by one thread and read by any thread.
+ *          relaxed atomic with NW_GESTURE_THREADED, plain integer without.
+ */
+class NWStatCounter
+{
+public:
+    NWStatCounter() : mValue( 0 ) {}
+
+#if NW_GESTURE_THREADED
+    void add( uint64_t n )      { this->mValue.fetch_add( n, std::memory_order_relaxed ); }
+    void set( uint64_t n )      { this->mValue.store( n, std::memory_order_relaxed ); }
+    uint64_t get() const        { return this->mValue.load( std::memory_order_relaxed ); }
+
+private:
+    std::atomic<uint64_t> mValue;
+#else
+    void add( uint64_t n )      { this->mValue += n; }
+    void set( uint64_t n )      { this->mValue = n; }
+    uint64_t get() const        { return this->mValue; }
+
+private:
+    uint64_t mValue;
+#endif
+
+    NWStatCounter( const NWStatCounter& );
+    NWStatCounter& operator=( const NWStatCounter& );
+};
+
+/**
+ *  @class  NWHistogram
+ *  @brief  Durations counted in fixed buckets of powers of 2.
+ *
+ *  bucket 0 is below 32 ns, bucket i is below getBucketLimit( i ) = 32 ns << i,
+ *  and the last one has the rest (over 4 sec). add() never allocates or locks;
+ *  one thread adds and any thread reads. the values read while adding may be
+ *  a sample apart from each other.
+ */
+class NWHistogram
+{
+public:
+    static const int BUCKETS = 28;
+
+    NWHistogram() {}
+
+    void add( NWTime duration );
+    void clear();
+
+    uint64_t getCount() const           { return this->mCount.get(); }
+    uint64_t getBucket( int i ) const   { return this->mBuckets[i].get(); }
+    NWTime getMax() const               { return static_cast<NWTime>( this->mMax.get() ); }
+    NWTime getMean() const;
+
+    /**
+     *  Get the duration under which the ratio of samples are.
+     *  upper limit of the bucket, or the max if it's less.
+     *  @param  ratio   0 to 1. e.g. 0.99
+     */
+    NWTime getPercentile( double ratio ) const;
+
+    /**
+     *  Get the upper limit of the bucket (excluded). nanosec.
+     */
+    static NWTime getBucketLimit( int i );
+
+private:
+    NWStatCounter mBuckets[ BUCKETS ];
+    NWStatCounter mCount;
+    NWStatCounter mSum;
+    NWStatCounter mMax;
+};
+
+
+/**
+ *  @class  NWGestureStats
+ *  @brief  Histograms and counters of NWGestureRecognizer and NWGestureLayer.
+ *
+ *  set it to NWGestureRecognizer::setStats() (or NWGestureLayer::setGestureStats()),
+ *  and poll the getters or dump() it at any time.
+ *  recorded only when built with NW_GESTURE_STATS=1; otherwise the hooks
+ *  are compiled out and it stays empty.
+ *
+ *  - latency: from the time of the touch sample which made the gesture to its
+ *    callback, per gesture type, on the clock of the recognizer. it includes
+ *    the waits on purpose (SingleTap waits TimeThresholdForDoubleTap,
+ *    Hold is from the touch down). with NWGestureThread, to when the main
+ *    thread takes the gesture, so the trip through the rings is included.
+ *  - stage time: wall time in each stage (NWMonotonicClock). stages include
+ *    the callbacks called from them; STAGE_CALLBACK is the callbacks alone.
+ */
+class NWGestureStats
+{
+public:
+    enum Stage {
+        STAGE_TOUCHES_BEGAN = 0,    // NWGestureRecognizer::touches*
+        STAGE_TOUCHES_MOVED,
+        STAGE_TOUCHES_ENDED,
+        STAGE_TOUCHES_CANCELLED,
+        STAGE_UPDATE,               // timers: SingleTap, Hold
+        STAGE_TRANSFORM,            // a frame of PinchAction & Transform
+        STAGE_CALLBACK,             // listener's callbacks
+        STAGE_LAYER_TOUCHES,        // NWGestureLayer::ccTouches*, all of the event
+
+        STAGES
+    };
+
+    enum Counter {
+        COUNT_TOUCH_EVENTS = 0,     // touch events (batches of samples)
+        COUNT_TOUCH_SAMPLES,        // touches in them
+        COUNT_GESTURES,             // callbacks of all types
+        COUNT_CANCELLED,            // touches cancelled by the system
+        COUNT_DROPPED_TOUCHES,      // touches over MAX_TOUCHES down, or of negative id
+        COUNT_TAP_EVICTED,          // first taps fired as SingleTap before their time
+                                    // because MAX_TAP_SEQUENCES were waiting.
+                                    // a DoubleTap may have been taken for two SingleTaps.
+
+        COUNTERS
+    };
+
+    NWGestureStats() {}
+
+    /**
+     *  Forget all. don't call while it's recorded on the other thread.
+     */
+    void clear();
+
+    // Record.
+    void addLatency( NWGestureEventType type, NWTime latency ) {
+        this->mLatencies[ type ].add( latency );
+        this->mCounters[ COUNT_GESTURES ].add( 1 );
+    }
+    void addStageTime( Stage stage, NWTime time ) {
+        this->mStages[ stage ].add( time );
+    }
+    void count( Counter counter, int n = 1 ) {
+        this->mCounters[ counter ].add( n );
+    }
+
+    // Poll.
+    const NWHistogram& getLatency( NWGestureEventType type ) const {
+        return this->mLatencies[ type ];
+    }
+    const NWHistogram& getStageTime( Stage stage ) const {
+        return this->mStages[ stage ];
+    }
+    uint64_t getCount( Counter counter ) const {
+        return this->mCounters[ counter ].get();
+    }
+
+    static const char* getStageName( Stage stage );
+    static const char* getCounterName( Counter counter );
+    static const char* getGestureName( NWGestureEventType type );
+
+    /**
+     *  Print the non-empty histograms and the counters as a table.
+     */
+    void dump( FILE *fp ) const;
+
+    /**
+     *  Time of the stages. NWMonotonicClock.
+     */
+    static NWTime now() {
+        return NWMonotonicClock::sharedClock()->now();
+    }
+
+private:
+    NWHistogram     mLatencies[ NW_GESTURE_EVENT_TYPES ];
+    NWHistogram     mStages[ STAGES ];
+    NWStatCounter   mCounters[ COUNTERS ];
+
+    NWGestureStats( const NWGestureStats& );
+    NWGestureStats& operator=( const NWGestureStats& );
+};
+
+
+/**
+ *  @class  NWStatsScope
+ *  @brief  Time of a stage from the constructor to the destructor.
+ *          nothing without NW_GESTURE_STATS, or if stats is NULL.
+ */
+class NWStatsScope
+{
+public:
+#if NW_GESTURE_STATS
+    NWStatsScope( NWGestureStats *stats, NWGestureStats::Stage stage ) :
+      mStats( stats )
+    , mStage( stage )
+    , mStart( stats ? NWGestureStats::now() : 0 )
+    {
+    }
+    ~NWStatsScope() {
+        if( this->mStats ) this->mStats->addStageTime( this->mStage, NWGestureStats::now() - this->mStart );
+    }
+
+private:
+    NWGestureStats *mStats;
+    NWGestureStats::Stage mStage;
+    NWTime mStart;
+#else
+    NWStatsScope( NWGestureStats *stats, NWGestureStats::Stage stage ) {}
+#endif
+};
+
+/**
+ *  Count on the stats. nothing without NW_GESTURE_STATS, or if stats is NULL.
+ */
+inline void NWStatsCount( NWGestureStats *stats, NWGestureStats::Counter counter, int n = 1 )
+{
+#if NW_GESTURE_STATS
+    if( stats ) stats->count( counter, n );
+#endif
+}
+
+
+/**
+ *  @class  NWGestureStatsListener
+ *  @brief  NWGestureListener between the recognizer and the listener,
+ *          which records the latency and the time of each callback.
+ *
+ *  NWGestureRecognizer puts it in front of its listener while stats is set,
+ *  and tells it the time of the input by setInputTime().
+ */
+class NWGestureStatsListener : public NWGestureListener
+{
+public:
+    NWGestureStatsListener();
+
+    /**
+     *  @warning listener, stats and clock aren't retained.
+     */
+    void setListener( NWGestureListener *listener );
+    NWGestureListener* getListener() const;
+    void setStats( NWGestureStats *stats ) { this->mStats = stats; }
+    void setClock( NWClock *clock ) { this->mClock = clock; }
+
+    /**
+     *  Set the time of the touch sample the next callbacks come from.
+     *  on the clock of setClock().
+     */
+    void setInputTime( NWTime time ) { this->mInputTime = time; }
+
+    /**
+     *  Leave the latency to the reader of queue, which is behind this listener.
+     *  the events get the input time instead. NULL: the latency is recorded here.
+     *  @warning queue isn't retained.
+     */
+    void setLatencyQueue( NWGestureEventQueue *queue ) { this->mLatencyQueue = queue; }
+
+    virtual void onSingleTap( const NWPoint &touchPoint );
+    virtual void onDoubleTap( const NWPoint &touchPoint );
+    virtual bool isDoubleTapSupport( const NWPoint &touchPoint );
+    virtual void onSingleTapTentative( const NWPoint &touchPoint );
+    virtual void onSingleTapRevoked( const NWPoint &touchPoint );
+    virtual void onDown( const NWPoint &touchPoint, int id );
+    virtual void onHold( const NWPoint &touchPoint, int id );
+    virtual void onTap( const NWPoint &touchPoint, int id );
+    virtual void onCancelled( const NWPoint &touchPoint, int id );
+    virtual void onScroll( const NWPoint &touchPoint, int id );
+    using NWGestureListener::onFlick;
+    virtual void onFlick( const NWPoint &touchPoint, int id, int direction, float vx, float vy );
+    virtual void onSwipe( const NWPoint &touchPoint, int id, int direction );
+    virtual void onDrag( const NWPoint &touchPoint, int id );
+    virtual void onDragEnded( const NWPoint &touchPoint, int id );
+    virtual void onPinchIn( float magnification, int id1, int id2 );
+    virtual void onPinchOut( float magnification, int id1, int id2 );
+    virtual void onPinchAction( float magnification, int id1, int id2 );
+    virtual void onPinchEnded( float magnification, int id1, int id2 );
+    virtual void onTransform( const NWTransform &transform );
+    virtual void onTransformEnded( const NWTransform &transform );
+
+private:
+    NWGestureListener *mListener;
+    NWGestureStats *mStats;
+    NWClock *mClock;
+    NWTime  mInputTime;
+    NWGestureEventQueue *mLatencyQueue;
+
+    // latency of the gesture. return the start of the callback.
+    NWTime begin( NWGestureEventType type );
+    void end( NWTime start );
+};
+
+
+#endif /* defined(__NWGestureStats__) */
@@ -0,0 +1,247 @@
+//
+//  NWGestureThread.cpp
+//  NoviceWorks
+//
+//  Run NWGestureRecognizer on its own thread.
+//
+//
+
+// myclass
+#include "NWGestureThread.hpp"
+#include "NWGestureStats.hpp"
+
+#if NW_GESTURE_THREADED
+
+// std
+#include <chrono>
+
+
+#pragma -mark Class Basic Method.
+NWGestureThread::NWGestureThread( NWGestureRecognizer *recognizer ) :
+  mRecognizer( recognizer )
+, mSavedListener( NULL )
+, mStats( NULL )
+, mWorkerEvents( OUTPUT_CAPACITY )
+, mPublishedCount( 0 )
+, mIsRunning( false )
+, mIsSleeping( false )
+, mIsDoubleTapSupported( true )
+, mDroppedTouchCount( 0 )
+, mDroppedEventCount( 0 )
+, mBatchSize( 0 )
+, mBatchPhase( NW_TOUCH_BEGAN )
+{
+}
+
+NWGestureThread::~NWGestureThread()
+{
+    this->stop();
+}
+
+bool NWGestureThread::start()
+{
+    if( this->mIsRunning.load() ) return false;
+
+    this->mSavedListener = this->mRecognizer->getListener();
+    this->mRecognizer->setListener( &this->mWorkerEvents );
+    // the latency goes on until the main thread takes the gesture.
+    this->mStats = this->mRecognizer->getStats();
+    this->mRecognizer->setLatencyQueue( &this->mWorkerEvents );
+    this->mWorkerEvents.setClock( this->mRecognizer->getClock() );
+    this->mWorkerEvents.clear();
+    this->mPublishedCount = 0;
+    this->mBatchSize = 0;
+
+    this->mIsRunning.store( true );
+    this->mThread = std::thread( &NWGestureThread::run, this );
+    return true;
+}
+
+void NWGestureThread::stop()
+{
+    if( !this->mIsRunning.exchange( false ) ) return;
+    {
+        std::lock_guard<std::mutex> lock( this->mMutex );
+        this->mWakeup.notify_one();
+    }
+    this->mThread.join();
+    this->mRecognizer->setLatencyQueue( NULL );
+    this->mRecognizer->setListener( this->mSavedListener );
+}
+
+
+#pragma -mark Input thread
+bool NWGestureThread::touches( NWTouchPhase phase, const NWTouchSample *samples, int count )
+{
+    if( count <= 0 ) return true;
+    // BEGAN and MOVED leave the room for the ends, so no finger is left down.
+    unsigned int reserve = phase == NW_TOUCH_BEGAN || phase == NW_TOUCH_MOVED ? END_RESERVE : 0;
+    if( this->mInput.freeSize() < static_cast<unsigned int>( count ) + reserve ) {
+        this->mDroppedTouchCount.fetch_add( count );
+        return false;
+    }
+    for( int i = 0; i < count; ++i ) {
+        InputRecord record = { samples[i], phase, i == count - 1 };
+        this->mInput.push( record );
+    }
+    this->wakeWorker();
+    return true;
+}
+
+// the lock is taken only when the worker sleeps.
+void NWGestureThread::wakeWorker()
+{
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( this->mIsSleeping.load() ) {
+        std::lock_guard<std::mutex> lock( this->mMutex );
+        this->mWakeup.notify_one();
+    }
+}
+
+
+#pragma -mark Main thread
+bool NWGestureThread::popEvent( NWGestureEvent *event )
+{
+    if( !this->mOutput.pop( event ) ) {
+        if( !this->popRest( event ) ) return false;
+    } else {
+        this->wakeWorker();     // it may wait for the room.
+    }
+    this->recordLatency( *event );
+    return true;
+}
+
+int NWGestureThread::dispatchEvents( NWGestureListener *listener )
+{
+    int count = 0;
+    NWGestureEvent event;
+    while( this->mOutput.pop( &event ) ) {
+        this->recordLatency( event );
+        NWGestureEventQueue::dispatch( event, listener );
+        ++count;
+    }
+    if( count > 0 ) this->wakeWorker();
+    while( this->popRest( &event ) ) {
+        this->recordLatency( event );
+        NWGestureEventQueue::dispatch( event, listener );
+        ++count;
+    }
+    return count;
+}
+
+// the gestures which didn't fit in mOutput when the worker exited.
+// the worker has been joined then, so mWorkerEvents is ours.
+bool NWGestureThread::popRest( NWGestureEvent *event )
+{
+    if( this->mIsRunning.load() || this->mPublishedCount >= this->mWorkerEvents.size() ) return false;
+    *event = this->mWorkerEvents[ this->mPublishedCount++ ];
+    if( this->mPublishedCount >= this->mWorkerEvents.size() ) {
+        this->mWorkerEvents.clear();
+        this->mPublishedCount = 0;
+    }
+    return true;
+}
+
+// the worker leaves the latency of the stats to here: see start().
+void NWGestureThread::recordLatency( const NWGestureEvent &event )
+{
+#if NW_GESTURE_STATS
+    if( this->mStats ) this->mStats->addLatency( event.type, this->mRecognizer->getClock()->now() - event.inputTime );
+#endif
+}
+
+
+#pragma -mark Worker thread
+void NWGestureThread::run()
+{
+    while( this->mIsRunning.load() ) {
+        this->feedInput();
+
+        NWTime deadline = this->mRecognizer->getNextDeadline();
+        if( deadline >= 0 && deadline <= this->mRecognizer->getClock()->now() ) {
+            this->mRecognizer->update();
+        }
+        this->publishEvents();
+        this->sleep();
+    }
+    this->drainInput();
+}
+
+// give the samples to the recognizer batch by batch.
+// stops while the main thread doesn't take the gestures, instead of dropping them.
+void NWGestureThread::feedInput()
+{
+    InputRecord record;
+    while( !this->isOutputFull() && this->mInput.pop( &record ) ) {
+        if( this->mBatchSize > 0 && record.phase != this->mBatchPhase ) this->feedBatch();
+        this->mBatchPhase = record.phase;
+        this->mBatch[ this->mBatchSize++ ] = record.sample;
+        if( record.isLast || this->mBatchSize >= NWGestureRecognizer::MAX_TOUCHES ) this->feedBatch();
+    }
+}
+
+// the samples pushed before stop(). the main thread waits in join(), so
+// nothing takes mOutput any more; what doesn't fit stays in mWorkerEvents.
+void NWGestureThread::drainInput()
+{
+    InputRecord record;
+    while( this->mInput.pop( &record ) ) {
+        if( this->mBatchSize > 0 && record.phase != this->mBatchPhase ) this->feedBatch();
+        this->mBatchPhase = record.phase;
+        this->mBatch[ this->mBatchSize++ ] = record.sample;
+        if( record.isLast || this->mBatchSize >= NWGestureRecognizer::MAX_TOUCHES ) this->feedBatch();
+    }
+    if( this->mBatchSize > 0 ) this->feedBatch();
+}
+
+// the gestures of each batch go out at once, so mWorkerEvents doesn't overflow.
+void NWGestureThread::feedBatch()
+{
+    // mWorkerEvents answers isDoubleTapSupport() by its mask.
+    unsigned int mask = ~0u;
+    if( !this->mIsDoubleTapSupported.load() ) mask &= ~NWGestureEventQueue::maskOf( NW_GESTURE_DOUBLE_TAP );
+    this->mWorkerEvents.setEventMask( mask );
+
+    this->mRecognizer->touches( this->mBatchPhase, this->mBatch, this->mBatchSize );
+    this->mBatchSize = 0;
+    this->publishEvents();
+}
+
+bool NWGestureThread::isOutputFull() const
+{
+    return this->mOutput.freeSize() < BATCH_EVENT_RESERVE;
+}
+
+// what doesn't fit in mOutput waits in mWorkerEvents for the next time.
+void NWGestureThread::publishEvents()
+{
+    while( this->mPublishedCount < this->mWorkerEvents.size() ) {
+        if( !this->mOutput.push( this->mWorkerEvents[ this->mPublishedCount ] ) ) return;
+        ++this->mPublishedCount;
+    }
+    int dropped = this->mWorkerEvents.getDroppedCount();
+    if( dropped > 0 ) this->mDroppedEventCount.fetch_add( dropped );
+    this->mWorkerEvents.clear();
+    this->mPublishedCount = 0;
+}
+
+// wait for the next input (or the room of mOutput) or the next deadline of the recognizer.
+void NWGestureThread::sleep()
+{
+    std::unique_lock<std::mutex> lock( this->mMutex );
+    this->mIsSleeping.store( true );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+
+    if( this->mIsRunning.load() && ( this->mInput.empty() || this->isOutputFull() ) ) {
+        NWTime deadline = this->mRecognizer->getNextDeadline();
+        if( deadline < 0 ) {
+            this->mWakeup.wait( lock );
+        } else {
+            NWTime delay = deadline - this->mRecognizer->getClock()->now();
+            if( delay > 0 ) this->mWakeup.wait_for( lock, std::chrono::nanoseconds( delay ) );
+        }
+    }
+    this->mIsSleeping.store( false );
+}
+
+#endif /* NW_GESTURE_THREADED */
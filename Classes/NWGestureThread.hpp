@@ -0,0 +1,156 @@
+//
+//  NWGestureThread.hpp
+//  NoviceWorks
+//
+//  Run NWGestureRecognizer on its own thread.
+//
+//
+
+#ifndef __NWGestureThread__
+#define __NWGestureThread__
+
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureEventQueue.hpp"
+
+#if NW_GESTURE_THREADED
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "NWSpscRing.hpp"
+
+/**
+ *  @class  NWGestureThread
+ *  @brief  Gesture recognition off the main thread.
+ *
+ *  the input thread pushes the touch samples by touches(), the recognizer
+ *  runs on the worker thread (with its timer), and the gestures come back
+ *  as NWGestureEvent, which the main thread pops once per frame.
+ *  both ways are lock-free rings of fixed size. no allocation after start().
+ *  if the main thread doesn't take the gestures, the worker stops reading
+ *  the touches, and touches() fails when the input ring is full.
+ *  the last END_RESERVE samples of the ring are only for the ends.
+ *  stop() gives the samples left in the input ring to the recognizer
+ *  before the worker exits; pop their gestures after stop() as usual.
+ *  with NWGestureStats on the recognizer, the latency of a gesture is
+ *  recorded when the main thread pops it (the stage times stay on the worker).
+ *
+ *      thread.touches( NW_TOUCH_MOVED, samples, count );   // input thread
+ *      thread.dispatchEvents( listener );                  // main thread
+ *
+ *  @warning the recognizer must not be touched while it's running,
+ *           except through this class. its listener is replaced while running.
+ */
+class NWGestureStats;
+
+class NWGestureThread
+{
+public:
+    static const unsigned int INPUT_CAPACITY  = 256;    // samples
+    static const unsigned int OUTPUT_CAPACITY = 1024;   // events
+    static const unsigned int END_RESERVE     = NWGestureRecognizer::MAX_TOUCHES;   // samples kept for the ends
+
+    /**
+     *  @param  recognizer  configured recognizer. isn't owned.
+     */
+    explicit NWGestureThread( NWGestureRecognizer *recognizer );
+    ~NWGestureThread();
+
+    bool start();
+    void stop();
+    bool isRunning() const { return this->mIsRunning.load(); }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Input thread
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Pass a batch of touch samples to the worker.
+     *  BEGAN and MOVED fail while less than END_RESERVE samples are free,
+     *  so the ENDED and CANCELLED of the fingers down always fit.
+     *  @return false if the ring is full. the whole batch is dropped then.
+     */
+    bool touches( NWTouchPhase phase, const NWTouchSample *samples, int count );
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Main thread
+    //////////////////////////////////////////////////////////////////////
+    /**
+     *  Pop a recognized gesture.
+     *  after stop(), it pops the gestures which didn't fit in the ring too.
+     *  @return false if there is nothing.
+     */
+    bool popEvent( NWGestureEvent *event );
+
+    /**
+     *  Pop all recognized gestures and call the callbacks of listener.
+     *  @return count of the events.
+     */
+    int dispatchEvents( NWGestureListener *listener );
+
+    /**
+     *  Set whether the worker waits for DoubleTap after a tap.
+     *  the listener on the main thread isn't asked isDoubleTapSupport(),
+     *  since it's called on the worker. default true.
+     */
+    void setDoubleTapSupport( bool is_supported ) { this->mIsDoubleTapSupported.store( is_supported ); }
+    bool isDoubleTapSupport() const { return this->mIsDoubleTapSupported.load(); }
+
+    // count of what didn't fit in the rings. rejected touches() are counted too.
+    int getDroppedTouchCount() const { return this->mDroppedTouchCount.load(); }
+    int getDroppedEventCount() const { return this->mDroppedEventCount.load(); }
+
+private:
+    // room of mOutput kept for the gestures of one batch.
+    static const unsigned int BATCH_EVENT_RESERVE = NWGestureRecognizer::MAX_TOUCHES * 4 + 8;
+
+    struct InputRecord {
+        NWTouchSample   sample;
+        NWTouchPhase    phase;
+        bool            isLast;     // the last sample of a batch.
+    };
+
+    NWGestureRecognizer *mRecognizer;
+    NWGestureListener   *mSavedListener;
+    NWGestureStats      *mStats;            // of the recognizer, as of start().
+    NWGestureEventQueue  mWorkerEvents;     // listener on the worker.
+    int                  mPublishedCount;   // events of mWorkerEvents already in mOutput.
+
+    NWSpscRing<InputRecord, INPUT_CAPACITY>      mInput;
+    NWSpscRing<NWGestureEvent, OUTPUT_CAPACITY>  mOutput;
+
+    std::thread             mThread;
+    std::mutex              mMutex;
+    std::condition_variable mWakeup;
+    std::atomic<bool>       mIsRunning;
+    std::atomic<bool>       mIsSleeping;
+    std::atomic<bool>       mIsDoubleTapSupported;
+    std::atomic<int>        mDroppedTouchCount;
+    std::atomic<int>        mDroppedEventCount;
+
+    // Worker: the batch being read from mInput.
+    NWTouchSample   mBatch[ NWGestureRecognizer::MAX_TOUCHES ];
+    int             mBatchSize;
+    NWTouchPhase    mBatchPhase;
+
+    void run();
+    void feedInput();
+    void drainInput();
+    void feedBatch();
+    void publishEvents();
+    bool popRest( NWGestureEvent *event );
+    void recordLatency( const NWGestureEvent &event );
+    bool isOutputFull() const;
+    void wakeWorker();
+    void sleep();
+
+    NWGestureThread( const NWGestureThread& );
+    NWGestureThread& operator=( const NWGestureThread& );
+};
+
+#endif /* NW_GESTURE_THREADED */
+
+#endif /* defined(__NWGestureThread__) */
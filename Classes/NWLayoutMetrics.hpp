@@ -0,0 +1,67 @@
+//
+//  NWLayoutMetrics.hpp
+//  NoviceWorks
+//
+//  Window size and density for the distance thresholds.
+//
+//
+
+#ifndef __NWLayoutMetrics__
+#define __NWLayoutMetrics__
+
+#include <cmath>
+
+#include "cocos2d.h"
+
+/**
+ *  @class  NWLayoutMetrics
+ *  @brief  Window size, design resolution and DPI, as of update().
+ *
+ *  the layers convert the thresholds in millimetres to points by it,
+ *  and call update() again when isChanged() (a rotation or a resize).
+ */
+class NWLayoutMetrics
+{
+public:
+    NWLayoutMetrics() :
+      mSize( cocos2d::CCSizeZero )
+    , mScale( 0.0f )
+    , mPointsPerMM( 0.0f )
+    {
+    }
+
+    void update() {
+        this->mSize = cocos2d::CCDirector::sharedDirector()->getWinSize();
+        this->mScale = getScale();
+
+        int dpi = cocos2d::CCDevice::getDPI();
+        if( dpi <= 0 ) dpi = 160;
+        this->mPointsPerMM = dpi / 25.4f / this->mScale;
+    }
+
+    bool isChanged() const {
+        cocos2d::CCSize win_size = cocos2d::CCDirector::sharedDirector()->getWinSize();
+        return !win_size.equals( this->mSize ) || getScale() != this->mScale;
+    }
+
+    const cocos2d::CCSize& getSize() const { return this->mSize; }
+    float getDiagonal() const {
+        return sqrtf( this->mSize.width * this->mSize.width + this->mSize.height * this->mSize.height );
+    }
+    float getPointsPerMM() const { return this->mPointsPerMM; }
+
+    // frame pixels per point. the design resolution may scale the points.
+    static float getScale() {
+        cocos2d::CCEGLView *view = cocos2d::CCEGLView::sharedOpenGLView();
+        float scale = view ? view->getScaleX() : 1.0f;
+        return scale > 0.0f ? scale : 1.0f;
+    }
+
+private:
+    cocos2d::CCSize mSize;
+    float   mScale;
+    float   mPointsPerMM;
+};
+
+
+#endif /* defined(__NWLayoutMetrics__) */
@@ -0,0 +1,70 @@
+//
+//  NWSpscRing.hpp
+//  NoviceWorks
+//
+//  Lock-free ring buffer between two threads.
+//
+//
+
+#ifndef __NWSpscRing__
+#define __NWSpscRing__
+
+#include <atomic>
+
+/**
+ *  @class  NWSpscRing
+ *  @brief  Fixed size lock-free queue for one producer thread and one consumer thread.
+ *
+ *  push() is called only by the producer, pop() only by the consumer.
+ *  it never allocates and never blocks. T is copied by operator=.
+ *  needs C++11 (see NW_GESTURE_THREADED).
+ *  @param  CAPACITY    must be a power of 2.
+ */
+template< typename T, unsigned int CAPACITY >
+class NWSpscRing
+{
+public:
+    NWSpscRing() : mHead( 0 ), mTail( 0 ) {}
+
+    // Producer
+    bool push( const T &value ) {
+        unsigned int tail = this->mTail.load( std::memory_order_relaxed );
+        if( tail - this->mHead.load( std::memory_order_acquire ) >= CAPACITY ) return false;
+        this->mBuffer[ tail & MASK ] = value;
+        this->mTail.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+    unsigned int freeSize() const {
+        return CAPACITY - ( this->mTail.load( std::memory_order_relaxed ) -
+                            this->mHead.load( std::memory_order_acquire ) );
+    }
+
+    // Consumer
+    bool pop( T *value ) {
+        unsigned int head = this->mHead.load( std::memory_order_relaxed );
+        if( head == this->mTail.load( std::memory_order_acquire ) ) return false;
+        *value = this->mBuffer[ head & MASK ];
+        this->mHead.store( head + 1, std::memory_order_release );
+        return true;
+    }
+    bool empty() const {
+        return this->mHead.load( std::memory_order_relaxed ) ==
+               this->mTail.load( std::memory_order_acquire );
+    }
+
+    static unsigned int capacity() { return CAPACITY; }
+
+private:
+    static const unsigned int MASK = CAPACITY - 1;
+    static_assert( ( CAPACITY & MASK ) == 0, "CAPACITY must be a power of 2" );
+
+    // head and tail are on their own cache line not to bounce between the cores.
+    static const int CACHE_LINE = 64;
+    std::atomic<unsigned int> mHead;    // next to pop.
+    char mPadding0[ CACHE_LINE - sizeof( std::atomic<unsigned int> ) ];
+    std::atomic<unsigned int> mTail;    // next to push.
+    char mPadding1[ CACHE_LINE - sizeof( std::atomic<unsigned int> ) ];
+    T mBuffer[ CAPACITY ];
+};
+
+#endif /* defined(__NWSpscRing__) */
@@ -0,0 +1,538 @@
+//
+//  NWStandardRecognizers.cpp
+//  NoviceWorks
+//
+//  Built-in gestures of NWGestureRecognizer as NWStateRecognizers.
+//
+//
+
+// std
+#include <cmath>
+
+// myclass
+#include "NWStandardRecognizers.hpp"
+
+
+namespace {
+
+// moved farther than threshold from the start. no sqrt.
+bool isBeyond( const NWArbiterTouch &touch, float threshold )
+{
+    return touch.getDistanceSq() > threshold * threshold;
+}
+
+// same as NWGestureRecognizer::getDirection().
+int getDirection( const NWArbiterTouch &touch, float correction_val )
+{
+    float dx = touch.point.x - touch.startPoint.x;
+    float dy = touch.point.y - touch.startPoint.y;
+
+    // Error correction
+    if( dx > 0.0f ) dx = dx < correction_val ? 0.0f : dx;
+    else if( dx < 0.0f ) dx = dx > -correction_val ? 0.0f : dx;
+
+    int dist = 0;
+    if( dx != 0.0f ) dist |= dx < 0.0f ? NWGestureRecognizer::LEFT : NWGestureRecognizer::RIGHT;
+    if( dy != 0.0f ) dist |= dy < 0.0f ? NWGestureRecognizer::DOWN : NWGestureRecognizer::UP;
+    return dist;
+}
+
+} // unnamed namespace
+
+
+#pragma -mark NWTapRecognizer
+NWTapRecognizer::NWTapRecognizer( bool is_single ) :
+  mIsSingle( is_single )
+, mDistanceThresholdForMoved( 0.0f )
+, mId( -1 )
+{
+}
+
+void NWTapRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId >= 0 ) {
+        this->setState( FAILED );       // second finger.
+        return;
+    }
+    this->mId = touch.id;
+}
+
+void NWTapRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) this->setState( FAILED );
+}
+
+void NWTapRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->setState( FAILED );
+        return;
+    }
+    this->mPoint = touch.point;
+    this->setState( ENDED );
+}
+
+void NWTapRecognizer::reset()
+{
+    this->mId = -1;
+}
+
+void NWTapRecognizer::deliver( NWGestureListener *listener )
+{
+    if( this->getState() != ENDED ) return;
+    if( this->mIsSingle ) listener->onSingleTap( this->mPoint );
+    else                  listener->onTap( this->mPoint, this->mId );
+}
+
+
+#pragma -mark NWDoubleTapRecognizer
+NWDoubleTapRecognizer::NWDoubleTapRecognizer() :
+  mDistanceThresholdForMoved( 0.0f )
+, mTimeThreshold( NWTimeFromSec( 0.25 ) )
+, mId( -1 )
+, mTapCount( 0 )
+, mFirstTime( 0 )
+{
+}
+
+void NWDoubleTapRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId >= 0 ) {
+        this->setState( FAILED );       // second finger.
+        return;
+    }
+    if( this->mTapCount == 1 &&
+        this->mFirstPoint.getDistanceSq( touch.point ) >
+        this->mDistanceThresholdForMoved * this->mDistanceThresholdForMoved ) {
+        this->setState( FAILED );
+        return;
+    }
+    this->mId = touch.id;
+}
+
+void NWDoubleTapRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) this->setState( FAILED );
+}
+
+void NWDoubleTapRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    this->mId = -1;
+    if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->setState( FAILED );
+        return;
+    }
+
+    // first tap. wait for the second.
+    if( this->mTapCount == 0 ) {
+        this->mTapCount = 1;
+        this->mFirstPoint = touch.point;
+        this->mFirstTime = touch.time;
+        return;
+    }
+
+    if( touch.time - this->mFirstTime > this->mTimeThreshold ) {
+        this->setState( FAILED );
+        return;
+    }
+    this->mPoint = touch.point;
+    this->setState( ENDED );
+}
+
+NWTime NWDoubleTapRecognizer::getDeadline() const
+{
+    return this->mTapCount == 1 ? this->mFirstTime + this->mTimeThreshold : -1;
+}
+
+void NWDoubleTapRecognizer::timer( NWTime now )
+{
+    this->setState( FAILED );
+}
+
+void NWDoubleTapRecognizer::reset()
+{
+    this->mId = -1;
+    this->mTapCount = 0;
+}
+
+void NWDoubleTapRecognizer::deliver( NWGestureListener *listener )
+{
+    if( this->getState() == ENDED ) listener->onDoubleTap( this->mPoint );
+}
+
+
+#pragma -mark NWHoldRecognizer
+NWHoldRecognizer::NWHoldRecognizer() :
+  mDistanceThresholdForMoved( 0.0f )
+, mTimeThreshold( NWTimeFromSec( 1.0 ) )
+, mId( -1 )
+, mStartTime( 0 )
+{
+}
+
+void NWHoldRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId >= 0 ) {
+        // the holding finger keeps dragging. others are not this one's.
+        if( this->getState() == POSSIBLE ) this->setState( FAILED );
+        return;
+    }
+    this->mId = touch.id;
+    this->mStartTime = touch.startTime;
+    this->mPoint = touch.point;
+}
+
+void NWHoldRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( touch.id != this->mId ) return;
+    this->mPoint = touch.point;
+    if( this->isActive() ) {
+        this->setState( CHANGED );
+    } else if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->setState( FAILED );
+    }
+}
+
+void NWHoldRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    if( touch.id != this->mId ) return;
+    this->mPoint = touch.point;
+    this->setState( this->isActive() ? ENDED : FAILED );
+}
+
+NWTime NWHoldRecognizer::getDeadline() const
+{
+    return this->getState() == POSSIBLE && this->mId >= 0 ? this->mStartTime + this->mTimeThreshold : -1;
+}
+
+void NWHoldRecognizer::timer( NWTime now )
+{
+    this->setState( BEGAN );
+}
+
+void NWHoldRecognizer::reset()
+{
+    this->mId = -1;
+}
+
+void NWHoldRecognizer::deliver( NWGestureListener *listener )
+{
+    switch( this->getState() ) {
+        case BEGAN:     listener->onHold( this->mPoint, this->mId );       break;
+        case CHANGED:   listener->onDrag( this->mPoint, this->mId );       break;
+        case ENDED:
+        case CANCELLED: listener->onDragEnded( this->mPoint, this->mId );  break;
+        default:        break;
+    }
+}
+
+
+#pragma -mark NWPanRecognizer
+NWPanRecognizer::NWPanRecognizer() :
+  mDistanceThresholdForMoved( 0.0f )
+, mId( -1 )
+{
+}
+
+void NWPanRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId < 0 ) this->mId = touch.id;
+}
+
+void NWPanRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( touch.id != this->mId ) return;
+    this->mPoint = touch.point;
+    if( this->isActive() ) {
+        this->setState( CHANGED );
+    } else if( isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->setState( BEGAN );
+    }
+}
+
+void NWPanRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    if( touch.id != this->mId ) return;
+    this->mPoint = touch.point;
+    this->setState( this->isActive() ? ENDED : FAILED );
+}
+
+void NWPanRecognizer::reset()
+{
+    this->mId = -1;
+}
+
+void NWPanRecognizer::deliver( NWGestureListener *listener )
+{
+    if( this->isActive() ) listener->onScroll( this->mPoint, this->mId );
+}
+
+
+#pragma -mark NWSwipeRecognizer
+NWSwipeRecognizer::NWSwipeRecognizer() :
+  mDistanceThresholdForMoved( 0.0f )
+, mVelocityThreshold( 0.0f )
+, mId( -1 )
+, mHasMoved( false )
+, mDirection( 0 )
+, mVx( 0.0f )
+, mVy( 0.0f )
+{
+}
+
+void NWSwipeRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId < 0 ) this->mId = touch.id;
+}
+
+void NWSwipeRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( touch.id == this->mId && isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->mHasMoved = true;
+    }
+}
+
+void NWSwipeRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    if( touch.id != this->mId ) return;
+    if( !this->mHasMoved && !isBeyond( touch, this->mDistanceThresholdForMoved ) ) {
+        this->setState( FAILED );
+        return;
+    }
+    this->mPoint = touch.point;
+    this->mDirection = getDirection( touch, this->mDistanceThresholdForMoved );
+    touch.velocityTracker.getVelocity( &this->mVx, &this->mVy );
+    this->setState( ENDED );
+}
+
+void NWSwipeRecognizer::reset()
+{
+    this->mId = -1;
+    this->mHasMoved = false;
+}
+
+void NWSwipeRecognizer::deliver( NWGestureListener *listener )
+{
+    if( this->getState() != ENDED ) return;
+
+    float threshold = this->mVelocityThreshold;
+    if( this->mVx * this->mVx + this->mVy * this->mVy > threshold * threshold ) {
+        listener->onFlick( this->mPoint, this->mId, this->mDirection, this->mVx, this->mVy );
+    } else {
+        listener->onSwipe( this->mPoint, this->mId, this->mDirection );
+    }
+}
+
+
+#pragma -mark NWPinchRecognizer
+NWPinchRecognizer::NWPinchRecognizer() :
+  mCount( 0 )
+, mHasMoved( false )
+, mBaseSpread( 0.0f )
+, mPreviousSpread( 0.0f )
+, mSpread( 0.0f )
+{
+    this->mPinchIds[0] = this->mPinchIds[1] = -1;
+}
+
+void NWPinchRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mCount >= NWGestureRecognizer::MAX_TOUCHES ) return;
+
+    // keep the gesture so far, and restart from the new finger set.
+    this->mAccumulated = this->mCount >= 2 ? this->getCurrentTransform( NULL ) : NWTransform();
+    this->mIds[ this->mCount++ ] = touch.id;
+    this->rebase();
+
+    if( this->mCount == 2 ) {
+        this->mTransform = this->getCurrentTransform( &this->mSpread );
+        this->mPinchIds[0] = this->mIds[0];
+        this->mPinchIds[1] = this->mIds[1];
+        this->setState( BEGAN );
+    }
+}
+
+void NWPinchRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    if( this->mCount >= 2 ) this->mHasMoved = true;
+}
+
+// callback once after all touches are updated.
+void NWPinchRecognizer::touchesDone()
+{
+    if( !this->mHasMoved ) return;
+    this->mHasMoved = false;
+    if( !this->isActive() ) return;
+    this->mTransform = this->getCurrentTransform( &this->mSpread );
+    this->mPinchIds[0] = this->mIds[0];
+    this->mPinchIds[1] = this->mIds[1];
+    this->setState( CHANGED );
+}
+
+void NWPinchRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    this->removeTouch( touch.id );
+}
+
+void NWPinchRecognizer::touchCancelled( const NWArbiterTouch &touch )
+{
+    this->removeTouch( touch.id );
+}
+
+void NWPinchRecognizer::removeTouch( int id )
+{
+    NWTransform current = this->getCurrentTransform( NULL );
+    if( this->mCount >= 2 ) {
+        this->mPinchIds[0] = this->mIds[0];
+        this->mPinchIds[1] = this->mIds[1];
+    }
+    int n = 0;
+    for( int i = 0; i < this->mCount; ++i ) {
+        if( this->mIds[i] != id ) this->mIds[ n++ ] = this->mIds[i];
+    }
+    this->mCount = n;
+
+    if( !this->isActive() ) {
+        if( this->mCount == 0 ) this->setState( FAILED );
+        return;
+    }
+    if( this->mCount >= 2 ) {
+        this->mAccumulated = current;
+        this->rebase();
+        return;
+    }
+    this->mTransform = current;
+    this->setState( ENDED );
+}
+
+void NWPinchRecognizer::reset()
+{
+    this->mCount = 0;
+    this->mHasMoved = false;
+    this->mAccumulated = NWTransform();
+}
+
+// take the current finger positions as the base.
+void NWPinchRecognizer::rebase()
+{
+    const NWGestureArbiter *arbiter = this->getArbiter();
+    int n = this->mCount;
+    if( !arbiter || n == 0 ) return;
+
+    NWPoint centroid;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = arbiter->getTouch( this->mIds[i] )->point;
+        centroid.x += p.x;
+        centroid.y += p.y;
+    }
+    centroid.x /= n;
+    centroid.y /= n;
+
+    float spread = 0.0f;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = arbiter->getTouch( this->mIds[i] )->point;
+        this->mBases[i] = NWPoint( p.x - centroid.x, p.y - centroid.y );
+        spread += sqrtf( this->mBases[i].x * this->mBases[i].x + this->mBases[i].y * this->mBases[i].y );
+    }
+    this->mBaseCentroid = centroid;
+    this->mBaseSpread = spread / n;
+    this->mPreviousSpread = this->mBaseSpread;
+}
+
+// same as NWGestureRecognizer::getCurrentTransform().
+NWTransform NWPinchRecognizer::getCurrentTransform( float *spread_out ) const
+{
+    const NWGestureArbiter *arbiter = this->getArbiter();
+    NWTransform transform = this->mAccumulated;
+    int n = this->mCount;
+    transform.touchCount = n;
+    if( !arbiter || n == 0 ) return transform;
+    transform.firstId = this->mIds[0];
+    transform.group = 0;        // one pinch per recognizer.
+
+    NWPoint centroid;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = arbiter->getTouch( this->mIds[i] )->point;
+        centroid.x += p.x;
+        centroid.y += p.y;
+    }
+    centroid.x /= n;
+    centroid.y /= n;
+
+    float spread = 0.0f, cross = 0.0f, dot = 0.0f;
+    for( int i = 0; i < n; ++i ) {
+        const NWPoint &p = arbiter->getTouch( this->mIds[i] )->point;
+        float cx = p.x - centroid.x;
+        float cy = p.y - centroid.y;
+        spread += sqrtf( cx * cx + cy * cy );
+        cross += this->mBases[i].x * cy - this->mBases[i].y * cx;
+        dot   += this->mBases[i].x * cx + this->mBases[i].y * cy;
+    }
+    spread /= n;
+    if( spread_out ) *spread_out = spread;
+
+    if( this->mBaseSpread > 0.0f ) transform.scale *= spread / this->mBaseSpread;
+    if( cross != 0.0f || dot != 0.0f ) transform.rotation += atan2f( cross, dot );
+    transform.translation.x += centroid.x - this->mBaseCentroid.x;
+    transform.translation.y += centroid.y - this->mBaseCentroid.y;
+    transform.centroid = centroid;
+    return transform;
+}
+
+void NWPinchRecognizer::deliver( NWGestureListener *listener )
+{
+    // first two fingers are the ids of PinchAction.
+    int id1 = this->mPinchIds[0];
+    int id2 = this->mPinchIds[1];
+    float magnification = this->mTransform.scale;
+
+    if( this->isActive() ) {
+        listener->onTransform( this->mTransform );
+        listener->onPinchAction( magnification, id1, id2 );
+        if( this->mSpread < this->mPreviousSpread ) listener->onPinchIn( magnification, id1, id2 );
+        else                                        listener->onPinchOut( magnification, id1, id2 );
+        this->mPreviousSpread = this->mSpread;
+    } else {
+        listener->onTransformEnded( this->mTransform );
+        listener->onPinchEnded( magnification, id1, id2 );
+    }
+}
+
+
+#pragma -mark NWStandardRecognizers
+NWStandardRecognizers::NWStandardRecognizers() :
+  singleTap( true )
+, tap( false )
+{
+    this->swipe.allowSimultaneous( &this->pan );
+    this->tap.allowSimultaneous( &this->doubleTap );
+    this->tap.allowSimultaneous( &this->singleTap );
+    this->singleTap.requireToFail( &this->doubleTap );
+}
+
+// the order is the priority.
+void NWStandardRecognizers::install( NWGestureArbiter *arbiter )
+{
+    arbiter->addRecognizer( &this->hold );
+    arbiter->addRecognizer( &this->pinch );
+    arbiter->addRecognizer( &this->pan );
+    arbiter->addRecognizer( &this->swipe );
+    arbiter->addRecognizer( &this->tap );
+    arbiter->addRecognizer( &this->doubleTap );
+    arbiter->addRecognizer( &this->singleTap );
+}
+
+void NWStandardRecognizers::copyConfig( const NWGestureRecognizer &recognizer )
+{
+    float distance = recognizer.getDistanceThresholdForMoved();
+    this->hold.setDistanceThresholdForMoved( distance );
+    this->pan.setDistanceThresholdForMoved( distance );
+    this->swipe.setDistanceThresholdForMoved( distance );
+    this->tap.setDistanceThresholdForMoved( distance );
+    this->singleTap.setDistanceThresholdForMoved( distance );
+    this->doubleTap.setDistanceThresholdForMoved( distance );
+
+    this->hold.setTimeThresholdForHold( NWTimeFromSec( recognizer.getTimeThresholdForHold() ) );
+    this->doubleTap.setTimeThresholdForDoubleTap( NWTimeFromSec( recognizer.getTimeThresholdForDoubleTap() ) );
+    this->swipe.setVelocityThresholdForFlick( recognizer.getVelocityThresholdForFlick() );
+}
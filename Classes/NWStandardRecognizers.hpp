@@ -0,0 +1,220 @@
+//
+//  NWStandardRecognizers.hpp
+//  NoviceWorks
+//
+//  Built-in gestures of NWGestureRecognizer as NWStateRecognizers.
+//
+//
+
+#ifndef __NWStandardRecognizers__
+#define __NWStandardRecognizers__
+
+#include "NWGestureArbiter.hpp"
+
+/**
+ *  @class  NWTapRecognizer
+ *  @brief  One finger down and up without moving. discrete.
+ *          delivers onTap, or onSingleTap if is_single.
+ */
+class NWTapRecognizer : public NWStateRecognizer
+{
+public:
+    explicit NWTapRecognizer( bool is_single = false );
+
+    void setDistanceThresholdForMoved( float distance ) { this->mDistanceThresholdForMoved = distance; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    bool    mIsSingle;
+    float   mDistanceThresholdForMoved;
+    int     mId;
+    NWPoint mPoint;
+};
+
+/**
+ *  @class  NWDoubleTapRecognizer
+ *  @brief  Two taps near each other within the time. discrete.
+ */
+class NWDoubleTapRecognizer : public NWStateRecognizer
+{
+public:
+    NWDoubleTapRecognizer();
+
+    void setDistanceThresholdForMoved( float distance ) { this->mDistanceThresholdForMoved = distance; }
+    void setTimeThresholdForDoubleTap( NWTime time ) { this->mTimeThreshold = time; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual NWTime getDeadline() const;
+    virtual void timer( NWTime now );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    float   mDistanceThresholdForMoved;
+    NWTime  mTimeThreshold;
+    int     mId;            // finger down now. -1: none.
+    int     mTapCount;
+    NWPoint mFirstPoint;
+    NWTime  mFirstTime;
+    NWPoint mPoint;
+};
+
+/**
+ *  @class  NWHoldRecognizer
+ *  @brief  One finger stays until the time, then drags. continuous.
+ *          BEGAN: onHold, CHANGED: onDrag, ENDED / CANCELLED: onDragEnded.
+ */
+class NWHoldRecognizer : public NWStateRecognizer
+{
+public:
+    NWHoldRecognizer();
+
+    void setDistanceThresholdForMoved( float distance ) { this->mDistanceThresholdForMoved = distance; }
+    void setTimeThresholdForHold( NWTime time ) { this->mTimeThreshold = time; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual NWTime getDeadline() const;
+    virtual void timer( NWTime now );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    float   mDistanceThresholdForMoved;
+    NWTime  mTimeThreshold;
+    int     mId;
+    NWTime  mStartTime;
+    NWPoint mPoint;
+};
+
+/**
+ *  @class  NWPanRecognizer
+ *  @brief  One finger moved over the threshold. continuous.
+ *          BEGAN / CHANGED: onScroll.
+ */
+class NWPanRecognizer : public NWStateRecognizer
+{
+public:
+    NWPanRecognizer();
+
+    void setDistanceThresholdForMoved( float distance ) { this->mDistanceThresholdForMoved = distance; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    float   mDistanceThresholdForMoved;
+    int     mId;
+    NWPoint mPoint;
+};
+
+/**
+ *  @class  NWSwipeRecognizer
+ *  @brief  One finger released after moving. discrete.
+ *          onFlick if it's released faster than the threshold, else onSwipe.
+ */
+class NWSwipeRecognizer : public NWStateRecognizer
+{
+public:
+    NWSwipeRecognizer();
+
+    void setDistanceThresholdForMoved( float distance ) { this->mDistanceThresholdForMoved = distance; }
+    void setVelocityThresholdForFlick( float velocity ) { this->mVelocityThreshold = velocity; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    float   mDistanceThresholdForMoved;
+    float   mVelocityThreshold;     // px/sec.
+    int     mId;
+    bool    mHasMoved;
+    NWPoint mPoint;
+    int     mDirection;
+    float   mVx, mVy;
+};
+
+/**
+ *  @class  NWPinchRecognizer
+ *  @brief  Two or more fingers. continuous.
+ *          onTransform and onPinch* like NWGestureRecognizer.
+ */
+class NWPinchRecognizer : public NWStateRecognizer
+{
+public:
+    NWPinchRecognizer();
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual void touchCancelled( const NWArbiterTouch &touch );
+    virtual void touchesDone();
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    int     mIds[ NWGestureRecognizer::MAX_TOUCHES ];
+    NWPoint mBases[ NWGestureRecognizer::MAX_TOUCHES ];    // vector from the base centroid.
+    int     mCount;
+    bool    mHasMoved;
+    NWPoint mBaseCentroid;
+    float   mBaseSpread;
+    float   mPreviousSpread;
+    float   mSpread;
+    NWTransform mAccumulated;   // until the last rebase.
+    NWTransform mTransform;     // to deliver.
+    int     mPinchIds[2];
+
+    void removeTouch( int id );
+    void rebase();
+    NWTransform getCurrentTransform( float *spread ) const;
+};
+
+
+/**
+ *  @class  NWStandardRecognizers
+ *  @brief  All built-in recognizers with the rules of NWGestureRecognizer:
+ *          Hold > Pinch > Pan (with Swipe) > Tap, SingleTap waits DoubleTap.
+ *
+ *      NWGestureArbiter arbiter;
+ *      NWStandardRecognizers standard;
+ *      standard.install( &arbiter );
+ *      arbiter.addRecognizer( &my_recognizer );    // lower than the built-ins.
+ */
+class NWStandardRecognizers
+{
+public:
+    NWStandardRecognizers();
+
+    void install( NWGestureArbiter *arbiter );
+
+    /**
+     *  Take the thresholds of recognizer.
+     */
+    void copyConfig( const NWGestureRecognizer &recognizer );
+
+    NWHoldRecognizer        hold;
+    NWPinchRecognizer       pinch;
+    NWPanRecognizer         pan;
+    NWSwipeRecognizer       swipe;
+    NWDoubleTapRecognizer   doubleTap;
+    NWTapRecognizer         singleTap;
+    NWTapRecognizer         tap;
+};
+
+
+#endif /* defined(__NWStandardRecognizers__) */
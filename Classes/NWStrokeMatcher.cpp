@@ -0,0 +1,287 @@
+//
+//  NWStrokeMatcher.cpp
+//  NoviceWorks
+//
+//  Shape of one stroke (circle, check mark, letters...) matched against
+//  templates, in the way of the Protractor recognizer.
+//
+//
+
+// std
+#include <cmath>
+
+// myclass
+#include "NWGeometry.hpp"
+#include "NWStrokeMatcher.hpp"
+
+
+namespace {
+
+const float kPi = 3.14159265f;
+
+/**
+ *  Make the stroke a vector: resample to POINTS points at equal distance,
+ *  move to the centroid and normalize. out is x block then y block.
+ *  @param  tail    norm of out from each block to the end. BLOCKS + 1.
+ *  @return false if the stroke has no length.
+ */
+bool vectorize( const float *xs, const float *ys, int count, float *out, float *tail )
+{
+    const int n = NWStrokeMatcher::POINTS;
+    const int block = NWStrokeMatcher::BLOCK;
+    float *out_xs = out;
+    float *out_ys = out + n;
+    if( !NWResample( xs, ys, count, out_xs, out_ys, n ) ) return false;
+
+    NWPoint centroid = NWCentroid( out_xs, out_ys, n );
+    for( int i = 0; i < n; ++i ) {
+        out_xs[i] -= centroid.x;
+        out_ys[i] -= centroid.y;
+    }
+
+    // normalize, and the norm of the rest for early abandoning.
+    float sum = 0.0f;
+    tail[ n / block ] = 0.0f;
+    for( int b = n / block - 1; b >= 0; --b ) {
+        float squares, unused;
+        const float *bx = out_xs + b * block;
+        const float *by = out_ys + b * block;
+        NWDotCross( bx, by, bx, by, block, &squares, &unused );
+        sum += squares;
+        tail[b] = sum;
+    }
+    if( sum <= 0.0f ) return false;
+    float scale = 1.0f / sqrtf( sum );
+    for( int i = 0; i < n * 2; ++i ) out[i] *= scale;
+    for( int b = 0; b <= n / block; ++b ) tail[b] = sqrtf( tail[b] ) * scale;
+    return true;
+}
+
+} // unnamed namespace
+
+
+#pragma -mark NWStrokeMatcher
+NWStrokeMatcher::NWStrokeMatcher() :
+  mScoreThreshold( 0.8f )
+, mMaxRotation( kPi )
+{
+    this->mScratchXs.reserve( NW_GESTURE_STROKE_CAPACITY );
+    this->mScratchYs.reserve( NW_GESTURE_STROKE_CAPACITY );
+}
+
+int NWStrokeMatcher::addTemplate( const char *name, const float *xs, const float *ys, int count )
+{
+    float vector[ STRIDE ];
+    float tail[ BLOCKS + 1 ];
+    if( !xs || !ys || !vectorize( xs, ys, count, vector, tail ) ) return -1;
+
+    this->mNames.push_back( name ? name : "" );
+    this->mVectors.insert( this->mVectors.end(), vector, vector + STRIDE );
+    this->mTailNorms.insert( this->mTailNorms.end(), tail, tail + BLOCKS + 1 );
+    return this->getTemplateCount() - 1;
+}
+
+int NWStrokeMatcher::addTemplate( const char *name, const NWPoint *points, int count )
+{
+    if( !points || !this->toScratch( points, count ) ) return -1;
+    return this->addTemplate( name, &this->mScratchXs[0], &this->mScratchYs[0], count );
+}
+
+int NWStrokeMatcher::addTemplate( const char *name, const NWTouchHistory &history )
+{
+    if( !this->toScratch( history ) ) return -1;
+    return this->addTemplate( name, &this->mScratchXs[0], &this->mScratchYs[0], history.size() );
+}
+
+void NWStrokeMatcher::reserve( int count )
+{
+    this->mNames.reserve( count );
+    this->mVectors.reserve( count * STRIDE );
+    this->mTailNorms.reserve( count * ( BLOCKS + 1 ) );
+}
+
+void NWStrokeMatcher::clear()
+{
+    this->mNames.clear();
+    this->mVectors.clear();
+    this->mTailNorms.clear();
+}
+
+const char* NWStrokeMatcher::getTemplateName( int index ) const
+{
+    if( index < 0 || this->getTemplateCount() <= index ) return NULL;
+    return this->mNames[ index ].c_str();
+}
+
+bool NWStrokeMatcher::match( const float *xs, const float *ys, int count, NWStrokeMatch *match ) const
+{
+    *match = NWStrokeMatch();
+    if( !xs || !ys || !vectorize( xs, ys, count, this->mCandidate, this->mCandidateTail ) ) return false;
+    return this->findBest( match );
+}
+
+bool NWStrokeMatcher::match( const NWPoint *points, int count, NWStrokeMatch *match ) const
+{
+    *match = NWStrokeMatch();
+    if( !points || !this->toScratch( points, count ) ) return false;
+    return this->match( &this->mScratchXs[0], &this->mScratchYs[0], count, match );
+}
+
+bool NWStrokeMatcher::match( const NWTouchHistory &history, NWStrokeMatch *match ) const
+{
+    *match = NWStrokeMatch();
+    if( !this->toScratch( history ) ) return false;
+    return this->match( &this->mScratchXs[0], &this->mScratchYs[0], history.size(), match );
+}
+
+// structure of arrays for the kernels. grows only for a longer stroke.
+bool NWStrokeMatcher::toScratch( const NWPoint *points, int count ) const
+{
+    if( count < 2 ) return false;
+    this->mScratchXs.resize( count );
+    this->mScratchYs.resize( count );
+    for( int i = 0; i < count; ++i ) {
+        this->mScratchXs[i] = points[i].x;
+        this->mScratchYs[i] = points[i].y;
+    }
+    return true;
+}
+
+bool NWStrokeMatcher::toScratch( const NWTouchHistory &history ) const
+{
+    if( history.size() < 2 ) return false;
+    this->mScratchXs.resize( history.size() );
+    this->mScratchYs.resize( history.size() );
+    history.copyTo( &this->mScratchXs[0], &this->mScratchYs[0] );
+    return true;
+}
+
+// Protractor: the best rotation of the template has the closed form
+// atan( b / a ), and its cosine similarity is sqrt( a^2 + b^2 ).
+// the rest of the blocks can add at most tail(template) * tail(candidate)
+// to it (Cauchy-Schwarz), so a template stops when that can't win.
+bool NWStrokeMatcher::findBest( NWStrokeMatch *match ) const
+{
+    const float *cx = this->mCandidate;
+    const float *cy = this->mCandidate + POINTS;
+    const float *ctail = this->mCandidateTail;
+    bool is_fixed = this->mMaxRotation <= 0.0f;
+
+    float best = this->mScoreThreshold;
+    int best_index = -1;
+    float best_rotation = 0.0f;
+    int count = this->getTemplateCount();
+    for( int t = 0; t < count; ++t ) {
+        const float *tx = &this->mVectors[ t * STRIDE ];
+        const float *ty = tx + POINTS;
+        const float *ttail = &this->mTailNorms[ t * ( BLOCKS + 1 ) ];
+
+        float a = 0.0f, b = 0.0f;
+        bool is_abandoned = false;
+        for( int k = 0; k < BLOCKS; ++k ) {
+            float dot, cross;
+            int i = k * BLOCK;
+            NWDotCross( tx + i, ty + i, cx + i, cy + i, BLOCK, &dot, &cross );
+            a += dot;
+            b += cross;
+            float bound = ( is_fixed ? a : sqrtf( a * a + b * b ) ) + ttail[ k + 1 ] * ctail[ k + 1 ];
+            if( bound < best ) {
+                is_abandoned = true;
+                break;
+            }
+        }
+        if( is_abandoned ) continue;
+
+        float rotation = 0.0f;
+        float score = a;
+        if( !is_fixed ) {
+            rotation = atan2f( b, a );
+            if( rotation > this->mMaxRotation ) rotation = this->mMaxRotation;
+            else if( rotation < -this->mMaxRotation ) rotation = -this->mMaxRotation;
+            score = a * cosf( rotation ) + b * sinf( rotation );
+        }
+        if( score >= best ) {
+            best = score;
+            best_index = t;
+            best_rotation = rotation;
+        }
+    }
+
+    if( best_index < 0 ) return false;
+    match->index = best_index;
+    match->name = this->mNames[ best_index ].c_str();
+    match->score = best > 1.0f ? 1.0f : best;
+    match->rotation = best_rotation;
+    return true;
+}
+
+
+#pragma -mark NWStrokeRecognizer
+NWStrokeRecognizer::NWStrokeRecognizer() :
+  mMatcher( NULL )
+, mListener( NULL )
+, mMinLength( 0.0f )
+, mId( -1 )
+{
+    this->mXs.reserve( NW_GESTURE_STROKE_CAPACITY );
+    this->mYs.reserve( NW_GESTURE_STROKE_CAPACITY );
+}
+
+void NWStrokeRecognizer::touchBegan( const NWArbiterTouch &touch )
+{
+    if( this->mId >= 0 ) {
+        this->setState( FAILED );       // second finger.
+        return;
+    }
+    this->mId = touch.id;
+    this->addPoint( touch.point );
+}
+
+void NWStrokeRecognizer::touchMoved( const NWArbiterTouch &touch )
+{
+    this->addPoint( touch.point );
+}
+
+void NWStrokeRecognizer::touchEnded( const NWArbiterTouch &touch )
+{
+    this->addPoint( touch.point );
+
+    int count = this->mXs.size();
+    if( !this->mMatcher ||
+        NWPathLength( &this->mXs[0], &this->mYs[0], count ) < this->mMinLength ||
+        !this->mMatcher->match( &this->mXs[0], &this->mYs[0], count, &this->mMatch ) ) {
+        this->setState( FAILED );
+        return;
+    }
+    this->setState( ENDED );
+}
+
+void NWStrokeRecognizer::reset()
+{
+    this->mId = -1;
+    this->mXs.clear();
+    this->mYs.clear();
+    this->mMatch = NWStrokeMatch();
+}
+
+void NWStrokeRecognizer::deliver( NWGestureListener *listener )
+{
+    if( this->getState() == ENDED && this->mListener ) this->mListener->onStroke( this->mMatch, this->mId );
+}
+
+// thin out by half when full. the shape stays after resampling.
+void NWStrokeRecognizer::addPoint( const NWPoint &p )
+{
+    int count = this->mXs.size();
+    if( count >= NW_GESTURE_STROKE_CAPACITY ) {
+        int n = 0;
+        for( int i = 0; i < count; i += 2, ++n ) {
+            this->mXs[n] = this->mXs[i];
+            this->mYs[n] = this->mYs[i];
+        }
+        this->mXs.resize( n );
+        this->mYs.resize( n );
+    }
+    this->mXs.push_back( p.x );
+    this->mYs.push_back( p.y );
+}
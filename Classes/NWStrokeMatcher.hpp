@@ -0,0 +1,191 @@
+//
+//  NWStrokeMatcher.hpp
+//  NoviceWorks
+//
+//  Shape of one stroke (circle, check mark, letters...) matched against
+//  templates, in the way of the Protractor recognizer.
+//
+//
+
+#ifndef __NWStrokeMatcher__
+#define __NWStrokeMatcher__
+
+#include <string>
+#include <vector>
+
+#include "NWGestureArbiter.hpp"
+
+// Points of a resampled stroke. multiple of NW_GESTURE_STROKE_BLOCK.
+#ifndef NW_GESTURE_STROKE_POINTS
+#define NW_GESTURE_STROKE_POINTS    32
+#endif
+
+// Points scored between the early-abandon checks.
+#ifndef NW_GESTURE_STROKE_BLOCK
+#define NW_GESTURE_STROKE_BLOCK     8
+#endif
+
+// Max raw points NWStrokeRecognizer keeps. thinned out by half when full.
+#ifndef NW_GESTURE_STROKE_CAPACITY
+#define NW_GESTURE_STROKE_CAPACITY  256
+#endif
+
+/**
+ *  @struct NWStrokeMatch
+ *  @brief  The best template for a stroke.
+ */
+struct NWStrokeMatch
+{
+    int         index;      // of the template. -1: none.
+    const char *name;       // valid until the matcher is changed.
+    float       score;      // cosine similarity. 1 is the same shape.
+    float       rotation;   // radian the template is rotated to fit.
+
+    NWStrokeMatch() : index( -1 ), name( NULL ), score( 0.0f ), rotation( 0.0f ) {}
+};
+
+/**
+ *  @class  NWStrokeMatcher
+ *  @brief  Templates of strokes and the matching.
+ *
+ *  a stroke is resampled to NW_GESTURE_STROKE_POINTS points along its path,
+ *  moved to its centroid and normalized, so the position and the size
+ *  don't matter. the direction of drawing does; add the template twice
+ *  (reversed) if both should match.
+ *
+ *  templates are processed once in addTemplate() and packed in one array
+ *  (x block and y block per template). match() scores them block by block
+ *  and drops a template as soon as it can't beat the best one.
+ *  the geometry runs on the kernels of NWGeometry.hpp. match() doesn't
+ *  allocate unless the stroke is longer than NW_GESTURE_STROKE_CAPACITY.
+ *
+ *      NWStrokeMatch m;
+ *      const NWTouchHistory *history = layer->getTouchHistoryView( id );
+ *      if( history && matcher.match( *history, &m ) ) CCLOG( "%s", m.name );
+ */
+class NWStrokeMatcher
+{
+public:
+    static const int POINTS = NW_GESTURE_STROKE_POINTS;
+    static const int BLOCK  = NW_GESTURE_STROKE_BLOCK;
+
+    NWStrokeMatcher();
+
+    /**
+     *  Add a template.
+     *  @return index of the template. -1 if the stroke has no length.
+     */
+    int addTemplate( const char *name, const NWPoint *points, int count );
+    int addTemplate( const char *name, const float *xs, const float *ys, int count );
+    int addTemplate( const char *name, const NWTouchHistory &history );
+
+    void reserve( int count );
+    void clear();
+    int getTemplateCount() const { return static_cast<int>( this->mNames.size() ); }
+    const char* getTemplateName( int index ) const;
+
+    /**
+     *  Set the lowest score match() accepts. default 0.8.
+     */
+    void setScoreThreshold( float score ) { this->mScoreThreshold = score; }
+    float getScoreThreshold() const { return this->mScoreThreshold; }
+
+    /**
+     *  Set how much a stroke may be rotated from the template.
+     *  0: orientation sensitive. M_PI (default): any rotation.
+     */
+    void setMaxRotation( float radian ) { this->mMaxRotation = radian; }
+    float getMaxRotation() const { return this->mMaxRotation; }
+
+    /**
+     *  Find the best template.
+     *  @param  match   the result. index is -1 if it returns false.
+     *  @return false if no template scores the threshold.
+     */
+    bool match( const NWPoint *points, int count, NWStrokeMatch *match ) const;
+    bool match( const float *xs, const float *ys, int count, NWStrokeMatch *match ) const;
+    bool match( const NWTouchHistory &history, NWStrokeMatch *match ) const;
+
+private:
+    enum {
+        BLOCKS = POINTS / BLOCK,
+        STRIDE = POINTS * 2,        // floats per template: x block, y block.
+    };
+
+    std::vector<std::string> mNames;
+    std::vector<float>  mVectors;       // STRIDE per template.
+    std::vector<float>  mTailNorms;     // BLOCKS + 1 per template. norm from the block to the end.
+    float   mScoreThreshold;
+    float   mMaxRotation;
+
+    // the candidate of match(). no allocation while matching.
+    mutable float mCandidate[ STRIDE ];
+    mutable float mCandidateTail[ BLOCKS + 1 ];
+    mutable std::vector<float> mScratchXs;     // input as structure of arrays.
+    mutable std::vector<float> mScratchYs;
+
+    bool toScratch( const NWPoint *points, int count ) const;
+    bool toScratch( const NWTouchHistory &history ) const;
+    bool findBest( NWStrokeMatch *match ) const;
+};
+
+
+/**
+ *  @class  NWStrokeListener
+ *  @brief  Receiver of NWStrokeRecognizer.
+ */
+class NWStrokeListener
+{
+public:
+    virtual ~NWStrokeListener() {}
+    virtual void onStroke( const NWStrokeMatch &match, int id ) {}
+};
+
+/**
+ *  @class  NWStrokeRecognizer
+ *  @brief  One finger drawing a template of the matcher. discrete.
+ *          matched when the finger is up; calls onStroke of its listener.
+ *
+ *  add it before NWStandardRecognizers to beat Swipe / Flick, and allow
+ *  it with the Pan so that onScroll goes on while drawing:
+ *
+ *      arbiter.addRecognizer( &stroke );
+ *      standard.install( &arbiter );
+ *      stroke.allowSimultaneous( &standard.pan );
+ */
+class NWStrokeRecognizer : public NWStateRecognizer
+{
+public:
+    NWStrokeRecognizer();
+
+    /**
+     *  @warning matcher and listener aren't retained.
+     */
+    void setMatcher( const NWStrokeMatcher *matcher ) { this->mMatcher = matcher; }
+    void setStrokeListener( NWStrokeListener *listener ) { this->mListener = listener; }
+
+    /**
+     *  Set the shortest path to match. shorter strokes fail.
+     */
+    void setMinLength( float length ) { this->mMinLength = length; }
+
+    virtual void touchBegan( const NWArbiterTouch &touch );
+    virtual void touchMoved( const NWArbiterTouch &touch );
+    virtual void touchEnded( const NWArbiterTouch &touch );
+    virtual void reset();
+    virtual void deliver( NWGestureListener *listener );
+
+private:
+    const NWStrokeMatcher *mMatcher;
+    NWStrokeListener *mListener;
+    float   mMinLength;
+    int     mId;
+    std::vector<float> mXs;
+    std::vector<float> mYs;
+    NWStrokeMatch mMatch;
+
+    void addPoint( const NWPoint &p );
+};
+
+
+#endif /* defined(__NWStrokeMatcher__) */
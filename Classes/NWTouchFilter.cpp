@@ -0,0 +1,83 @@
+//
+//  NWTouchFilter.cpp
+//  NoviceWorks
+//
+//  Smoothing of a touch stream against the jitter of the panel.
+//
+//
+
+// std
+#include <cmath>
+
+// myclass
+#include "NWTouchFilter.hpp"
+
+
+namespace {
+
+// weight of the new sample for the low-pass filter of the cutoff.
+float smoothingFactor( float cutoff, float dt )
+{
+    float tau = 1.0f / ( 2.0f * 3.14159265f * cutoff );
+    return 1.0f / ( 1.0f + tau / dt );
+}
+
+} // unnamed namespace
+
+
+NWTouchFilter::NWTouchFilter() :
+  mPolicy()
+, mHasSample( false )
+, mX( 0.0f ), mY( 0.0f )
+, mRawX( 0.0f ), mRawY( 0.0f )
+, mDx( 0.0f ), mDy( 0.0f )
+, mTime( 0 )
+{
+}
+
+void NWTouchFilter::setPolicy( const NWFilterPolicy &policy )
+{
+    this->mPolicy = policy;
+    this->clear();
+}
+
+void NWTouchFilter::clear()
+{
+    this->mHasSample = false;
+    this->mDx = this->mDy = 0.0f;
+}
+
+void NWTouchFilter::addSample( float x, float y, NWTime time )
+{
+    if( !this->mHasSample || !this->isEnabled() ) {
+        this->mX = this->mRawX = x;
+        this->mY = this->mRawY = y;
+        this->mTime = time;
+        this->mHasSample = true;
+        return;
+    }
+    float dt = static_cast<float>( NWTimeToSec( time - this->mTime ) );
+    if( dt <= 0.0f ) return;        // same time: the next one covers it.
+
+    // speed, smoothed at the fixed cutoff.
+    float a_d = smoothingFactor( this->mPolicy.derivativeCutoff, dt );
+    this->mDx += a_d * ( ( x - this->mRawX ) / dt - this->mDx );
+    this->mDy += a_d * ( ( y - this->mRawY ) / dt - this->mDy );
+
+    // position, smoothed at the cutoff of the speed.
+    float speed = sqrtf( this->mDx * this->mDx + this->mDy * this->mDy );
+    float a = smoothingFactor( this->mPolicy.minCutoff + this->mPolicy.beta * speed, dt );
+    this->mX += a * ( x - this->mX );
+    this->mY += a * ( y - this->mY );
+
+    this->mRawX = x;
+    this->mRawY = y;
+    this->mTime = time;
+}
+
+bool NWTouchFilter::getPoint( float *x, float *y ) const
+{
+    *x = this->mX;
+    *y = this->mY;
+    return this->mHasSample;
+}
@@ -0,0 +1,71 @@
+//
+//  NWTouchFilter.hpp
+//  NoviceWorks
+//
+//  Smoothing of a touch stream against the jitter of the panel.
+//
+//
+
+#ifndef __NWTouchFilter__
+#define __NWTouchFilter__
+
+#include "NWGestureClock.hpp"
+
+/**
+ *  @struct NWFilterPolicy
+ *  @brief  How the touch positions are smoothed and predicted.
+ *
+ *  smoothing is the One Euro filter: a low-pass filter whose cutoff rises
+ *  with the speed, so a resting finger is steady and a fast one doesn't lag.
+ *  lower minCutoff: less jitter at rest. higher beta: less lag in motion.
+ */
+struct NWFilterPolicy
+{
+    float   minCutoff;      // Hz at rest. 0: off.
+    float   beta;           // cutoff added per px/sec.
+    float   derivativeCutoff;   // Hz of the speed used for the cutoff.
+    double  predictionTime;     // sec ahead the predicted point is. 0: off.
+
+    NWFilterPolicy() : minCutoff( 0.0f ), beta( 0.0f ), derivativeCutoff( 1.0f ), predictionTime( 0.0 ) {}
+    NWFilterPolicy( float min_cutoff, float b, double prediction ) :
+        minCutoff( min_cutoff ), beta( b ), derivativeCutoff( 1.0f ), predictionTime( prediction ) {}
+};
+
+/**
+ *  @class  NWTouchFilter
+ *  @brief  One Euro filter of a touch. O(1) per sample, no allocation.
+ */
+class NWTouchFilter
+{
+public:
+    NWTouchFilter();
+
+    void setPolicy( const NWFilterPolicy &policy );
+    const NWFilterPolicy& getPolicy() const {
+        return this->mPolicy;
+    }
+    bool isEnabled() const {
+        return this->mPolicy.minCutoff > 0.0f;
+    }
+
+    void clear();
+    void addSample( float x, float y, NWTime time );
+
+    /**
+     *  Get the smoothed position at the latest sample.
+     *  the latest sample as it is if the filter is off.
+     *  @return false if there is no sample.
+     */
+    bool getPoint( float *x, float *y ) const;
+
+private:
+    NWFilterPolicy mPolicy;
+    bool    mHasSample;
+    float   mX, mY;         // smoothed.
+    float   mRawX, mRawY;   // previous sample.
+    float   mDx, mDy;       // smoothed px/sec.
+    NWTime  mTime;
+};
+
+
+#endif /* defined(__NWTouchFilter__) */
@@ -0,0 +1,279 @@
+//
+//  NWTouchTrace.cpp
+//  NoviceWorks
+//
+//  Record and replay of the raw touch events.
+//
+//
+
+// std
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// myclass
+#include "NWTouchTrace.hpp"
+
+
+using std::vector;
+
+
+namespace {
+
+#pragma -mark Support Functions
+
+const char  kMagic[4]   = { 'N', 'W', 'T', 'R' };
+const int   kVersion    = 1;
+const char  kTextHeader[] = "#NWTR text 1";
+const char  kPhaseChars[] = "BMEC";
+
+const unsigned char kTagPhaseMask   = 0x03;
+const unsigned char kTagBatchStart  = 0x04;
+
+uint64_t zigzagEncode( int64_t value ) {
+    return ( static_cast<uint64_t>( value ) << 1 ) ^ static_cast<uint64_t>( value >> 63 );
+}
+int64_t zigzagDecode( uint64_t value ) {
+    return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 );
+}
+
+void writeFloat( FILE *file, float value ) {
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>( bits ),       static_cast<unsigned char>( bits >> 8 ),
+        static_cast<unsigned char>( bits >> 16 ), static_cast<unsigned char>( bits >> 24 ),
+    };
+    fwrite( bytes, 1, 4, file );
+}
+bool readFloat( FILE *file, float *value ) {
+    unsigned char bytes[4];
+    if( fread( bytes, 1, 4, file ) != 4 ) return false;
+    uint32_t bits = bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 ) |
+                    ( static_cast<uint32_t>( bytes[3] ) << 24 );
+    memcpy( value, &bits, sizeof( bits ) );
+    return true;
+}
+
+} // unnamed namespace
+
+
+#pragma -mark NWTouchTraceWriter
+NWTouchTraceWriter::NWTouchTraceWriter() :
+  mFile( NULL )
+, mFormat( BINARY )
+, mPreviousTime( 0 )
+{
+}
+
+NWTouchTraceWriter::~NWTouchTraceWriter()
+{
+    this->close();
+}
+
+bool NWTouchTraceWriter::open( const char *path, Format format )
+{
+    this->close();
+    this->mFile = fopen( path, format == BINARY ? "wb" : "w" );
+    if( !this->mFile ) return false;
+
+    this->mFormat = format;
+    this->mPreviousTime = 0;
+    if( format == BINARY ) {
+        unsigned char header[8] = { 0 };
+        memcpy( header, kMagic, 4 );
+        header[4] = kVersion;
+        fwrite( header, 1, sizeof( header ), this->mFile );
+    } else {
+        fprintf( this->mFile, "%s\n", kTextHeader );
+    }
+    return true;
+}
+
+void NWTouchTraceWriter::close()
+{
+    if( this->mFile ) {
+        fclose( this->mFile );
+        this->mFile = NULL;
+    }
+}
+
+void NWTouchTraceWriter::writeVarint( uint64_t value )
+{
+    unsigned char bytes[10];
+    int size = 0;
+    do {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        bytes[ size++ ] = value ? ( byte | 0x80 ) : byte;
+    } while( value );
+    fwrite( bytes, 1, size, this->mFile );
+}
+
+void NWTouchTraceWriter::record( NWTouchPhase phase, const NWTouchSample *samples, int count )
+{
+    if( !this->mFile ) return;
+
+    for( int i = 0; i < count; ++i ) {
+        const NWTouchSample &sample = samples[i];
+        if( this->mFormat == BINARY ) {
+            unsigned char tag = static_cast<unsigned char>( phase ) & kTagPhaseMask;
+            if( i == 0 ) tag |= kTagBatchStart;
+            fputc( tag, this->mFile );
+            this->writeVarint( zigzagEncode( sample.time - this->mPreviousTime ) );
+            this->writeVarint( zigzagEncode( sample.id ) );
+            writeFloat( this->mFile, sample.x );
+            writeFloat( this->mFile, sample.y );
+        } else {
+            fprintf( this->mFile, "%s%c %lld %d %.9g %.9g\n",
+                     i == 0 ? "" : "+", kPhaseChars[ phase & kTagPhaseMask ],
+                     static_cast<long long>( sample.time ), sample.id,
+                     sample.x, sample.y );
+        }
+        this->mPreviousTime = sample.time;
+    }
+}
+
+
+#pragma -mark NWTouchTraceReader
+NWTouchTraceReader::NWTouchTraceReader() :
+  mFile( NULL )
+, mIsText( false )
+, mPreviousTime( 0 )
+, mHasPending( false )
+{
+}
+
+NWTouchTraceReader::~NWTouchTraceReader()
+{
+    this->close();
+}
+
+bool NWTouchTraceReader::open( const char *path )
+{
+    this->close();
+    this->mFile = fopen( path, "rb" );
+    if( !this->mFile ) return false;
+
+    this->mPreviousTime = 0;
+    this->mHasPending = false;
+
+    unsigned char header[8];
+    if( fread( header, 1, sizeof( header ), this->mFile ) == sizeof( header ) &&
+        memcmp( header, kMagic, 4 ) == 0 && header[4] == kVersion ) {
+        this->mIsText = false;
+        return true;
+    }
+
+    // text: check the first line.
+    rewind( this->mFile );
+    char line[64];
+    if( fgets( line, sizeof( line ), this->mFile ) &&
+        strncmp( line, kTextHeader, strlen( kTextHeader ) ) == 0 ) {
+        this->mIsText = true;
+        return true;
+    }
+
+    this->close();
+    return false;
+}
+
+void NWTouchTraceReader::close()
+{
+    if( this->mFile ) {
+        fclose( this->mFile );
+        this->mFile = NULL;
+    }
+}
+
+bool NWTouchTraceReader::readVarint( uint64_t *value )
+{
+    *value = 0;
+    for( int shift = 0; shift < 64; shift += 7 ) {
+        int byte = fgetc( this->mFile );
+        if( byte == EOF ) return false;
+        *value |= static_cast<uint64_t>( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ) ) return true;
+    }
+    return false;
+}
+
+bool NWTouchTraceReader::readBinaryRecord( Record *record )
+{
+    int tag = fgetc( this->mFile );
+    if( tag == EOF ) return false;
+
+    uint64_t delta, id;
+    if( !this->readVarint( &delta ) || !this->readVarint( &id ) ) return false;
+    if( !readFloat( this->mFile, &record->sample.x ) ) return false;
+    if( !readFloat( this->mFile, &record->sample.y ) ) return false;
+
+    record->phase = static_cast<NWTouchPhase>( tag & kTagPhaseMask );
+    record->isBatchStart = ( tag & kTagBatchStart ) != 0;
+    record->sample.id = static_cast<int>( zigzagDecode( id ) );
+    record->sample.time = this->mPreviousTime + zigzagDecode( delta );
+    return true;
+}
+
+bool NWTouchTraceReader::readTextRecord( Record *record )
+{
+    char line[256];
+    while( fgets( line, sizeof( line ), this->mFile ) ) {
+        const char *p = line;
+        while( *p == ' ' || *p == '\t' ) ++p;
+        if( *p == '#' || *p == '\n' || *p == '\r' || *p == '\0' ) continue;
+
+        record->isBatchStart = true;
+        if( *p == '+' ) {
+            record->isBatchStart = false;
+            ++p;
+        }
+        const char *phase = strchr( kPhaseChars, *p );
+        if( !phase || *p == '\0' ) return false;
+        record->phase = static_cast<NWTouchPhase>( phase - kPhaseChars );
+
+        long long time;
+        if( sscanf( p + 1, "%lld %d %f %f", &time, &record->sample.id,
+                    &record->sample.x, &record->sample.y ) != 4 ) {
+            return false;
+        }
+        record->sample.time = time;
+        return true;
+    }
+    return false;
+}
+
+bool NWTouchTraceReader::readRecord( Record *record )
+{
+    if( !this->mFile ) return false;
+    bool result = this->mIsText ? this->readTextRecord( record ) : this->readBinaryRecord( record );
+    if( result ) this->mPreviousTime = record->sample.time;
+    return result;
+}
+
+bool NWTouchTraceReader::readBatch( NWTouchPhase *phase, vector<NWTouchSample> *samples )
+{
+    samples->clear();
+
+    Record record;
+    if( this->mHasPending ) {
+        record = this->mPending;
+        this->mHasPending = false;
+    } else if( !this->readRecord( &record ) ) {
+        return false;
+    }
+
+    *phase = record.phase;
+    samples->push_back( record.sample );
+
+    // the rest of the batch.
+    while( this->readRecord( &record ) ) {
+        if( record.isBatchStart || record.phase != *phase ) {
+            this->mPending = record;
+            this->mHasPending = true;
+            break;
+        }
+        samples->push_back( record.sample );
+    }
+    return true;
+}
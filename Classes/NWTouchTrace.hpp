@@ -0,0 +1,114 @@
+//
+//  NWTouchTrace.hpp
+//  NoviceWorks
+//
+//  Record and replay of the raw touch events.
+//
+//
+
+#ifndef __NWTouchTrace__
+#define __NWTouchTrace__
+
+#include <cstdio>
+#include <vector>
+
+#include "NWGestureRecognizer.hpp"
+
+/**
+ *  Touch trace file.
+ *
+ *  Binary format (little endian):
+ *      header  "NWTR", u8 version(1), u8[3] reserved
+ *      record  u8  tag         bit0-1: NWTouchPhase, bit2: first of a batch
+ *              varint          zigzag of time delta from previous record (ns)
+ *              varint          zigzag of touch id
+ *              f32 x, f32 y
+ *
+ *  Text format:
+ *      first line "#NWTR text 1", then a record per line.
+ *      "<B|M|E|C> <time ns> <id> <x> <y>". "+" before the phase letter
+ *      means the record belongs to the batch of the previous line.
+ *      lines starting with "#" are comments.
+ *
+ *  a batch is the touches of one touch event (one touchesXXX call).
+ */
+
+/**
+ *  @class  NWTouchTraceWriter
+ *  @brief  NWTouchRecorder writing a trace file.
+ */
+class NWTouchTraceWriter : public NWTouchRecorder
+{
+public:
+    enum Format {
+        BINARY,
+        TEXT,
+    };
+
+    NWTouchTraceWriter();
+    virtual ~NWTouchTraceWriter();
+
+    bool open( const char *path, Format format = BINARY );
+    void close();
+    bool isOpen() const {
+        return this->mFile != NULL;
+    }
+
+    virtual void record( NWTouchPhase phase, const NWTouchSample *samples, int count );
+
+private:
+    FILE   *mFile;
+    Format  mFormat;
+    NWTime  mPreviousTime;
+
+    void writeVarint( uint64_t value );
+
+    // noncopyable
+    NWTouchTraceWriter( const NWTouchTraceWriter& );
+    NWTouchTraceWriter& operator=( const NWTouchTraceWriter& );
+};
+
+/**
+ *  @class  NWTouchTraceReader
+ *  @brief  Read a trace file batch by batch. format is detected.
+ */
+class NWTouchTraceReader
+{
+public:
+    NWTouchTraceReader();
+    ~NWTouchTraceReader();
+
+    bool open( const char *path );
+    void close();
+
+    /**
+     *  Read the next batch.
+     *  @return false at the end of file or on a broken record.
+     */
+    bool readBatch( NWTouchPhase *phase, std::vector<NWTouchSample> *samples );
+
+private:
+    struct Record {
+        NWTouchPhase    phase;
+        bool            isBatchStart;
+        NWTouchSample   sample;
+    };
+
+    FILE   *mFile;
+    bool    mIsText;
+    NWTime  mPreviousTime;
+    bool    mHasPending;
+    Record  mPending;
+
+    bool readRecord( Record *record );
+    bool readBinaryRecord( Record *record );
+    bool readTextRecord( Record *record );
+    bool readVarint( uint64_t *value );
+
+    // noncopyable
+    NWTouchTraceReader( const NWTouchTraceReader& );
+    NWTouchTraceReader& operator=( const NWTouchTraceReader& );
+};
+
+
+#endif /* defined(__NWTouchTrace__) */
@@ -0,0 +1,74 @@
+//
+//  NWVelocityTracker.cpp
+//  NoviceWorks
+//
+//  Release velocity of a touch.
+//
+//
+
+// myclass
+#include "NWVelocityTracker.hpp"
+
+
+NWVelocityTracker::NWVelocityTracker() :
+  mHead( -1 )
+, mSize( 0 )
+{
+}
+
+void NWVelocityTracker::clear()
+{
+    this->mHead = -1;
+    this->mSize = 0;
+}
+
+void NWVelocityTracker::addSample( float x, float y, NWTime time )
+{
+    this->mHead = ( this->mHead + 1 ) % SAMPLES;
+    this->mX[ this->mHead ] = x;
+    this->mY[ this->mHead ] = y;
+    this->mTime[ this->mHead ] = time;
+    if( this->mSize < SAMPLES ) ++this->mSize;
+}
+
+bool NWVelocityTracker::getVelocity( float *vx, float *vy ) const
+{
+    *vx = 0.0f;
+    *vy = 0.0f;
+    if( this->mSize < 2 ) return false;
+
+    // time is relative to the latest sample, in sec.
+    NWTime latest = this->mTime[ this->mHead ];
+    double sum_t = 0.0, sum_x = 0.0, sum_y = 0.0;
+    double sum_tt = 0.0, sum_tx = 0.0, sum_ty = 0.0;
+    int n = 0;
+
+    NWTime newer = latest;
+    for( int i = 0; i < this->mSize; ++i ) {
+        int index = ( this->mHead - i + SAMPLES ) % SAMPLES;
+        NWTime time = this->mTime[ index ];
+        if( latest - time > HORIZON ) break;
+        if( newer - time > STOP_GAP ) break;     // finger stopped there.
+        newer = time;
+
+        double t = NWTimeToSec( time - latest );
+        double x = this->mX[ index ];
+        double y = this->mY[ index ];
+        sum_t  += t;
+        sum_x  += x;
+        sum_y  += y;
+        sum_tt += t * t;
+        sum_tx += t * x;
+        sum_ty += t * y;
+        ++n;
+    }
+    if( n < 2 ) return false;
+
+    // slope of least squares line.
+    double denominator = n * sum_tt - sum_t * sum_t;
+    if( denominator <= 0.0 ) return false;
+
+    *vx = static_cast<float>( ( n * sum_tx - sum_t * sum_x ) / denominator );
+    *vy = static_cast<float>( ( n * sum_ty - sum_t * sum_y ) / denominator );
+    return true;
+}
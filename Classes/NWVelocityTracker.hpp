@@ -0,0 +1,52 @@
+//
+//  NWVelocityTracker.hpp
+//  NoviceWorks
+//
+//  Release velocity of a touch.
+//
+//
+
+#ifndef __NWVelocityTracker__
+#define __NWVelocityTracker__
+
+#include "NWGestureClock.hpp"
+
+/**
+ *  @class  NWVelocityTracker
+ *  @brief  Estimate the velocity of a touch from its recent samples.
+ *
+ *  Keeps the last SAMPLES samples, and fits a straight line to x(t) and y(t)
+ *  by least squares over the samples within HORIZON of the latest one.
+ *  like the velocity tracker of the platforms, a pause longer than
+ *  STOP_GAP before the latest sample is treated as the finger stopped.
+ */
+class NWVelocityTracker
+{
+public:
+    static const int SAMPLES = 20;
+
+    NWVelocityTracker();
+
+    void clear();
+    void addSample( float x, float y, NWTime time );
+
+    /**
+     *  Get the velocity at the latest sample.
+     *  @param  vx, vy  px per sec. 0 if it can't be estimated.
+     *  @return false if there are not enough samples.
+     */
+    bool getVelocity( float *vx, float *vy ) const;
+
+private:
+    static const NWTime HORIZON  = 100000000;     // 100 ms
+    static const NWTime STOP_GAP = 40000000;      // 40 ms
+
+    float   mX[ SAMPLES ];
+    float   mY[ SAMPLES ];
+    NWTime  mTime[ SAMPLES ];
+    int     mHead;      // index of the latest sample.
+    int     mSize;
+};
+
+
+#endif /* defined(__NWVelocityTracker__) */
@@ -48,6 +48,7 @@ CCScene* TestScene::scene()
 TestScene::TestScene() :
   mSpriteDroid( NULL )
 , mBaseScale( 0.0f )
+, mBaseRotation( 0.0f )
 {
     CCLOG( "TestScene: constructor" );
 }
@@ -142,22 +143,20 @@ void TestScene::onScroll( CCPoint &touchPoint, int id )
     CCLOG( "onScroll[%d](%6.2f, %6.2f)", id, touchPoint.x, touchPoint.y );
     this->mSpriteDroid->setPosition( ccp( touchPoint.x, touchPoint.y ) );
 }
-void TestScene::onFlick( CCPoint &touchPoint, int id, int direction )
+void TestScene::onFlick( CCPoint &touchPoint, int id, int direction, float vx, float vy )
 {
     string str_dir = getStrDirection( direction );
-    CCLOG( "onFlick[%d](%6.2f, %6.2f) Direction: %s", id, touchPoint.x, touchPoint.y, str_dir.c_str() );
+    CCLOG( "onFlick[%d](%6.2f, %6.2f) Direction: %s Velocity: (%.1f, %.1f)",
+           id, touchPoint.x, touchPoint.y, str_dir.c_str(), vx, vy );
     
     //*/
-    float distance = this->getTotalDistance( id );
-    float angle = touchPoint.getAngle();
-    
-    float x = distance * cosf( angle );
-    float y = distance * sinf( angle );
-    if( this->isLeftDir( direction ) ) x = -x;
-    if( this->isDownDir( direction ) ) y = -y;
+    // slide out at the release velocity. EaseOut(rate 3) starts at 3x of average speed.
+    const float duration = 0.5f;
+    float x = vx * duration / 3.0f;
+    float y = vy * duration / 3.0f;
 
     this->mSpriteDroid->setPosition( touchPoint );
-    CCMoveBy *moveby = CCMoveBy::create( 0.5f, CCPoint( x, y ) );
+    CCMoveBy *moveby = CCMoveBy::create( duration, CCPoint( x, y ) );
     CCEaseOut *ease  = CCEaseOut::create( moveby, 3 );
     
     this->mSpriteDroid->runAction( ease );
@@ -220,6 +219,15 @@ void TestScene::onPinchEnded( float magnification, int id1, int id2 )
     this->mIsPinchAction = false;
     CCLOG( "onPinchEnded[%d>-<%d] Magnification: %.3f", id1, id2, magnification );
 }
+void TestScene::onTransform( const NWTransform &transform )
+{
+    // called before onPinchAction of the same frame.
+    if( !this->mIsPinchAction ) {
+        this->mBaseRotation = this->mSpriteDroid->getRotation();
+    }
+    // cocos2d-x rotation is clockwise degree.
+    this->mSpriteDroid->setRotation( this->mBaseRotation - CC_RADIANS_TO_DEGREES( transform.rotation ) );
+}
 
 #pragma -mark Menu Selector.
 // Menu Selector: goto Title.
@@ -37,7 +37,8 @@ public:
     
     virtual void onHold( CCPoint &touchPoint, int id );
     virtual void onScroll( CCPoint &touchPoint, int id );
-    virtual void onFlick( CCPoint &touchPoint, int id, int direction );
+    using NWGestureLayer::onFlick;
+    virtual void onFlick( CCPoint &touchPoint, int id, int direction, float vx, float vy );
     virtual void onSwipe( CCPoint &touchPoint, int id, int direction );
     virtual void onDrag( CCPoint &touchPoint, int id );
     virtual void onDragEnded( CCPoint &touchPoint, int id );
@@ -46,6 +47,7 @@ public:
     virtual void onPinchOut( float magnification, int id1, int id2 );
     virtual void onPinchAction( float magnification, int id1, int id2 );
     virtual void onPinchEnded( float magnification, int id1, int id2 );
+    virtual void onTransform( const NWTransform &transform );
     
     
     virtual void keyBackClicked(void);
@@ -56,6 +58,7 @@ private:
     
     bool        mIsPinchAction;
     float       mBaseScale;
+    float       mBaseRotation;
 };
 
 
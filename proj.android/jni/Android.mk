@@ -9,6 +9,19 @@ LOCAL_MODULE_FILENAME := libcocos2dcpp
 LOCAL_SRC_FILES := hellocpp/main.cpp \
                    ../../Classes/AppDelegate.cpp \
                    ../../Classes/NWGestureLayer.cpp \
+                   ../../Classes/NWGeometry.cpp \
+                   ../../Classes/NWGestureArbiter.cpp \
+                   ../../Classes/NWGestureClock.cpp \
+                   ../../Classes/NWGestureEventQueue.cpp \
+                   ../../Classes/NWGestureRecognizer.cpp \
+                   ../../Classes/NWGestureRouter.cpp \
+                   ../../Classes/NWGestureStats.cpp \
+                   ../../Classes/NWGestureThread.cpp \
+                   ../../Classes/NWStandardRecognizers.cpp \
+                   ../../Classes/NWStrokeMatcher.cpp \
+                   ../../Classes/NWTouchFilter.cpp \
+                   ../../Classes/NWTouchTrace.cpp \
+                   ../../Classes/NWVelocityTracker.cpp \
                    ../../Classes/TestScene.cpp
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../Classes
@@ -0,0 +1,639 @@
+//
+//  nwgesture_bench.cpp
+//  NoviceWorks
+//
+//  Per-event cost of NWGestureRecognizer on synthetic touch workloads.
+//  *_basic workloads run NWBasicGestureRecognizer with only the gestures they use.
+//
+//  usage: nwgesture_bench [-s scale] [filter]
+//      -s <n>      multiply the number of events (default 1)
+//      filter      run only the workloads whose name contains this
+//
+//  reports ns/event, heap allocations/event and peak heap of each workload.
+//  an event is one touch sample, or one update() call for the timer workload,
+//  or one finger-up match for stroke_match, or one kernel call for path_kernels.
+//  path_kernels also checks the NWGeometry kernels against their scalar code,
+//  and stalled_threaded checks that no finger is left down when the gestures aren't taken.
+//  main_cpu_ns/event is the CPU time of the main thread only, which differs
+//  from ns/event on the *_threaded workloads (NW_GESTURE_THREADED).
+//
+
+// std & platform
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <vector>
+
+// myclass
+#include "NWBasicGestureRecognizer.hpp"
+#include "NWGeometry.hpp"
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureRouter.hpp"
+#include "NWGestureThread.hpp"
+#include "NWStrokeMatcher.hpp"
+
+#if NW_GESTURE_THREADED
+#include <chrono>
+#include <thread>
+#endif
+
+
+using std::vector;
+
+
+#pragma -mark Allocation Counter
+namespace {
+
+// every allocation has this header to know the size at delete.
+const size_t kHeaderSize = 16;
+
+size_t sAllocCount = 0;
+size_t sLiveBytes  = 0;
+size_t sPeakBytes  = 0;
+
+void* countedAlloc( size_t size )
+{
+    void *p = malloc( size + kHeaderSize );
+    if( !p ) throw std::bad_alloc();
+    *static_cast<size_t*>( p ) = size;
+    ++sAllocCount;
+    sLiveBytes += size;
+    if( sLiveBytes > sPeakBytes ) sPeakBytes = sLiveBytes;
+    return static_cast<char*>( p ) + kHeaderSize;
+}
+
+void countedFree( void *p )
+{
+    if( !p ) return;
+    char *block = static_cast<char*>( p ) - kHeaderSize;
+    sLiveBytes -= *reinterpret_cast<size_t*>( block );
+    free( block );
+}
+
+} // unnamed namespace
+
+void* operator new( size_t size )           { return countedAlloc( size ); }
+void* operator new[]( size_t size )         { return countedAlloc( size ); }
+void operator delete( void *p ) throw()     { countedFree( p ); }
+void operator delete[]( void *p ) throw()   { countedFree( p ); }
+void operator delete( void *p, size_t ) throw()     { countedFree( p ); }
+void operator delete[]( void *p, size_t ) throw()   { countedFree( p ); }
+
+
+namespace {
+
+#pragma -mark Workload
+const NWTime kFrame = 8333333;     // 120 Hz input.
+
+// set if a workload fails its check. the exit status is 1 then.
+bool sHasMismatch = false;
+
+// count the gestures, so that the callbacks are not optimized out.
+class CountListener : public NWGestureListener {
+public:
+    long count;
+    CountListener() : count( 0 ) {}
+
+    virtual void onSingleTap( const NWPoint &p )                { ++count; }
+    virtual void onDoubleTap( const NWPoint &p )                { ++count; }
+    virtual void onDown( const NWPoint &p, int id )             { ++count; }
+    virtual void onHold( const NWPoint &p, int id )             { ++count; }
+    virtual void onTap( const NWPoint &p, int id )              { ++count; }
+    virtual void onCancelled( const NWPoint &p, int id )        { ++count; }
+    virtual void onScroll( const NWPoint &p, int id )           { ++count; }
+    virtual void onFlick( const NWPoint &p, int id, int d, float vx, float vy ) { ++count; }
+    virtual void onSwipe( const NWPoint &p, int id, int d )     { ++count; }
+    virtual void onDrag( const NWPoint &p, int id )             { ++count; }
+    virtual void onDragEnded( const NWPoint &p, int id )        { ++count; }
+    virtual void onPinchIn( float m, int id1, int id2 )         { ++count; }
+    virtual void onPinchOut( float m, int id1, int id2 )        { ++count; }
+    virtual void onPinchAction( float m, int id1, int id2 )     { ++count; }
+    virtual void onPinchEnded( float m, int id1, int id2 )      { ++count; }
+    virtual void onTransform( const NWTransform &t )            { ++count; }
+    virtual void onTransformEnded( const NWTransform &t )       { ++count; }
+};
+
+// the same for NWBasicGestureRecognizer: Tap, DoubleTap and Scroll.
+class CountHandler : public NWGestureHandler {
+public:
+    explicit CountHandler( long *count ) : mCount( count ) {}
+
+    void onSingleTap( const NWPoint &p )                { ++*mCount; }
+    void onDoubleTap( const NWPoint &p )                { ++*mCount; }
+    void onDown( const NWPoint &p, int id )             { ++*mCount; }
+    void onTap( const NWPoint &p, int id )              { ++*mCount; }
+    void onCancelled( const NWPoint &p, int id )        { ++*mCount; }
+    void onScroll( const NWPoint &p, int id )           { ++*mCount; }
+    void onFlick( const NWPoint &p, int id, int d, float vx, float vy ) { ++*mCount; }
+    void onSwipe( const NWPoint &p, int id, int d )     { ++*mCount; }
+
+private:
+    long *mCount;
+};
+
+/**
+ *  One benchmark run. owns the recognizer on a virtual clock.
+ */
+struct Bench {
+    NWManualClock       clock;
+    CountListener       listener;
+    NWGestureRecognizer recognizer;
+    vector<NWTouchSample> samples;
+    long                events;
+
+    Bench() : events( 0 ) {
+        recognizer.setClock( &clock );
+        recognizer.setListener( &listener );
+        recognizer.setDistanceThresholdForMoved( 20.0f );
+        samples.reserve( NWGestureRecognizer::MAX_TOUCHES );
+    }
+
+    void add( int id, float x, float y ) {
+        NWTouchSample sample = { id, x, y, clock.now() };
+        samples.push_back( sample );
+    }
+    void feed( NWTouchPhase phase )     { this->feed( phase, &recognizer ); }
+    void frame()                        { this->frame( &recognizer ); }
+
+    // Driver: NWGestureRecognizer or NWBasicGestureRecognizer on this clock.
+    template <class Driver>
+    void feed( NWTouchPhase phase, Driver *driver ) {
+        driver->touches( phase, &samples[0], samples.size() );
+        events += samples.size();
+        samples.clear();
+    }
+    template <class Driver>
+    void frame( Driver *driver ) {
+        clock.advance( kFrame );
+        NWTime deadline = driver->getNextDeadline();
+        if( deadline >= 0 && deadline <= clock.now() ) driver->update();
+    }
+};
+
+// N fingers dragging in circles.
+template <class Driver>
+void dragFingers( Bench &b, Driver *driver, int fingers, int frames )
+{
+    for( int f = 0; f < fingers; ++f ) b.add( f, 100.0f + f * 50.0f, 100.0f );
+    b.feed( NW_TOUCH_BEGAN, driver );
+    for( int i = 0; i < frames; ++i ) {
+        b.frame( driver );
+        for( int f = 0; f < fingers; ++f ) {
+            float t = i * 0.05f + f;
+            b.add( f, 100.0f + f * 50.0f + 80.0f * cosf( t ), 300.0f + 80.0f * sinf( t ) );
+        }
+        b.feed( NW_TOUCH_MOVED, driver );
+    }
+    b.frame( driver );
+    for( int f = 0; f < fingers; ++f ) b.add( f, 0.0f, 0.0f );
+    b.feed( NW_TOUCH_ENDED, driver );
+}
+
+void drag1( Bench &b, int scale )   { dragFingers( b, &b.recognizer, 1, 20000 * scale ); }
+void drag2( Bench &b, int scale )   { dragFingers( b, &b.recognizer, 2, 10000 * scale ); }
+void drag5( Bench &b, int scale )   { dragFingers( b, &b.recognizer, 5, 4000 * scale ); }
+void drag10( Bench &b, int scale )  { dragFingers( b, &b.recognizer, 10, 2000 * scale ); }
+
+// drag_1finger on the recognizer of Tap and Scroll only.
+void drag1Basic( Bench &b, int scale )
+{
+    CountHandler handler( &b.listener.count );
+    NWBasicGestureRecognizer<CountHandler, NWGestureTap, NWGestureScroll> recognizer( &handler );
+    recognizer.setClock( &b.clock );
+    recognizer.copyConfig( b.recognizer );
+    dragFingers( b, &recognizer, 1, 20000 * scale );
+}
+
+// one long drag after Hold.
+void longDrag( Bench &b, int scale )
+{
+    b.add( 0, 100.0f, 100.0f );
+    b.feed( NW_TOUCH_BEGAN );
+    for( int i = 0; i < 150; ++i ) b.frame();       // Hold
+    int frames = 100000 * scale;
+    for( int i = 0; i < frames; ++i ) {
+        b.frame();
+        b.add( 0, 100.0f + ( i % 1000 ), 100.0f + ( i % 700 ) );
+        b.feed( NW_TOUCH_MOVED );
+    }
+    b.add( 0, 0.0f, 0.0f );
+    b.feed( NW_TOUCH_ENDED );
+}
+
+void longDragRing( Bench &b, int scale )
+{
+    b.recognizer.setHistoryPolicy( NWHistoryPolicy( 256, 2.0f, 0.0 ) );
+    longDrag( b, scale );
+}
+
+// drag_1finger with the One Euro filter, reading the predicted point per sample.
+void drag1Filtered( Bench &b, int scale )
+{
+    b.recognizer.setFilterPolicy( NWFilterPolicy( 1.0f, 0.05f, 1.0 / 60.0 ) );
+    b.add( 0, 100.0f, 100.0f );
+    b.feed( NW_TOUCH_BEGAN );
+    int frames = 20000 * scale;
+    for( int i = 0; i < frames; ++i ) {
+        b.frame();
+        float t = i * 0.05f;
+        b.add( 0, 100.0f + 80.0f * cosf( t ), 300.0f + 80.0f * sinf( t ) );
+        b.feed( NW_TOUCH_MOVED );
+        NWPoint p = b.recognizer.getPredictedPoint( 0 );
+        if( p.x > 0.0f ) ++b.listener.count;
+    }
+    b.frame();
+    b.add( 0, 0.0f, 0.0f );
+    b.feed( NW_TOUCH_ENDED );
+}
+
+#if NW_GESTURE_THREADED
+// drag_2fingers on NWGestureThread. the main thread only passes the samples
+// and dispatches the gestures; it sleeps while the input ring is full.
+// stop() feeds the samples still in the ring, so the gestures match drag_2fingers.
+void drag2Threaded( Bench &b, int scale )
+{
+    NWMonotonicClock *clock = NWMonotonicClock::sharedClock();
+    b.recognizer.setClock( clock );     // the manual clock isn't thread safe.
+    NWGestureThread thread( &b.recognizer );
+    thread.start();
+
+    NWTouchSample samples[2];
+    int frames = 10000 * scale;
+    for( int i = 0; i <= frames + 1; ++i ) {
+        NWTouchPhase phase = i == 0 ? NW_TOUCH_BEGAN : i > frames ? NW_TOUCH_ENDED : NW_TOUCH_MOVED;
+        for( int f = 0; f < 2; ++f ) {
+            float t = i * 0.05f + f;
+            NWTouchSample sample = { f, 100.0f + f * 50.0f + 80.0f * cosf( t ),
+                                     300.0f + 80.0f * sinf( t ), clock->now() };
+            samples[f] = sample;
+        }
+        while( !thread.touches( phase, samples, 2 ) ) {
+            thread.dispatchEvents( &b.listener );
+            std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+        }
+        b.events += 2;
+        thread.dispatchEvents( &b.listener );
+    }
+    thread.stop();
+    thread.dispatchEvents( &b.listener );
+}
+
+// drag_2fingers on NWGestureThread while the main thread takes no gesture,
+// until the input ring is full. the ends must still fit, and no finger is down after stop().
+void stalledThreaded( Bench &b, int scale )
+{
+    NWMonotonicClock *clock = NWMonotonicClock::sharedClock();
+    b.recognizer.setClock( clock );
+    NWGestureThread thread( &b.recognizer );
+    thread.start();
+
+    NWTouchSample samples[2];
+    int rounds = 20 * scale;
+    bool is_ended = true;
+    for( int r = 0; r < rounds; ++r ) {
+        NWTouchPhase phase = NW_TOUCH_BEGAN;
+        for( int i = 0; ; ++i ) {
+            for( int f = 0; f < 2; ++f ) {
+                float t = i * 0.05f + f;
+                NWTouchSample sample = { f, 100.0f + f * 50.0f + 80.0f * cosf( t ),
+                                         300.0f + 80.0f * sinf( t ), clock->now() };
+                samples[f] = sample;
+            }
+            // the worker stops reading when mOutput is full: wait for that.
+            bool is_pushed = thread.touches( phase, samples, 2 );
+            for( int retry = 0; !is_pushed && retry < 2; ++retry ) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+                is_pushed = thread.touches( phase, samples, 2 );
+            }
+            if( !is_pushed ) {
+                if( phase == NW_TOUCH_BEGAN ) is_ended = false;
+                break;
+            }
+            b.events += 2;
+            phase = NW_TOUCH_MOVED;
+        }
+        if( !thread.touches( NW_TOUCH_ENDED, samples, 2 ) ) is_ended = false;
+        b.events += 2;
+
+        thread.stop();
+        thread.dispatchEvents( &b.listener );
+        for( int f = 0; f < 2; ++f ) {
+            if( b.recognizer.getTouchHistory( f ) ) is_ended = false;
+        }
+        thread.start();
+    }
+    thread.stop();
+    if( !is_ended ) {
+        fprintf( stderr, "stalled_threaded: a finger is left down\n" );
+        sHasMismatch = true;
+    }
+}
+#endif
+
+// rapid taps by all fingers in turn.
+template <class Driver>
+void tapFingers( Bench &b, Driver *driver, int scale )
+{
+    int taps = 20000 * scale;
+    for( int i = 0; i < taps; ++i ) {
+        int id = i % NWGestureRecognizer::MAX_TOUCHES;
+        float x = 50.0f + ( i % 13 ) * 40.0f;
+        b.add( id, x, 200.0f );
+        b.feed( NW_TOUCH_BEGAN, driver );
+        b.frame( driver );
+        b.add( id, x + 1.0f, 200.0f );
+        b.feed( NW_TOUCH_ENDED, driver );
+        b.frame( driver );
+    }
+}
+
+void tapStorm( Bench &b, int scale )    { tapFingers( b, &b.recognizer, scale ); }
+
+// tap_storm on the recognizer of Tap and DoubleTap only.
+void tapStormBasic( Bench &b, int scale )
+{
+    CountHandler handler( &b.listener.count );
+    NWBasicGestureRecognizer<CountHandler, NWGestureTap, NWGestureDoubleTap, NWGestureMultiTouch> recognizer( &handler );
+    recognizer.setClock( &b.clock );
+    recognizer.copyConfig( b.recognizer );
+    tapFingers( b, &recognizer, scale );
+}
+
+// tap_storm routed to 1000 targets of 40x40px on a 1280x720 screen.
+void tapStormTargets( Bench &b, int scale )
+{
+    NWGestureRouter router;
+    router.setBounds( NWRect( 0.0f, 0.0f, 1280.0f, 720.0f ), 73.0f );
+    router.setFallbackListener( &b.listener );
+    for( int i = 0; i < 1000; ++i ) {
+        float x = static_cast<float>( ( i * 7919 ) % 1240 );
+        float y = static_cast<float>( ( i * 104729 ) % 680 );
+        router.addTarget( NWRect( x, y, 40.0f, 40.0f ), &b.listener, ~0u, i % 3 );
+    }
+    b.recognizer.setListener( &router );
+    tapStorm( b, scale );
+}
+
+// two fingers pinching in and out.
+void pinch( Bench &b, int scale )
+{
+    b.add( 0, 200.0f, 300.0f );
+    b.add( 1, 400.0f, 300.0f );
+    b.feed( NW_TOUCH_BEGAN );
+    int frames = 20000 * scale;
+    for( int i = 0; i < frames; ++i ) {
+        b.frame();
+        float spread = 100.0f + 80.0f * sinf( i * 0.02f );
+        b.add( 0, 300.0f - spread, 300.0f );
+        b.add( 1, 300.0f + spread, 300.0f );
+        b.feed( NW_TOUCH_MOVED );
+    }
+    b.add( 0, 0.0f, 0.0f );
+    b.add( 1, 0.0f, 0.0f );
+    b.feed( NW_TOUCH_ENDED );
+}
+
+// two players pinching at once on both sides of the screen.
+void pinch2Groups( Bench &b, int scale )
+{
+    b.recognizer.setDistanceThresholdForGroup( 300.0f );
+    for( int p = 0; p < 2; ++p ) {
+        b.add( p * 2,     200.0f + p * 800.0f, 300.0f );
+        b.add( p * 2 + 1, 400.0f + p * 800.0f, 300.0f );
+    }
+    b.feed( NW_TOUCH_BEGAN );
+    int frames = 10000 * scale;
+    for( int i = 0; i < frames; ++i ) {
+        b.frame();
+        for( int p = 0; p < 2; ++p ) {
+            float spread = 100.0f + 80.0f * sinf( i * 0.02f + p );
+            b.add( p * 2,     300.0f + p * 800.0f - spread, 300.0f );
+            b.add( p * 2 + 1, 300.0f + p * 800.0f + spread, 300.0f );
+        }
+        b.feed( NW_TOUCH_MOVED );
+    }
+    for( int f = 0; f < 4; ++f ) b.add( f, 0.0f, 0.0f );
+    b.feed( NW_TOUCH_ENDED );
+}
+
+// timer path: fingers resting, update() every frame.
+void holdUpdate( Bench &b, int scale )
+{
+    for( int f = 0; f < NWGestureRecognizer::MAX_TOUCHES; ++f ) b.add( f, f * 60.0f, 100.0f );
+    b.feed( NW_TOUCH_BEGAN );
+    b.events = 0;
+    int frames = 200000 * scale;
+    for( int i = 0; i < frames; ++i ) {
+        b.clock.advance( kFrame );
+        b.recognizer.update();
+        ++b.events;
+    }
+}
+
+// shape i of stroke_match: a rose curve drawn from a different start.
+void strokeShape( int i, float noise, NWPoint *points, int count )
+{
+    int petals = 1 + i % 7;
+    float start = ( i / 7 ) * 0.19f;
+    for( int k = 0; k < count; ++k ) {
+        float t = start + 6.2831853f * k / ( count - 1 );
+        float r = 100.0f + 60.0f * cosf( petals * t ) + noise * sinf( k * 12.9898f );
+        points[k] = NWPoint( 300.0f + r * cosf( t ), 300.0f + r * sinf( t ) );
+    }
+}
+
+// finger-up matching of 256 stroke templates.
+void strokeMatch( Bench &b, int scale )
+{
+    const int templates = 256;
+    const int count = 96;
+    NWPoint points[ count ];
+    NWStrokeMatcher matcher;
+    matcher.reserve( templates );
+    for( int i = 0; i < templates; ++i ) {
+        strokeShape( i, 0.0f, points, count );
+        matcher.addTemplate( "shape", points, count );
+    }
+
+    NWStrokeMatch match;
+    int strokes = 2000 * scale;
+    for( int i = 0; i < strokes; ++i ) {
+        strokeShape( ( i * 37 ) % templates, 4.0f, points, count );
+        if( matcher.match( points, count, &match ) ) ++b.listener.count;
+        ++b.events;
+    }
+}
+
+// true if the kernel is close enough to the scalar code.
+bool isNear( float value, float expected, float tolerance )
+{
+    return fabsf( value - expected ) <= tolerance * ( 1.0f + fabsf( expected ) );
+}
+
+// NWGeometry kernels over a long stroke of 4096 points.
+void pathKernels( Bench &b, int scale, bool is_scalar )
+{
+    const int count = 4096;
+    const int resampled = 64;
+    vector<float> xs( count ), ys( count );
+    for( int i = 0; i < count; ++i ) {
+        float t = i * 0.01f;
+        xs[i] = 300.0f + 200.0f * cosf( t ) + 20.0f * sinf( t * 7.0f );
+        ys[i] = 300.0f + 200.0f * sinf( t ) + 20.0f * cosf( t * 5.0f );
+    }
+    float rx[ resampled ], ry[ resampled ];
+    float sx[ resampled ], sy[ resampled ];
+
+    int rounds = 500 * scale;
+    bool is_matched = true;
+    for( int r = 0; r < rounds; ++r ) {
+        float length;
+        NWRect box;
+        NWPoint centroid;
+        float dot, cross;
+        if( is_scalar ) {
+            length = NWPathLengthScalar( &xs[0], &ys[0], count );
+            box = NWBoundingBoxScalar( &xs[0], &ys[0], count );
+            centroid = NWCentroidScalar( &xs[0], &ys[0], count );
+            NWResampleScalar( &xs[0], &ys[0], count, rx, ry, resampled );
+            NWDotCrossScalar( &xs[0], &ys[0], &ys[0], &xs[0], count, &dot, &cross );
+        } else {
+            length = NWPathLength( &xs[0], &ys[0], count );
+            box = NWBoundingBox( &xs[0], &ys[0], count );
+            centroid = NWCentroid( &xs[0], &ys[0], count );
+            NWResample( &xs[0], &ys[0], count, rx, ry, resampled );
+            NWDotCross( &xs[0], &ys[0], &ys[0], &xs[0], count, &dot, &cross );
+        }
+        b.events += 5;
+        if( length > 0.0f ) ++b.listener.count;
+
+        if( r > 0 || is_scalar ) continue;
+        NWRect sbox = NWBoundingBoxScalar( &xs[0], &ys[0], count );
+        NWPoint scentroid = NWCentroidScalar( &xs[0], &ys[0], count );
+        float sdot, scross;
+        NWDotCrossScalar( &xs[0], &ys[0], &ys[0], &xs[0], count, &sdot, &scross );
+        NWResampleScalar( &xs[0], &ys[0], count, sx, sy, resampled );
+        is_matched = isNear( length, NWPathLengthScalar( &xs[0], &ys[0], count ), 1e-4f ) &&
+                     box.x == sbox.x && box.y == sbox.y &&
+                     box.width == sbox.width && box.height == sbox.height &&
+                     isNear( centroid.x, scentroid.x, 1e-4f ) && isNear( centroid.y, scentroid.y, 1e-4f ) &&
+                     isNear( dot, sdot, 1e-4f ) && isNear( cross, scross, 1e-4f );
+        for( int i = 0; i < resampled; ++i ) {
+            if( !isNear( rx[i], sx[i], 1e-3f ) || !isNear( ry[i], sy[i], 1e-3f ) ) is_matched = false;
+        }
+    }
+    if( !is_matched ) {
+        fprintf( stderr, "path_kernels: %s differs from the scalar code\n", NWGeometryBackend() );
+        sHasMismatch = true;
+    }
+}
+
+void pathKernelsSimd( Bench &b, int scale )     { pathKernels( b, scale, false ); }
+void pathKernelsScalar( Bench &b, int scale )   { pathKernels( b, scale, true ); }
+
+
+#pragma -mark Runner
+struct Workload {
+    const char *name;
+    void (*run)( Bench &b, int scale );
+};
+
+const Workload kWorkloads[] = {
+    { "drag_1finger",       drag1 },
+    { "drag_1finger_basic", drag1Basic },
+    { "drag_1finger_filtered", drag1Filtered },
+    { "drag_2fingers",      drag2 },
+    { "drag_5fingers",      drag5 },
+    { "drag_10fingers",     drag10 },
+#if NW_GESTURE_THREADED
+    { "drag_2fingers_threaded", drag2Threaded },
+    { "stalled_threaded",   stalledThreaded },
+#endif
+    { "long_drag",          longDrag },
+    { "long_drag_ring",     longDragRing },
+    { "tap_storm",          tapStorm },
+    { "tap_storm_basic",    tapStormBasic },
+    { "tap_storm_1000targets", tapStormTargets },
+    { "pinch",              pinch },
+    { "pinch_2groups",      pinch2Groups },
+    { "hold_update",        holdUpdate },
+    { "stroke_match_256templates", strokeMatch },
+    { "path_kernels",       pathKernelsSimd },
+    { "path_kernels_scalar", pathKernelsScalar },
+};
+
+// CPU time of the calling thread. -1 if the platform doesn't have it.
+NWTime threadCpuTime()
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if( clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts ) == 0 ) {
+        return static_cast<NWTime>( ts.tv_sec ) * 1000000000LL + ts.tv_nsec;
+    }
+#endif
+    return -1;
+}
+
+void runWorkload( const Workload &w, int scale )
+{
+    // warm up the code and the slot buffers.
+    {
+        Bench warmup;
+        w.run( warmup, 1 );
+    }
+
+    Bench *b = new Bench();
+    size_t allocs_before = sAllocCount;
+    size_t base_bytes = sLiveBytes;
+    sPeakBytes = sLiveBytes;
+
+    NWMonotonicClock *clock = NWMonotonicClock::sharedClock();
+    NWTime start = clock->now();
+    NWTime cpu_start = threadCpuTime();
+    w.run( *b, scale );
+    NWTime elapsed = clock->now() - start;
+    NWTime cpu_elapsed = cpu_start >= 0 ? threadCpuTime() - cpu_start : elapsed;
+
+    size_t allocs = sAllocCount - allocs_before;
+    size_t peak = sPeakBytes - base_bytes;
+    long events = b->events > 0 ? b->events : 1;
+    printf( "%-24s %10ld %10.1f %12.1f %12.4f %12lu %10ld\n",
+            w.name, b->events,
+            static_cast<double>( elapsed ) / events,
+            static_cast<double>( cpu_elapsed ) / events,
+            static_cast<double>( allocs ) / events,
+            static_cast<unsigned long>( peak ),
+            b->listener.count );
+    delete b;
+}
+
+} // unnamed namespace
+
+
+int main( int argc, char **argv )
+{
+    int scale = 1;
+    const char *filter = NULL;
+    for( int i = 1; i < argc; ++i ) {
+        if( strcmp( argv[i], "-s" ) == 0 && i + 1 < argc ) scale = atoi( argv[++i] );
+        else if( argv[i][0] != '-' )                       filter = argv[i];
+        else {
+            fprintf( stderr, "usage: nwgesture_bench [-s scale] [filter]\n" );
+            return 2;
+        }
+    }
+    if( scale < 1 ) scale = 1;
+
+    printf( "kernels: %s\n", NWGeometryBackend() );
+    printf( "%-24s %10s %10s %12s %12s %12s %10s\n",
+            "workload", "events", "ns/event", "main_cpu_ns", "allocs/event", "peak_heap_B", "gestures" );
+    int count = sizeof( kWorkloads ) / sizeof( kWorkloads[0] );
+    for( int i = 0; i < count; ++i ) {
+        if( filter && !strstr( kWorkloads[i].name, filter ) ) continue;
+        runWorkload( kWorkloads[i], scale );
+    }
+    return sHasMismatch ? 1 : 0;
+}
@@ -0,0 +1,756 @@
+//
+//  nwgesture_fuzz.cpp
+//  NoviceWorks
+//
+//  Arbitrary touch streams through NWGestureRecognizer, NWBasicGestureRecognizer
+//  and NWGestureArbiter, checking their invariants.
+//
+//  usage: nwgesture_fuzz [-n events] [-s seed] [-l bytes]
+//      -n <n>      stop after about n touch samples (default 2000000)
+//      -s <seed>   first seed of the random inputs (default 1)
+//      -l <bytes>  length of one input (default 4096)
+//
+//  each input is a byte string decoded into a config and a stream of
+//  began / moved / ended / cancelled batches with random ids (small, large
+//  and negative ones), points and time steps (including backward ones), mixed
+//  with update() calls. built with NW_GESTURE_LIBFUZZER=1
+//  (cmake -DNWGESTURE_LIBFUZZER=ON, clang), the same decoder is the
+//  libFuzzer target instead of the random inputs.
+//  each input goes to NWGestureRecognizer, NWBasicGestureRecognizer with all
+//  gestures, and NWGestureArbiter with NWStandardRecognizers.
+//
+//  invariants of both recognizers, checked on the callbacks:
+//  - gestures of a touch come between its onDown and its end, and ids are
+//    not negative. onDown of a touch which hasn't ended is an error.
+//    a touch is dropped only while MAX_TOUCHES touches are down.
+//  - an ended touch has exactly one of onTap, onFlick, onSwipe, onDragEnded,
+//    onCancelled, unless it was a finger of a running multi-touch gesture
+//    (its end is onTransformEnded). a cancelled touch has onCancelled.
+//  - onTransformEnded closes a group opened by onTransform.
+//    Transform, Pinch and Flick values are finite.
+//  - with tentative SingleTap, each onSingleTapTentative is followed by
+//    one onSingleTap or onSingleTapRevoked.
+//  - an ended touch is released when touches() returns, without update(),
+//    unless its id had onTap (a first tap may wait for DoubleTap).
+//  - after cancelling all touches and firing the deadlines, nothing is left:
+//    no touch, no gesture, getNextDeadline() < 0.
+//  - the heap of the recognizer stays under a bound with a ring history,
+//    and goes back under it with any history when all touches are released.
+//
+//  invariants of the arbiter, checked after each call and on the callbacks:
+//  - a finished recognizer stays finished until all fingers are up (a held
+//    one may fail), then it's reset, unless it's held: SingleTap waiting
+//    for DoubleTap.
+//  - two recognizers sharing a finger are not active together unless
+//    allowSimultaneous().
+//  - SingleTap comes only after DoubleTap has failed.
+//  - Hold and Pinch are active exactly between their first and last callbacks,
+//    and the ids of the callbacks are the touches of the arbiter.
+//  - after cancelling all touches and firing the deadlines, all recognizers
+//    are POSSIBLE, no finger is down, getNextDeadline() < 0.
+//  a broken invariant prints the seed and aborts. for the recognizers of
+//  the arbiter, the id is the index of the recognizer in the priority.
+//
+
+// std
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// myclass
+#include "NWBasicGestureRecognizer.hpp"
+#include "NWGestureRecognizer.hpp"
+#include "NWStandardRecognizers.hpp"
+
+#ifndef NW_GESTURE_LIBFUZZER
+#define NW_GESTURE_LIBFUZZER 0
+#endif
+
+
+using std::vector;
+
+
+#pragma -mark Allocation Counter
+// libFuzzer has its own (-rss_limit_mb, -malloc_limit_mb).
+#if !NW_GESTURE_LIBFUZZER
+namespace {
+
+const size_t kHeaderSize = 16;
+size_t sLiveBytes = 0;
+
+void* countedAlloc( size_t size )
+{
+    void *p = malloc( size + kHeaderSize );
+    if( !p ) throw std::bad_alloc();
+    *static_cast<size_t*>( p ) = size;
+    sLiveBytes += size;
+    return static_cast<char*>( p ) + kHeaderSize;
+}
+
+void countedFree( void *p )
+{
+    if( !p ) return;
+    char *block = static_cast<char*>( p ) - kHeaderSize;
+    sLiveBytes -= *reinterpret_cast<size_t*>( block );
+    free( block );
+}
+
+} // unnamed namespace
+
+void* operator new( size_t size )           { return countedAlloc( size ); }
+void* operator new[]( size_t size )         { return countedAlloc( size ); }
+void operator delete( void *p ) throw()     { countedFree( p ); }
+void operator delete[]( void *p ) throw()   { countedFree( p ); }
+void operator delete( void *p, size_t ) throw()     { countedFree( p ); }
+void operator delete[]( void *p, size_t ) throw()   { countedFree( p ); }
+#endif
+
+
+namespace {
+
+const int kMaxTouches = NWGestureRecognizer::MAX_TOUCHES;
+const int kMaxTransforms = NWGestureRecognizer::MAX_TRANSFORMS;
+
+// touch ids of the inputs: -2 to kSmallIds - 1, and kLargeIds from kLargeId.
+const int kSmallIds = 18;
+const int kLargeIds = 32;
+const int kLargeId = 100000;
+const int kIds = kSmallIds + kLargeIds;
+
+int decodeId( int b )
+{
+    return b < 256 - kLargeIds ? b % ( kSmallIds + 2 ) - 2 : kLargeId + b - ( 256 - kLargeIds );
+}
+
+// index of the id in the tables of the checker. -1 if negative.
+int toIndex( int id )
+{
+    if( id < 0 ) return -1;
+    return id < kSmallIds ? id : kSmallIds + id - kLargeId;
+}
+
+int toId( int index )
+{
+    return index < kSmallIds ? index : kLargeId + index - kSmallIds;
+}
+
+// heap of the recognizer with a ring history: the slots, their rings
+// (grown by doubling) and the tracker & filter state. generous.
+const size_t kHeapBound = 256 * 1024;
+
+unsigned long sSeed = 0;        // of the input being run. for the report.
+
+void fail( const char *message, int id )
+{
+    fprintf( stderr, "nwgesture_fuzz: %s (id=%d, seed=%lu)\n", message, id, sSeed );
+    abort();
+}
+
+bool isFinite( float v )
+{
+    return v == v && v - v == 0.0f;     // not NaN, not inf.
+}
+
+void checkPoint( const NWPoint &p )
+{
+    if( !isFinite( p.x ) || !isFinite( p.y ) ) fail( "point isn't finite", -1 );
+}
+
+void checkTransform( const NWTransform &t )
+{
+    if( t.group < 0 || kMaxTransforms <= t.group ) fail( "transform group out of range", t.group );
+    if( !isFinite( t.scale ) || !isFinite( t.rotation ) ||
+        !isFinite( t.translation.x ) || !isFinite( t.translation.y ) ||
+        !isFinite( t.centroid.x ) || !isFinite( t.centroid.y ) ) {
+        fail( "transform isn't finite", t.group );
+    }
+}
+
+
+#pragma -mark Checker
+/**
+ *  Listener which knows which touches are down, and fails on a callback
+ *  which can't happen for them.
+ *  also the Handler of NWBasicGestureRecognizer, whose callbacks have the same names.
+ */
+class Checker : public NWGestureListener {
+public:
+    Checker() : mRecognizer( NULL ), mIsTentative( false ), mIsMultitap( true ), mDownCount( 0 ), mCallbacks( 0 ) {
+        this->mTentatives.reserve( NWGestureRecognizer::MAX_TAP_SEQUENCES * 2 );
+        this->reset( false, true );
+    }
+
+    void reset( bool is_tentative, bool is_multitap ) {
+        for( int i = 0; i < kIds; ++i ) {
+            this->mTouches[i].isDown = false;
+            this->mTouches[i].isTransformed = false;
+            this->mTouches[i].hasTapped = false;
+        }
+        for( int g = 0; g < kMaxTransforms; ++g ) this->mGroups[g] = false;
+        this->mTentatives.clear();
+        this->mIsTentative = is_tentative;
+        this->mIsMultitap = is_multitap;
+        this->mDownCount = 0;
+    }
+
+    // the multi-touch groups are asked to it. NULL: NWBasicGestureRecognizer,
+    // whose fingers are all in group 0.
+    void setRecognizer( const NWGestureRecognizer *recognizer ) { this->mRecognizer = recognizer; }
+
+    bool isDown( int id ) const { return id >= 0 && this->mTouches[ toIndex( id ) ].isDown; }
+    bool hasTapped( int id ) const { return id >= 0 && this->mTouches[ toIndex( id ) ].hasTapped; }
+    long getCallbackCount() const { return this->mCallbacks; }
+
+    // the touches of the batch which were down before it.
+    void beforeTouches( const NWTouchSample *samples, int count, vector<int> *down ) {
+        down->clear();
+        for( int i = 0; i < count; ++i ) {
+            if( this->isDown( samples[i].id ) ) down->push_back( samples[i].id );
+        }
+    }
+
+    // began ones are down unless all slots are. a began one joining a
+    // running multi-touch gesture is a part of it without a callback.
+    // ended ones have their end, or were a part of a multi-touch gesture.
+    void afterTouches( NWTouchPhase phase, const NWTouchSample *samples, int count, const vector<int> &down ) {
+        if( phase == NW_TOUCH_BEGAN ) {
+            for( int i = 0; i < count; ++i ) {
+                int id = samples[i].id;
+                if( this->isDown( id ) ) {
+                    int group = this->getTransformGroup( id );
+                    if( group >= 0 && this->mGroups[ group ] ) this->mTouches[ toIndex( id ) ].isTransformed = true;
+                    continue;
+                }
+                if( id < 0 || ( !this->mIsMultitap && id ) ) continue;
+                if( this->mDownCount < kMaxTouches ) fail( "dropped while a slot is free", id );
+            }
+        }
+        if( phase != NW_TOUCH_ENDED && phase != NW_TOUCH_CANCELLED ) return;
+        for( size_t i = 0; i < down.size(); ++i ) {
+            Touch &touch = this->mTouches[ toIndex( down[i] ) ];
+            if( !touch.isDown ) continue;
+            if( phase == NW_TOUCH_CANCELLED ) fail( "cancelled without onCancelled", down[i] );
+            if( !touch.isTransformed ) fail( "ended without a gesture", down[i] );
+            touch.isDown = false;
+            --this->mDownCount;
+        }
+    }
+
+    // all cancelled and all deadlines fired.
+    void finish( NWTime next_deadline ) {
+        for( int i = 0; i < kIds; ++i ) {
+            if( this->mTouches[i].isDown ) fail( "touch left after cancelling all", i );
+        }
+        for( int g = 0; g < kMaxTransforms; ++g ) {
+            if( this->mGroups[g] ) fail( "transform left after cancelling all", g );
+        }
+        if( !this->mTentatives.empty() ) fail( "tentative SingleTap never settled", -1 );
+        if( next_deadline >= 0 ) fail( "deadline left after firing all", -1 );
+    }
+
+    // DoubleTap on 2 of 3 columns, to have both the waiting and the immediate SingleTap.
+    virtual bool isDoubleTapSupport( const NWPoint &p ) {
+        return static_cast<int>( p.x / 64.0f ) % 3 != 0;
+    }
+
+    virtual void onSingleTap( const NWPoint &p ) {
+        this->point( p );
+        if( this->mIsTentative && this->isDoubleTapSupport( p ) ) this->settle( p );
+    }
+    virtual void onDoubleTap( const NWPoint &p )            { this->point( p ); }
+    virtual void onSingleTapTentative( const NWPoint &p ) {
+        this->point( p );
+        if( !this->mIsTentative ) fail( "tentative SingleTap while it's off", -1 );
+        this->mTentatives.push_back( p );
+    }
+    virtual void onSingleTapRevoked( const NWPoint &p ) {
+        this->point( p );
+        this->settle( p );
+    }
+
+    virtual void onDown( const NWPoint &p, int id ) {
+        this->point( p );
+        if( id < 0 ) fail( "onDown of negative id", id );
+        Touch &touch = this->mTouches[ toIndex( id ) ];
+        if( touch.isDown ) fail( "onDown twice without an end", id );
+        if( ++this->mDownCount > kMaxTouches ) fail( "more touches down than slots", id );
+        touch.isDown = true;
+        touch.isTransformed = false;
+    }
+    virtual void onHold( const NWPoint &p, int id )         { this->touch( p, id ); }
+    virtual void onScroll( const NWPoint &p, int id )       { this->touch( p, id ); }
+    virtual void onDrag( const NWPoint &p, int id )         { this->touch( p, id ); }
+    virtual void onTap( const NWPoint &p, int id ) {
+        this->end( p, id );
+        this->mTouches[ toIndex( id ) ].hasTapped = true;
+    }
+    virtual void onCancelled( const NWPoint &p, int id )    { this->end( p, id ); }
+    virtual void onDragEnded( const NWPoint &p, int id )    { this->end( p, id ); }
+    virtual void onSwipe( const NWPoint &p, int id, int direction ) { this->end( p, id ); }
+    virtual void onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+        if( !isFinite( vx ) || !isFinite( vy ) ) fail( "onFlick velocity isn't finite", id );
+        this->end( p, id );
+    }
+
+    virtual void onPinchIn( float m, int id1, int id2 )     { this->pinch( m, id1, id2 ); }
+    virtual void onPinchOut( float m, int id1, int id2 )    { this->pinch( m, id1, id2 ); }
+    virtual void onPinchAction( float m, int id1, int id2 ) { this->pinch( m, id1, id2 ); }
+    virtual void onPinchEnded( float m, int id1, int id2 )  { this->pinch( m, id1, id2, true ); }
+
+    virtual void onTransform( const NWTransform &t ) {
+        this->transform( t );
+        this->mGroups[ t.group ] = true;
+        // its fingers. only the down touches can be.
+        for( int i = 0; i < kIds; ++i ) {
+            if( !this->mTouches[i].isDown || this->getTransformGroup( toId( i ) ) != t.group ) continue;
+            this->mTouches[i].isTransformed = true;
+        }
+    }
+    virtual void onTransformEnded( const NWTransform &t ) {
+        this->transform( t );
+        if( !this->mGroups[ t.group ] ) fail( "onTransformEnded without onTransform", t.group );
+        this->mGroups[ t.group ] = false;
+    }
+
+private:
+    int getTransformGroup( int id ) const {
+        return this->mRecognizer ? this->mRecognizer->getTransformGroup( id ) : 0;
+    }
+
+    struct Touch {
+        bool    isDown;         // between onDown and its end.
+        bool    isTransformed;  // was a finger of a running Transform.
+        bool    hasTapped;      // had onTap. the slot may wait for DoubleTap.
+    };
+    const NWGestureRecognizer *mRecognizer;
+    Touch   mTouches[ kIds ];
+    bool    mGroups[ kMaxTransforms ];
+    vector<NWPoint> mTentatives;
+    bool    mIsTentative;
+    bool    mIsMultitap;
+    int     mDownCount;
+    long    mCallbacks;
+
+    void point( const NWPoint &p ) {
+        ++this->mCallbacks;
+        checkPoint( p );
+    }
+    void touch( const NWPoint &p, int id ) {
+        this->point( p );
+        if( !this->isDown( id ) ) fail( "gesture of a touch which isn't down", id );
+    }
+    void end( const NWPoint &p, int id ) {
+        this->touch( p, id );
+        this->mTouches[ toIndex( id ) ].isDown = false;
+        --this->mDownCount;
+    }
+    void settle( const NWPoint &p ) {
+        for( size_t i = 0; i < this->mTentatives.size(); ++i ) {
+            if( this->mTentatives[i].x != p.x || this->mTentatives[i].y != p.y ) continue;
+            this->mTentatives[i] = this->mTentatives.back();
+            this->mTentatives.pop_back();
+            return;
+        }
+        fail( "SingleTap settled without onSingleTapTentative", -1 );
+    }
+    // the ids of PinchEnded may have just ended.
+    void pinch( float magnification, int id1, int id2, bool is_end = false ) {
+        ++this->mCallbacks;
+        if( !isFinite( magnification ) ) fail( "pinch magnification isn't finite", id1 );
+        if( id1 < 0 || ( !is_end && !this->isDown( id1 ) ) ) fail( "pinch of a touch which isn't down", id1 );
+        if( id2 < -1 || ( !is_end && id2 >= 0 && !this->isDown( id2 ) ) ) fail( "pinch of a touch which isn't down", id2 );
+    }
+    void transform( const NWTransform &t ) {
+        ++this->mCallbacks;
+        checkTransform( t );
+    }
+};
+
+
+#pragma -mark ArbiterChecker
+/**
+ *  Listener of NWGestureArbiter with NWStandardRecognizers, which checks
+ *  the states of the recognizers after each call, and the callbacks against them.
+ *  the states are only seen between the calls, since the arbiter resolves
+ *  the conflicts one by one inside a call.
+ */
+class ArbiterChecker : public NWGestureListener {
+public:
+    static const int RECOGNIZERS = 7;
+
+    ArbiterChecker( const NWGestureArbiter *arbiter, const NWStandardRecognizers *standard ) :
+      mArbiter( arbiter )
+    , mStandard( standard )
+    , mHoldId( -1 )
+    , mIsTransforming( false )
+    {
+        // order of install().
+        this->mRecognizers[0] = &standard->hold;
+        this->mRecognizers[1] = &standard->pinch;
+        this->mRecognizers[2] = &standard->pan;
+        this->mRecognizers[3] = &standard->swipe;
+        this->mRecognizers[4] = &standard->tap;
+        this->mRecognizers[5] = &standard->doubleTap;
+        this->mRecognizers[6] = &standard->singleTap;
+        for( int i = 0; i < RECOGNIZERS; ++i ) this->mStates[i] = NWStateRecognizer::POSSIBLE;
+    }
+
+    // same interface as Checker.
+    void beforeTouches( const NWTouchSample *samples, int count, vector<int> *down ) {
+        down->clear();
+    }
+    void afterTouches( NWTouchPhase phase, const NWTouchSample *samples, int count, const vector<int> &down ) {
+        this->check();
+    }
+
+    void check() {
+        typedef NWStateRecognizer R;
+        bool is_up = this->mArbiter->getDownCount() == 0;
+        for( int i = 0; i < RECOGNIZERS; ++i ) {
+            const R *r = this->mRecognizers[i];
+            R::State state = r->getState();
+            R::State last = this->mStates[i];
+            this->mStates[i] = state;
+            if( state != last ) {
+                if( last >= R::ENDED && state != R::POSSIBLE && !( last == R::ENDED && state == R::FAILED ) ) {
+                    fail( "finished recognizer changed its state", i );
+                }
+                if( state == R::POSSIBLE && !is_up ) fail( "recognizer reset while a finger is down", i );
+            }
+            if( is_up && r->isFinished() && !this->isWaitingForDoubleTap( r ) ) {
+                fail( "finished recognizer left with all fingers up", i );
+            }
+
+            for( int j = 0; j < i; ++j ) {
+                const R *other = this->mRecognizers[j];
+                if( !r->isActive() || !other->isActive() ) continue;
+                if( ( r->getTouchMask() & other->getTouchMask() ) && !r->canRecognizeWith( other ) ) {
+                    fail( "conflicting recognizers active together", i );
+                }
+            }
+        }
+        if( this->mStandard->hold.isActive() != ( this->mHoldId >= 0 ) ) fail( "Hold state and its callbacks differ", this->mHoldId );
+        if( this->mStandard->pinch.isActive() != this->mIsTransforming ) fail( "Pinch state and its callbacks differ", -1 );
+    }
+
+    // all cancelled and all deadlines fired.
+    void finish() {
+        this->check();
+        for( int i = 0; i < RECOGNIZERS; ++i ) {
+            if( this->mRecognizers[i]->getState() != NWStateRecognizer::POSSIBLE ) fail( "recognizer not reset after cancelling all", i );
+        }
+        if( this->mArbiter->getDownCount() != 0 ) fail( "arbiter touch left after cancelling all", -1 );
+        if( this->mArbiter->getNextDeadline() >= 0 ) fail( "arbiter deadline left after firing all", -1 );
+    }
+
+    virtual void onSingleTap( const NWPoint &p ) {
+        checkPoint( p );
+        const NWStateRecognizer &double_tap = this->mStandard->doubleTap;
+        if( !double_tap.isFinished() || double_tap.isRecognized() ) fail( "SingleTap while DoubleTap hasn't failed", 6 );
+    }
+    virtual void onDoubleTap( const NWPoint &p )            { checkPoint( p ); }
+    virtual void onDown( const NWPoint &p, int id )         { this->touch( p, id, true ); }
+    virtual void onTap( const NWPoint &p, int id )          { this->touch( p, id, false ); }
+    virtual void onScroll( const NWPoint &p, int id )       { this->touch( p, id, true ); }
+    virtual void onSwipe( const NWPoint &p, int id, int direction ) { this->touch( p, id, false ); }
+    virtual void onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+        if( !isFinite( vx ) || !isFinite( vy ) ) fail( "onFlick velocity isn't finite", id );
+        this->touch( p, id, false );
+    }
+
+    virtual void onHold( const NWPoint &p, int id ) {
+        this->touch( p, id, true );
+        if( this->mHoldId >= 0 ) fail( "onHold twice without onDragEnded", id );
+        this->mHoldId = id;
+    }
+    virtual void onDrag( const NWPoint &p, int id ) {
+        this->touch( p, id, true );
+        if( id != this->mHoldId ) fail( "onDrag without onHold", id );
+    }
+    virtual void onDragEnded( const NWPoint &p, int id ) {
+        this->touch( p, id, false );
+        if( id != this->mHoldId ) fail( "onDragEnded without onHold", id );
+        this->mHoldId = -1;
+    }
+
+    virtual void onPinchIn( float m, int id1, int id2 )     { this->pinch( m, id1, id2 ); }
+    virtual void onPinchOut( float m, int id1, int id2 )    { this->pinch( m, id1, id2 ); }
+    virtual void onPinchAction( float m, int id1, int id2 ) { this->pinch( m, id1, id2 ); }
+    virtual void onPinchEnded( float m, int id1, int id2 )  { this->pinch( m, id1, id2 ); }
+
+    virtual void onTransform( const NWTransform &t ) {
+        checkTransform( t );
+        this->mIsTransforming = true;
+    }
+    virtual void onTransformEnded( const NWTransform &t ) {
+        checkTransform( t );
+        if( !this->mIsTransforming ) fail( "onTransformEnded without onTransform", t.group );
+        this->mIsTransforming = false;
+    }
+
+private:
+    const NWGestureArbiter      *mArbiter;
+    const NWStandardRecognizers *mStandard;
+    const NWStateRecognizer     *mRecognizers[ RECOGNIZERS ];
+    NWStateRecognizer::State     mStates[ RECOGNIZERS ];   // as of the last check().
+    int     mHoldId;            // between onHold and onDragEnded.
+    bool    mIsTransforming;    // between onTransform and onTransformEnded.
+
+    // SingleTap recognized is held until DoubleTap fails.
+    bool isWaitingForDoubleTap( const NWStateRecognizer *r ) const {
+        return r == &this->mStandard->singleTap && r->getState() == NWStateRecognizer::ENDED &&
+               !this->mStandard->doubleTap.isFinished();
+    }
+
+    // the touch of id is in the arbiter. an up one is kept until its slot is reused.
+    void touch( const NWPoint &p, int id, bool is_down ) {
+        checkPoint( p );
+        const NWArbiterTouch *touch = this->mArbiter->getTouch( id );
+        if( !touch ) fail( "arbiter gesture of an unknown touch", id );
+        if( is_down && !touch->isDown ) fail( "arbiter gesture of a touch which isn't down", id );
+    }
+    void pinch( float magnification, int id1, int id2 ) {
+        if( !isFinite( magnification ) ) fail( "pinch magnification isn't finite", id1 );
+        if( !this->mArbiter->getTouch( id1 ) ) fail( "arbiter pinch of an unknown touch", id1 );
+        if( !this->mArbiter->getTouch( id2 ) ) fail( "arbiter pinch of an unknown touch", id2 );
+    }
+};
+
+
+#pragma -mark Input
+/**
+ *  Decoder of the input bytes. past the end reads 0.
+ */
+class Input {
+public:
+    Input( const uint8_t *data, size_t size ) : mData( data ), mSize( size ), mPos( 0 ) {}
+
+    bool empty() const  { return this->mPos >= this->mSize; }
+    int next()          { return this->mPos < this->mSize ? this->mData[ this->mPos++ ] : 0; }
+
+private:
+    const uint8_t *mData;
+    size_t mSize;
+    size_t mPos;
+};
+
+typedef NWBasicGestureRecognizer<Checker, NWGestureAll> BasicRecognizer;
+
+// one batch to a recognizer (or the arbiter) and its checker.
+template< class Recognizer, class Check >
+void feed( Recognizer *recognizer, Check *checker, NWTouchPhase phase,
+           const NWTouchSample *samples, int count, vector<int> *down )
+{
+    checker->beforeTouches( samples, count, down );
+    recognizer->touches( phase, samples, count );
+    checker->afterTouches( phase, samples, count, *down );
+}
+
+// cancel every id of the inputs. the ones not down are ignored.
+template< class Recognizer, class Check >
+void cancelAll( Recognizer *recognizer, Check *checker, NWTime now, vector<int> *down )
+{
+    NWTouchSample samples[4];
+    int count = 0;
+    for( int i = 0; i < kIds; ++i ) {
+        NWTouchSample sample = { toId( i ), 0.0f, 0.0f, now };
+        samples[ count++ ] = sample;
+        if( count < 4 && i < kIds - 1 ) continue;
+        feed( recognizer, checker, NW_TOUCH_CANCELLED, samples, count, down );
+        count = 0;
+    }
+}
+
+/**
+ *  Run one input. returns the number of touch samples fed.
+ *
+ *  byte 0: config. bit 0: no Multi-tap, bit 1: no PinchAction,
+ *          bit 2: tentative SingleTap, bit 3: One Euro filter,
+ *          bit 4-5: DistanceThresholdForGroup, bit 6-7: history capacity.
+ *  byte 1: DistanceThresholdForMoved.
+ *  then ops. low 3 bits of the op byte:
+ *  0-3: batch of the phase, 1-4 samples of 4 bytes (id, x, y, time step).
+ *  4: update(). 5: time jumps (up to 1.5 sec), then update().
+ *  6: toggle PinchAction. 7: toggle tentative SingleTap.
+ *  the batches and update() go to all three; the config and the toggles are
+ *  of NWGestureRecognizer, the others take only its thresholds.
+ */
+long runInput( const uint8_t *data, size_t size )
+{
+    static const float kGroupDistances[] = { 0.0f, 50.0f, 150.0f, 400.0f };
+    static const int kCapacities[] = { 0, 16, 64, 256 };
+
+    Input input( data, size );
+    int config = input.next();
+    int capacity = kCapacities[ ( config >> 6 ) & 3 ];
+    bool is_tentative = ( config & 4 ) != 0;
+
+#if !NW_GESTURE_LIBFUZZER
+    size_t base_bytes = sLiveBytes;
+#endif
+    NWManualClock clock( NWTimeFromSec( 1000.0 ) );
+    Checker checker;
+    checker.reset( is_tentative, ( config & 1 ) == 0 );
+    NWGestureRecognizer recognizer;
+    checker.setRecognizer( &recognizer );
+    recognizer.setClock( &clock );
+    recognizer.setListener( &checker );
+    recognizer.setMulitapSupport( ( config & 1 ) == 0 );
+    recognizer.setPinchActionSupport( ( config & 2 ) == 0 );
+    recognizer.setTentativeSingleTap( is_tentative );
+    if( config & 8 ) recognizer.setFilterPolicy( NWFilterPolicy( 1.0f, 0.05f, 0.016 ) );
+    recognizer.setDistanceThresholdForGroup( kGroupDistances[ ( config >> 4 ) & 3 ] );
+    recognizer.setHistoryPolicy( NWHistoryPolicy( capacity, 0.0f, 0.0 ) );
+    recognizer.setDistanceThresholdForMoved( 1.0f + input.next() );
+
+    // the same thresholds. no DoubleTap wait per place, no tentative SingleTap.
+    Checker basic_checker;
+    BasicRecognizer basic( &basic_checker );
+    basic.setClock( &clock );
+    basic.copyConfig( recognizer );
+
+    NWStandardRecognizers standard;
+    NWGestureArbiter arbiter;
+    ArbiterChecker arbiter_checker( &arbiter, &standard );
+    standard.copyConfig( recognizer );
+    standard.install( &arbiter );
+    arbiter.setClock( &clock );
+    arbiter.setListener( &arbiter_checker );
+
+    NWTouchSample samples[4];
+    vector<int> down;
+    down.reserve( kMaxTouches * 2 );
+    long fed = 0;
+    while( !input.empty() ) {
+        int op = input.next();
+        switch( op & 7 ) {
+            case 0: case 1: case 2: case 3: {
+                NWTouchPhase phase = static_cast<NWTouchPhase>( op & 3 );
+                int count = 1 + ( ( op >> 3 ) & 3 );
+                for( int i = 0; i < count; ++i ) {
+                    samples[i].id = decodeId( input.next() );
+                    samples[i].x = input.next() * 4.0f;
+                    samples[i].y = input.next() * 4.0f;
+                    // -16 to 111 ms: mostly forward.
+                    clock.advance( NWTimeFromSec( ( input.next() - 16 ) * 0.001 ) );
+                    samples[i].time = clock.now();
+                }
+                feed( &recognizer, &checker, phase, samples, count, &down );
+                fed += count;
+                if( phase == NW_TOUCH_ENDED || phase == NW_TOUCH_CANCELLED ) {
+                    for( size_t i = 0; i < down.size(); ++i ) {
+                        if( checker.isDown( down[i] ) || checker.hasTapped( down[i] ) ) continue;
+                        if( recognizer.getTouchHistory( down[i] ) ) fail( "ended touch held until update()", down[i] );
+                    }
+                }
+                feed( &basic, &basic_checker, phase, samples, count, &down );
+                feed( &arbiter, &arbiter_checker, phase, samples, count, &down );
+                break;
+            }
+            case 4: case 5:
+                if( ( op & 7 ) == 5 ) clock.advance( NWTimeFromSec( ( op >> 3 ) * 0.05 ) );
+                recognizer.update();
+                basic.update();
+                arbiter.update();
+                arbiter_checker.check();
+                break;
+            case 6:
+                recognizer.setPinchActionSupport( !recognizer.isPinchActionSupport() );
+                break;
+            case 7:
+                is_tentative = !is_tentative;
+                if( checker.getCallbackCount() == 0 ) {
+                    recognizer.setTentativeSingleTap( is_tentative );
+                    checker.reset( is_tentative, recognizer.isMultitapSupport() );
+                }
+                break;
+        }
+#if !NW_GESTURE_LIBFUZZER
+        if( capacity > 0 && sLiveBytes - base_bytes > kHeapBound ) {
+            fail( "heap over the bound with a ring history", -1 );
+        }
+#endif
+    }
+
+    // cancel the rest, and fire all deadlines.
+    cancelAll( &recognizer, &checker, clock.now(), &down );
+    cancelAll( &basic, &basic_checker, clock.now(), &down );
+    cancelAll( &arbiter, &arbiter_checker, clock.now(), &down );
+    clock.advance( NWTimeFromSec( 60.0 ) );
+    recognizer.update();
+    basic.update();
+    arbiter.update();
+    checker.finish( recognizer.getNextDeadline() );
+    basic_checker.finish( basic.getNextDeadline() );
+    arbiter_checker.finish();
+#if !NW_GESTURE_LIBFUZZER
+    // the grown buffers are given back with the slots: the reserve of each, and a little.
+    size_t reserve = capacity > 0 ? capacity : NW_GESTURE_HISTORY_RESERVE;
+    size_t released_bound = kMaxTouches * reserve * ( sizeof( float ) * 2 + sizeof( NWTime ) ) + 4096;
+    if( sLiveBytes - base_bytes > released_bound ) fail( "heap over the bound after releasing all", -1 );
+#endif
+    return fed;
+}
+
+} // unnamed namespace
+
+
+#if NW_GESTURE_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size )
+{
+    runInput( data, size );
+    return 0;
+}
+
+#else
+namespace {
+
+// xorshift64*. the same seed makes the same input on any platform.
+uint64_t nextRandom( uint64_t *state )
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ULL;
+}
+
+} // unnamed namespace
+
+int main( int argc, char **argv )
+{
+    long target = 2000000;
+    unsigned long seed = 1;
+    int length = 4096;
+    for( int i = 1; i < argc; ++i ) {
+        if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )      target = atol( argv[++i] );
+        else if( strcmp( argv[i], "-s" ) == 0 && i + 1 < argc ) seed = strtoul( argv[++i], NULL, 10 );
+        else if( strcmp( argv[i], "-l" ) == 0 && i + 1 < argc ) length = atoi( argv[++i] );
+        else {
+            fprintf( stderr, "usage: nwgesture_fuzz [-n events] [-s seed] [-l bytes]\n" );
+            return 2;
+        }
+    }
+    if( length < 2 ) length = 2;
+
+    vector<uint8_t> data( length );
+    long events = 0;
+    long inputs = 0;
+    NWMonotonicClock *clock = NWMonotonicClock::sharedClock();
+    NWTime start = clock->now();
+    for( sSeed = seed; events < target; ++sSeed, ++inputs ) {
+        uint64_t state = sSeed * 0x9E3779B97F4A7C15ULL + 1;
+        for( int i = 0; i < length; ++i ) data[i] = static_cast<uint8_t>( nextRandom( &state ) >> 56 );
+        events += runInput( &data[0], data.size() );
+    }
+    double elapsed = NWTimeToSec( clock->now() - start );
+
+    printf( "%ld inputs (seed %lu to %lu), %ld touch samples, %.0f samples/sec: ok\n",
+            inputs, seed, sSeed - 1, events, elapsed > 0.0 ? events / elapsed : 0.0 );
+    return 0;
+}
+#endif
@@ -0,0 +1,286 @@
+//
+//  nwgesture_replay.cpp
+//  NoviceWorks
+//
+//  Feed a touch trace through NWGestureRecognizer and dump the gestures.
+//
+//  usage: nwgesture_replay [options] trace
+//      -d <px>     DistanceThresholdForMoved (default 100)
+//      -e          tentative SingleTap: onSingleTapTentative at the first tap
+//      -g <px>     DistanceThresholdForGroup (default 0: one pinch)
+//      -i          dump NWGestureStats at the end (NW_GESTURE_STATS=1).
+//                  latencies are on the virtual clock of the trace
+//      -a          run NWGestureArbiter with NWStandardRecognizers instead
+//      -f <ms>     One Euro filter, and print the smoothed and predicted
+//                  (ms ahead) points with onScroll and onDrag
+//      -m          disable Multi-tap
+//      -n          no DoubleTap: SingleTap comes at once
+//      -p          disable PinchAction
+//      -s          run NWBasicGestureRecognizer (gestures chosen at compile
+//                  time) instead. -m and -p choose its gesture set.
+//                  -f and -g are not supported (one pinch)
+//      -t <file>   also write the trace as text to file
+//
+
+// std
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// myclass
+#include "NWBasicGestureRecognizer.hpp"
+#include "NWGestureRecognizer.hpp"
+#include "NWGestureStats.hpp"
+#include "NWStandardRecognizers.hpp"
+#include "NWTouchTrace.hpp"
+
+
+using std::vector;
+
+
+namespace {
+
+#pragma -mark Dump Listener
+// print each gesture in a line. time is of the virtual clock in ms.
+class DumpListener : public NWGestureListener {
+public:
+    explicit DumpListener( NWClock *clock ) : mClock( clock ), mFiltered( NULL ), mIsDoubleTapSupported( true ) {}
+
+    // print getSmoothedPoint() and getPredictedPoint() of it.
+    void setFiltered( const NWGestureRecognizer *recognizer ) { this->mFiltered = recognizer; }
+    void setDoubleTapSupport( bool is_supported ) { this->mIsDoubleTapSupported = is_supported; }
+
+    virtual void onSingleTap( const NWPoint &p )        { this->point( "onSingleTap", -1, p ); }
+    virtual void onDoubleTap( const NWPoint &p )        { this->point( "onDoubleTap", -1, p ); }
+    virtual bool isDoubleTapSupport( const NWPoint &p ) { return this->mIsDoubleTapSupported; }
+    virtual void onSingleTapTentative( const NWPoint &p ) { this->point( "onSingleTapTentative", -1, p ); }
+    virtual void onSingleTapRevoked( const NWPoint &p ) { this->point( "onSingleTapRevoked", -1, p ); }
+    virtual void onDown( const NWPoint &p, int id )     { this->point( "onDown", id, p ); }
+    virtual void onHold( const NWPoint &p, int id )     { this->point( "onHold", id, p ); }
+    virtual void onTap( const NWPoint &p, int id )      { this->point( "onTap", id, p ); }
+    virtual void onCancelled( const NWPoint &p, int id ){ this->point( "onCancelled", id, p ); }
+    virtual void onScroll( const NWPoint &p, int id )   { this->move( "onScroll", id, p ); }
+    virtual void onDrag( const NWPoint &p, int id )     { this->move( "onDrag", id, p ); }
+    virtual void onDragEnded( const NWPoint &p, int id ){ this->point( "onDragEnded", id, p ); }
+
+    virtual void onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+        printf( "%12.3f onFlick id=%d (%.2f, %.2f) dir=%d v=(%.1f, %.1f)\n",
+                this->now(), id, p.x, p.y, direction, vx, vy );
+    }
+    virtual void onSwipe( const NWPoint &p, int id, int direction ) {
+        printf( "%12.3f onSwipe id=%d (%.2f, %.2f) dir=%d\n", this->now(), id, p.x, p.y, direction );
+    }
+
+    virtual void onPinchIn( float m, int id1, int id2 )     { this->pinch( "onPinchIn", m, id1, id2 ); }
+    virtual void onPinchOut( float m, int id1, int id2 )    { this->pinch( "onPinchOut", m, id1, id2 ); }
+    virtual void onPinchAction( float m, int id1, int id2 ) { this->pinch( "onPinchAction", m, id1, id2 ); }
+    virtual void onPinchEnded( float m, int id1, int id2 )  { this->pinch( "onPinchEnded", m, id1, id2 ); }
+
+    virtual void onTransform( const NWTransform &t )        { this->transform( "onTransform", t ); }
+    virtual void onTransformEnded( const NWTransform &t )   { this->transform( "onTransformEnded", t ); }
+
+private:
+    NWClock *mClock;
+    const NWGestureRecognizer *mFiltered;
+    bool mIsDoubleTapSupported;
+
+    double now() {
+        return NWTimeToSec( this->mClock->now() ) * 1000.0;
+    }
+    void point( const char *name, int id, const NWPoint &p ) {
+        if( id < 0 ) printf( "%12.3f %s (%.2f, %.2f)\n", this->now(), name, p.x, p.y );
+        else         printf( "%12.3f %s id=%d (%.2f, %.2f)\n", this->now(), name, id, p.x, p.y );
+    }
+    void move( const char *name, int id, const NWPoint &p ) {
+        if( !this->mFiltered ) {
+            this->point( name, id, p );
+            return;
+        }
+        NWPoint s = this->mFiltered->getSmoothedPoint( id );
+        NWPoint f = this->mFiltered->getPredictedPoint( id );
+        printf( "%12.3f %s id=%d (%.2f, %.2f) smooth=(%.2f, %.2f) pred=(%.2f, %.2f)\n",
+                this->now(), name, id, p.x, p.y, s.x, s.y, f.x, f.y );
+    }
+    void pinch( const char *name, float magnification, int id1, int id2 ) {
+        printf( "%12.3f %s id=%d,%d mag=%.4f\n", this->now(), name, id1, id2, magnification );
+    }
+    void transform( const char *name, const NWTransform &t ) {
+        printf( "%12.3f %s group=%d n=%d center=(%.2f, %.2f) move=(%.2f, %.2f) scale=%.4f rot=%.4f\n",
+                this->now(), name, t.group, t.touchCount, t.centroid.x, t.centroid.y,
+                t.translation.x, t.translation.y, t.scale, t.rotation );
+    }
+};
+
+// NWBasicGestureRecognizer's handler: all gestures to the DumpListener.
+class DumpHandler : public NWGestureHandler {
+public:
+    explicit DumpHandler( DumpListener *listener ) : mListener( listener ) {}
+
+    void onSingleTap( const NWPoint &p )        { this->mListener->onSingleTap( p ); }
+    void onDoubleTap( const NWPoint &p )        { this->mListener->onDoubleTap( p ); }
+    void onDown( const NWPoint &p, int id )     { this->mListener->onDown( p, id ); }
+    void onHold( const NWPoint &p, int id )     { this->mListener->onHold( p, id ); }
+    void onTap( const NWPoint &p, int id )      { this->mListener->onTap( p, id ); }
+    void onCancelled( const NWPoint &p, int id ){ this->mListener->onCancelled( p, id ); }
+    void onScroll( const NWPoint &p, int id )   { this->mListener->onScroll( p, id ); }
+    void onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) {
+        this->mListener->onFlick( p, id, direction, vx, vy );
+    }
+    void onSwipe( const NWPoint &p, int id, int direction ) { this->mListener->onSwipe( p, id, direction ); }
+    void onDrag( const NWPoint &p, int id )     { this->mListener->onDrag( p, id ); }
+    void onDragEnded( const NWPoint &p, int id ){ this->mListener->onDragEnded( p, id ); }
+    void onPinchIn( float m, int id1, int id2 )     { this->mListener->onPinchIn( m, id1, id2 ); }
+    void onPinchOut( float m, int id1, int id2 )    { this->mListener->onPinchOut( m, id1, id2 ); }
+    void onPinchAction( float m, int id1, int id2 ) { this->mListener->onPinchAction( m, id1, id2 ); }
+    void onPinchEnded( float m, int id1, int id2 )  { this->mListener->onPinchEnded( m, id1, id2 ); }
+    void onTransform( const NWTransform &t )        { this->mListener->onTransform( t ); }
+    void onTransformEnded( const NWTransform &t )   { this->mListener->onTransformEnded( t ); }
+
+private:
+    DumpListener *mListener;
+};
+
+// gesture sets of -s, as NWGestureRecognizer with -m / -p.
+typedef NWGestureSet<NWGestureTap, NWGestureDoubleTap, NWGestureHold, NWGestureScroll> SingleTouchGestures;
+typedef NWGestureSet<SingleTouchGestures, NWGestureMultiTouch> NoPinchGestures;
+
+// fire the timed gestures until the time.
+// Driver: NWGestureRecognizer, NWGestureArbiter or NWBasicGestureRecognizer.
+template <class Driver>
+void fireDeadlines( Driver *recognizer, NWManualClock *clock, NWTime until )
+{
+    for( NWTime deadline = recognizer->getNextDeadline();
+         deadline >= 0 && deadline <= until;
+         deadline = recognizer->getNextDeadline() ) {
+        if( deadline > clock->now() ) clock->setTime( deadline );
+        recognizer->update();
+    }
+}
+
+// feed all batches of the trace on the virtual clock.
+// recorder: NULL if the driver records the touches itself.
+template <class Driver>
+void replay( Driver *recognizer, NWTouchTraceReader *reader, NWManualClock *clock, NWTouchRecorder *recorder )
+{
+    NWTouchPhase phase;
+    vector<NWTouchSample> samples;
+    bool is_first = true;
+    while( reader->readBatch( &phase, &samples ) ) {
+        NWTime time = samples[0].time;
+        if( is_first ) {
+            clock->setTime( time );
+            is_first = false;
+        }
+        if( recorder ) recorder->record( phase, &samples[0], samples.size() );
+        fireDeadlines( recognizer, clock, time );
+        if( time > clock->now() ) clock->setTime( time );
+        recognizer->touches( phase, &samples[0], samples.size() );
+    }
+
+    // pending SingleTap and Hold.
+    fireDeadlines( recognizer, clock, clock->now() + NWTimeFromSec( 60.0 ) );
+}
+
+template <class Gestures>
+void replayBasic( DumpListener *listener, const NWGestureRecognizer &config,
+                  NWTouchTraceReader *reader, NWManualClock *clock, NWTouchRecorder *recorder )
+{
+    DumpHandler handler( listener );
+    NWBasicGestureRecognizer<DumpHandler, Gestures> recognizer( &handler );
+    recognizer.setClock( clock );
+    recognizer.copyConfig( config );
+    replay( &recognizer, reader, clock, recorder );
+}
+
+void usage()
+{
+    fprintf( stderr, "usage: nwgesture_replay [-a] [-d px] [-e] [-f ms] [-g px] [-i] [-m] [-n] [-p] [-s] [-t text_out] trace\n" );
+}
+
+} // unnamed namespace
+
+
+int main( int argc, char **argv )
+{
+    float distance = 100.0f;
+    float group_distance = 0.0f;
+    bool is_multitap = true;
+    bool is_arbiter = false;
+    double prediction = -1.0;
+    bool is_pinch = true;
+    bool is_basic = false;
+    bool is_stats = false;
+    bool is_double_tap = true;
+    bool is_tentative = false;
+    const char *text_out = NULL;
+    const char *path = NULL;
+
+    for( int i = 1; i < argc; ++i ) {
+        if( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc )      distance = atof( argv[++i] );
+        else if( strcmp( argv[i], "-g" ) == 0 && i + 1 < argc ) group_distance = atof( argv[++i] );
+        else if( strcmp( argv[i], "-a" ) == 0 )                 is_arbiter = true;
+        else if( strcmp( argv[i], "-e" ) == 0 )                 is_tentative = true;
+        else if( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc ) prediction = atof( argv[++i] ) / 1000.0;
+        else if( strcmp( argv[i], "-i" ) == 0 )                 is_stats = true;
+        else if( strcmp( argv[i], "-m" ) == 0 )                 is_multitap = false;
+        else if( strcmp( argv[i], "-n" ) == 0 )                 is_double_tap = false;
+        else if( strcmp( argv[i], "-p" ) == 0 )                 is_pinch = false;
+        else if( strcmp( argv[i], "-s" ) == 0 )                 is_basic = true;
+        else if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) text_out = argv[++i];
+        else if( argv[i][0] != '-' && !path )                   path = argv[i];
+        else { usage(); return 2; }
+    }
+    if( !path ) { usage(); return 2; }
+
+    NWTouchTraceReader reader;
+    if( !reader.open( path ) ) {
+        fprintf( stderr, "nwgesture_replay: can't read trace %s\n", path );
+        return 1;
+    }
+    NWTouchTraceWriter writer;
+    if( text_out && !writer.open( text_out, NWTouchTraceWriter::TEXT ) ) {
+        fprintf( stderr, "nwgesture_replay: can't write %s\n", text_out );
+        return 1;
+    }
+
+    NWManualClock clock;
+    DumpListener listener( &clock );
+    NWGestureRecognizer recognizer;
+    recognizer.setClock( &clock );
+    recognizer.setListener( &listener );
+    recognizer.setDistanceThresholdForMoved( distance );
+    recognizer.setDistanceThresholdForGroup( group_distance );
+    recognizer.setMulitapSupport( is_multitap );
+    recognizer.setPinchActionSupport( is_pinch );
+    recognizer.setTentativeSingleTap( is_tentative );
+    listener.setDoubleTapSupport( is_double_tap );
+    if( prediction >= 0.0 && !is_basic ) {
+        recognizer.setFilterPolicy( NWFilterPolicy( 1.0f, 0.05f, prediction ) );
+        listener.setFiltered( &recognizer );
+    }
+
+    NWTouchRecorder *recorder = writer.isOpen() ? &writer : NULL;
+    if( is_basic ) {
+        if( !is_multitap )   replayBasic<SingleTouchGestures>( &listener, recognizer, &reader, &clock, recorder );
+        else if( !is_pinch ) replayBasic<NoPinchGestures>( &listener, recognizer, &reader, &clock, recorder );
+        else                 replayBasic<NWGestureAll>( &listener, recognizer, &reader, &clock, recorder );
+        return 0;
+    }
+    if( is_arbiter ) {
+        NWGestureArbiter arbiter;
+        NWStandardRecognizers standard;
+        arbiter.setClock( &clock );
+        arbiter.setListener( &listener );
+        standard.copyConfig( recognizer );
+        standard.install( &arbiter );
+        replay( &arbiter, &reader, &clock, recorder );
+        return 0;
+    }
+    NWGestureStats stats;
+    if( is_stats ) recognizer.setStats( &stats );
+    if( recorder ) recognizer.setTouchRecorder( recorder );
+    replay( &recognizer, &reader, &clock, NULL );
+    if( is_stats ) stats.dump( stdout );
+    return 0;
+}
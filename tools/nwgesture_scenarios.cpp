@@ -0,0 +1,264 @@
+//
+//  nwgesture_scenarios.cpp
+//  NoviceWorks
+//
+//  Scripted touches through NWGestureArbiter with NWStandardRecognizers,
+//  checking which gestures win.
+//
+//  usage: nwgesture_scenarios [filter]
+//      filter      run only the scenarios whose name contains this
+//
+//  each scenario plays fingers on a manual clock and asserts the callbacks
+//  and the states of the recognizers: requireToFail (SingleTap waits for
+//  DoubleTap), allowSimultaneous (Swipe with Pan) and the priority (Pinch
+//  cancels Pan, Hold fails Tap). a failed assertion prints its line, and
+//  the exit status is 1.
+//
+
+// std
+#include <cstdio>
+#include <cstring>
+
+// myclass
+#include "NWGestureArbiter.hpp"
+#include "NWStandardRecognizers.hpp"
+
+
+namespace {
+
+const float kMoved = 10.0f;     // DistanceThresholdForMoved.
+
+bool sHasFailed = false;
+bool sIsScenarioFailed = false;
+
+#define CHECK( cond ) check( ( cond ), #cond, __LINE__ )
+
+void check( bool is_ok, const char *expr, int line )
+{
+    if( is_ok ) return;
+    fprintf( stderr, "  line %d: %s\n", line, expr );
+    sIsScenarioFailed = true;
+}
+
+
+#pragma -mark Recorder
+/**
+ *  Listener which counts the callbacks.
+ */
+class Recorder : public NWGestureListener {
+public:
+    Recorder() {
+        this->singleTap = this->doubleTap = this->tap = 0;
+        this->hold = this->drag = this->dragEnded = 0;
+        this->scroll = this->swipe = this->flick = 0;
+        this->transform = this->transformEnded = 0;
+    }
+
+    int singleTap, doubleTap, tap;
+    int hold, drag, dragEnded;
+    int scroll, swipe, flick;
+    int transform, transformEnded;
+
+    virtual void onSingleTap( const NWPoint &p )            { ++this->singleTap; }
+    virtual void onDoubleTap( const NWPoint &p )            { ++this->doubleTap; }
+    virtual void onTap( const NWPoint &p, int id )          { ++this->tap; }
+    virtual void onHold( const NWPoint &p, int id )         { ++this->hold; }
+    virtual void onDrag( const NWPoint &p, int id )         { ++this->drag; }
+    virtual void onDragEnded( const NWPoint &p, int id )    { ++this->dragEnded; }
+    virtual void onScroll( const NWPoint &p, int id )       { ++this->scroll; }
+    virtual void onSwipe( const NWPoint &p, int id, int direction ) { ++this->swipe; }
+    virtual void onFlick( const NWPoint &p, int id, int direction, float vx, float vy ) { ++this->flick; }
+    virtual void onTransform( const NWTransform &t )        { ++this->transform; }
+    virtual void onTransformEnded( const NWTransform &t )   { ++this->transformEnded; }
+};
+
+
+#pragma -mark Scenario
+/**
+ *  The arbiter with the built-in recognizers, and the fingers to play on it.
+ */
+class Scenario {
+public:
+    Scenario() : mClock( NWTimeFromSec( 100.0 ) ) {
+        NWGestureRecognizer config;
+        config.setDistanceThresholdForMoved( kMoved );
+        this->standard.copyConfig( config );
+        this->standard.install( &this->arbiter );
+        this->arbiter.setClock( &this->mClock );
+        this->arbiter.setListener( &this->recorder );
+    }
+
+    void began( int id, float x, float y )  { this->touch( NW_TOUCH_BEGAN, id, x, y ); }
+    void moved( int id, float x, float y )  { this->touch( NW_TOUCH_MOVED, id, x, y ); }
+    void ended( int id, float x, float y )  { this->touch( NW_TOUCH_ENDED, id, x, y ); }
+
+    // let the time pass, and fire the deadlines.
+    void wait( double sec ) {
+        this->mClock.advance( NWTimeFromSec( sec ) );
+        this->arbiter.update();
+    }
+
+    NWStandardRecognizers standard;
+    NWGestureArbiter arbiter;
+    Recorder recorder;
+
+private:
+    NWManualClock mClock;
+
+    void touch( NWTouchPhase phase, int id, float x, float y ) {
+        this->mClock.advance( NWTimeFromSec( 0.016 ) );
+        NWTouchSample sample = { id, x, y, this->mClock.now() };
+        this->arbiter.touches( phase, &sample, 1 );
+    }
+};
+
+typedef NWStateRecognizer R;
+
+
+#pragma -mark Scenarios
+// a tap alone: SingleTap comes only when DoubleTap gives up.
+void singleTapAfterDoubleTapFails()
+{
+    Scenario s;
+    s.began( 0, 100.0f, 100.0f );
+    s.ended( 0, 100.0f, 100.0f );
+    CHECK( s.recorder.tap == 1 );
+    CHECK( s.recorder.singleTap == 0 );
+    CHECK( s.standard.singleTap.getState() == R::ENDED );      // held.
+    CHECK( s.standard.doubleTap.getState() == R::POSSIBLE );
+    CHECK( s.arbiter.getNextDeadline() >= 0 );
+
+    s.wait( 0.1 );
+    CHECK( s.recorder.singleTap == 0 );
+
+    s.wait( 1.0 );
+    CHECK( s.recorder.singleTap == 1 );
+    CHECK( s.recorder.doubleTap == 0 );
+    CHECK( s.standard.singleTap.getState() == R::POSSIBLE );   // reset.
+    CHECK( s.standard.doubleTap.getState() == R::POSSIBLE );
+    CHECK( s.arbiter.getNextDeadline() < 0 );
+}
+
+// the second tap in time: DoubleTap, and the held SingleTap never comes.
+void doubleTapRevokesSingleTap()
+{
+    Scenario s;
+    s.began( 0, 100.0f, 100.0f );
+    s.ended( 0, 100.0f, 100.0f );
+    s.began( 0, 102.0f, 101.0f );
+    CHECK( s.standard.singleTap.getState() == R::ENDED );      // still held.
+    s.ended( 0, 102.0f, 101.0f );
+    CHECK( s.recorder.doubleTap == 1 );
+    CHECK( s.recorder.tap == 2 );       // Tap is allowed with DoubleTap.
+    CHECK( s.recorder.singleTap == 0 );
+    CHECK( s.standard.singleTap.getState() == R::POSSIBLE );   // failed, and reset.
+
+    s.wait( 1.0 );
+    CHECK( s.recorder.singleTap == 0 );
+    CHECK( s.arbiter.getNextDeadline() < 0 );
+}
+
+// a second finger on a scroll: Pinch is higher, so Pan is cancelled for good.
+void pinchCancelsPan()
+{
+    Scenario s;
+    s.began( 0, 100.0f, 100.0f );
+    s.moved( 0, 100.0f + kMoved * 2, 100.0f );
+    CHECK( s.standard.pan.isActive() );
+    CHECK( s.recorder.scroll == 1 );
+
+    s.began( 1, 300.0f, 100.0f );
+    CHECK( s.standard.pinch.isActive() );
+    CHECK( s.standard.pan.getState() == R::CANCELLED );
+    CHECK( s.recorder.transform == 1 );
+
+    s.moved( 0, 100.0f + kMoved * 4, 100.0f );
+    s.moved( 1, 320.0f, 100.0f );
+    CHECK( s.recorder.scroll == 1 );
+    CHECK( s.recorder.transform == 3 );
+
+    s.ended( 1, 320.0f, 100.0f );
+    s.ended( 0, 100.0f + kMoved * 4, 100.0f );
+    CHECK( s.recorder.transformEnded == 1 );
+    CHECK( s.recorder.scroll == 1 );
+    CHECK( s.recorder.swipe + s.recorder.flick == 0 );
+    CHECK( s.standard.pan.getState() == R::POSSIBLE );     // reset.
+}
+
+// Swipe is allowed with Pan: the scroll goes on, and its release is a Swipe or a Flick.
+void swipeWithPan()
+{
+    Scenario s;
+    s.began( 0, 100.0f, 100.0f );
+    for( int i = 1; i <= 5; ++i ) s.moved( 0, 100.0f + kMoved * 2 * i, 100.0f );
+    CHECK( s.standard.pan.isActive() );
+    CHECK( s.standard.swipe.getState() == R::POSSIBLE );
+    CHECK( s.recorder.scroll == 5 );
+
+    s.ended( 0, 100.0f + kMoved * 10, 100.0f );
+    CHECK( s.recorder.swipe + s.recorder.flick == 1 );
+    CHECK( s.recorder.tap == 0 );
+    CHECK( s.recorder.singleTap == 0 );
+    s.wait( 1.0 );
+    CHECK( s.recorder.singleTap == 0 );
+}
+
+// a finger kept still: Hold fails Tap, and its end is DragEnded.
+void holdFailsTap()
+{
+    Scenario s;
+    s.began( 0, 100.0f, 100.0f );
+    s.wait( 2.0 );
+    CHECK( s.recorder.hold == 1 );
+    CHECK( s.standard.tap.getState() == R::FAILED );
+
+    s.moved( 0, 100.0f + kMoved * 2, 100.0f );
+    CHECK( s.recorder.drag == 1 );
+    CHECK( s.recorder.scroll == 0 );
+
+    s.ended( 0, 100.0f + kMoved * 2, 100.0f );
+    CHECK( s.recorder.dragEnded == 1 );
+    CHECK( s.recorder.tap == 0 );
+    CHECK( s.recorder.swipe + s.recorder.flick == 0 );
+    s.wait( 1.0 );
+    CHECK( s.recorder.singleTap == 0 );
+}
+
+
+struct Entry {
+    const char *name;
+    void (*run)();
+};
+
+const Entry kScenarios[] = {
+    { "single_tap_after_double_tap_fails",  singleTapAfterDoubleTapFails },
+    { "double_tap_revokes_single_tap",      doubleTapRevokesSingleTap },
+    { "pinch_cancels_pan",                  pinchCancelsPan },
+    { "swipe_with_pan",                     swipeWithPan },
+    { "hold_fails_tap",                     holdFailsTap },
+};
+
+} // unnamed namespace
+
+
+int main( int argc, char **argv )
+{
+    const char *filter = NULL;
+    for( int i = 1; i < argc; ++i ) {
+        if( argv[i][0] != '-' ) filter = argv[i];
+        else {
+            fprintf( stderr, "usage: nwgesture_scenarios [filter]\n" );
+            return 2;
+        }
+    }
+
+    int count = sizeof( kScenarios ) / sizeof( kScenarios[0] );
+    for( int i = 0; i < count; ++i ) {
+        if( filter && !strstr( kScenarios[i].name, filter ) ) continue;
+        sIsScenarioFailed = false;
+        kScenarios[i].run();
+        printf( "%-36s %s\n", kScenarios[i].name, sIsScenarioFailed ? "FAILED" : "ok" );
+        if( sIsScenarioFailed ) sHasFailed = true;
+    }
+    return sHasFailed ? 1 : 0;
+}